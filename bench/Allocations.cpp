@@ -0,0 +1,64 @@
+#include "Bench.h"
+
+#include <new>
+#include <atomic>
+#include <cstdlib>
+
+// replacements of the global allocation functions that count every allocation of the process,
+// including the ones made inside the mathlib shared library; the array and nothrow forms forward here
+namespace {
+    std::atomic<std::size_t> allocations {0};
+
+    void *allocate(std::size_t size, std::size_t alignment)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        if (size == 0)
+            size = 1;
+
+        void *ptr = (alignment <= alignof(std::max_align_t)) ?
+            std::malloc(size) :
+            std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        if (!ptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+}
+
+void *operator new(std::size_t size)
+{
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace mathlib {
+    namespace bench {
+        std::size_t allocationCount()
+        {
+            return allocations.load(std::memory_order_relaxed);
+        }
+    }
+}
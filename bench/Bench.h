@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+
+namespace mathlib {
+    namespace bench {
+        // keep the compiler from optimizing away a computed value
+        template<typename T>
+            inline void doNotOptimize(const T &value)
+            {
+                asm volatile("" : : "g"(&value) : "memory");
+            }
+
+        struct Result {
+            std::string name;
+            double nsPerOp;
+            double opsPerSecond;
+            double allocationsPerOp;
+        };
+
+        // number of global operator new calls so far, counted by the replacement in Allocations.cpp
+        std::size_t allocationCount();
+
+        // every measurement of this run in order, written out by main() on request
+        inline std::vector<Result> &results()
+        {
+            static std::vector<Result> all;
+            return all;
+        }
+
+        // call f repeatedly for at least minSeconds; every call performs opsPerCall operations
+        template<typename F>
+            Result measure(const std::string &name, std::size_t opsPerCall, F f, double minSeconds = 0.2)
+            {
+                using Clock = std::chrono::steady_clock;
+
+                // warm-up call so that caches and page mappings are populated
+                f();
+
+                std::size_t calls = 0;
+                const std::size_t allocationsBefore = allocationCount();
+                const Clock::time_point start = Clock::now();
+                double elapsed = 0;
+                do {
+                    f();
+                    calls++;
+                    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+                } while (elapsed < minSeconds);
+
+                const std::size_t allocations = allocationCount() - allocationsBefore;
+
+                const double ops = static_cast<double>(calls) * opsPerCall;
+                Result result {name, elapsed * 1e9 / ops, ops / elapsed, allocations / ops};
+                std::printf("%-48s %12.3f ns/op %14.0f ops/s %10.3f allocs/op\n",
+                        name.c_str(), result.nsPerOp, result.opsPerSecond, result.allocationsPerOp);
+                results().push_back(result);
+                return result;
+            }
+
+        // suites
+        void runExpressionBench();
+        void runParallelBench();
+        void runEquationBench();
+        void runCoreBench();
+        void runKernelCheck();
+    }
+}
@@ -0,0 +1,514 @@
+#include "Bench.h"
+
+#include <vector>
+#include <sstream>
+#include <type_traits>
+
+#include "../include/Convert.h"
+#include "../include/Format.h"
+#include "../include/Geometry.h"
+#include "../include/Half.h"
+#include "../include/Matrix.h"
+#include "../include/Memory.h"
+#include "../include/Vector.h"
+#include "../include/VectorSoA.h"
+#include "../include/Quaternion.h"
+#include "../include/AffineTransform.h"
+#include "../include/Trigonometry.h"
+#include "../include/BatchTransform.h"
+#include "../include/MatrixTransform.h"
+
+namespace mathlib {
+    namespace bench {
+        namespace {
+            // every operation runs over a batch that fits into l1 so that the kernels, not memory, are timed
+            constexpr std::size_t batch = 512;
+            constexpr double minSeconds = 0.05;
+
+            template<typename T>
+                std::string suffix()
+                {
+                    if constexpr (std::is_same_v<T, float>)
+                        return "f";
+                    else if constexpr (std::is_same_v<T, double>)
+                        return "d";
+                    else
+                        return "i";
+                }
+
+            // deterministic, non-zero element values
+            template<typename T>
+                T value(std::size_t i, int n)
+                {
+                    return static_cast<T>(1 + (i * 7 + n * 3) % 11);
+                }
+
+            template<int dim, typename T>
+                std::vector<Vector<dim, T>> makeVectors(std::size_t seed)
+                {
+                    std::vector<Vector<dim, T>> result(batch);
+                    for (std::size_t i = 0; i < batch; i++)
+                        for (int n = 0; n < dim; n++)
+                            result[i][n] = value<T>(i + seed, n);
+                    return result;
+                }
+
+            // diagonally dominant so that every matrix is invertible
+            template<int dim, typename T>
+                std::vector<Matrix<dim, dim, T>> makeMatrices(std::size_t seed)
+                {
+                    std::vector<Matrix<dim, dim, T>> result(batch);
+                    for (std::size_t i = 0; i < batch; i++)
+                        for (int row = 0; row < dim; row++)
+                            for (int col = 0; col < dim; col++)
+                                result[i][row][col] = value<T>(i + seed, row * dim + col) + (row == col ? T(16) : T(0));
+                    return result;
+                }
+
+            // out[i] = f(i) for the whole batch, one op per element
+            template<typename R, typename F>
+                void benchBatch(const std::string &name, F f)
+                {
+                    std::vector<R> out(batch);
+                    measure(name, batch, [&]() {
+                        for (std::size_t i = 0; i < batch; i++)
+                            out[i] = f(i);
+                        doNotOptimize(out);
+                    }, minSeconds);
+                }
+
+            template<int dim, typename T>
+                void benchVector()
+                {
+                    using V = Vector<dim, T>;
+                    const std::string name = "Vector" + std::to_string(dim) + suffix<T>() + " ";
+                    const std::vector<V> a = makeVectors<dim, T>(0), b = makeVectors<dim, T>(5);
+                    const T s = 3;
+
+                    benchBatch<V>(name + "operator+", [&](std::size_t i) { return a[i] + b[i]; });
+                    benchBatch<V>(name + "operator-", [&](std::size_t i) { return a[i] - b[i]; });
+                    benchBatch<V>(name + "operator*", [&](std::size_t i) { return a[i] * b[i]; });
+                    benchBatch<V>(name + "operator/", [&](std::size_t i) { return a[i] / b[i]; });
+                    benchBatch<V>(name + "operator+=", [&](std::size_t i) { V r = a[i]; r += b[i]; return r; });
+                    benchBatch<V>(name + "operator*=", [&](std::size_t i) { V r = a[i]; r *= b[i]; return r; });
+                    benchBatch<V>(name + "operator* scalar", [&](std::size_t i) { return a[i] * s; });
+                    benchBatch<V>(name + "operator/ scalar", [&](std::size_t i) { return a[i] / s; });
+                    benchBatch<V>(name + "negate", [&](std::size_t i) { return -a[i]; });
+                    benchBatch<bool>(name + "operator==", [&](std::size_t i) { return a[i] == b[i]; });
+                    benchBatch<T>(name + "dot", [&](std::size_t i) { return a[i].dot(b[i]); });
+                    benchBatch<T>(name + "getLengthSquared", [&](std::size_t i) { return a[i].getLengthSquared(); });
+                    benchBatch<T>(name + "getLength", [&](std::size_t i) { return a[i].getLength(); });
+                    benchBatch<V>(name + "getNormalized", [&](std::size_t i) { return a[i].getNormalized(); });
+                    benchBatch<V>(name + "normalize", [&](std::size_t i) { V r = a[i]; r.normalize(); return r; });
+                    if constexpr (dim == 3)
+                        benchBatch<V>(name + "cross", [&](std::size_t i) { return a[i].cross(b[i]); });
+                }
+
+            template<int dim, typename T>
+                void benchMatrix()
+                {
+                    using M = Matrix<dim, dim, T>;
+                    using V = Vector<dim, T>;
+                    const std::string name = "Matrix" + std::to_string(dim) + suffix<T>() + " ";
+                    const std::vector<M> a = makeMatrices<dim, T>(0), b = makeMatrices<dim, T>(5);
+                    const std::vector<V> v = makeVectors<dim, T>(3);
+
+                    benchBatch<M>(name + "operator+", [&](std::size_t i) { return a[i] + b[i]; });
+                    benchBatch<M>(name + "operator-", [&](std::size_t i) { return a[i] - b[i]; });
+                    benchBatch<M>(name + "operator* matrix", [&](std::size_t i) { return a[i] * b[i]; });
+                    benchBatch<V>(name + "operator* vector", [&](std::size_t i) { return a[i] * v[i]; });
+                    benchBatch<bool>(name + "operator==", [&](std::size_t i) { return a[i] == b[i]; });
+                    benchBatch<M>(name + "makeIdentity", [&](std::size_t) { return M::makeIdentity(); });
+                    benchBatch<T>(name + "getDeterminant", [&](std::size_t i) { return a[i].getDeterminant(); });
+                    if constexpr (std::is_floating_point_v<T>) {
+                        benchBatch<M>(name + "getInverse", [&](std::size_t i) { return a[i].getInverse(); });
+                        benchBatch<M>(name + "getAffineInverse", [&](std::size_t i) { M r; a[i].getAffineInverse(r); return r; });
+                        benchBatch<M>(name + "getRigidInverse", [&](std::size_t i) { return a[i].getRigidInverse(); });
+                    }
+                }
+
+            template<typename T>
+                void benchType()
+                {
+                    benchVector<2, T>();
+                    benchVector<3, T>();
+                    benchVector<4, T>();
+                    benchMatrix<2, T>();
+                    benchMatrix<3, T>();
+                    benchMatrix<4, T>();
+                }
+
+            // one op is one transformed vector
+            template<int dim, typename T>
+                void benchBatchTransform()
+                {
+                    const std::string name = "Vector" + std::to_string(dim) + suffix<T>() + " ";
+                    const std::vector<Vector<dim, T>> in = makeVectors<dim, T>(0);
+                    std::vector<Vector<dim, T>> out(batch);
+                    const Matrix<dim, dim, T> linear = makeMatrices<dim, T>(0)[0];
+                    const Matrix<dim + 1, dim + 1, T> affine = makeMatrices<dim + 1, T>(0)[0];
+
+                    measure(name + "transform", batch, [&]() {
+                        transform(linear, in.data(), out.data(), batch);
+                        doNotOptimize(out);
+                    }, minSeconds);
+                    measure(name + "transformPoints", batch, [&]() {
+                        transformPoints(affine, in.data(), out.data(), batch);
+                        doNotOptimize(out);
+                    }, minSeconds);
+                    measure(name + "transformDirections", batch, [&]() {
+                        transformDirections(affine, in.data(), out.data(), batch);
+                        doNotOptimize(out);
+                    }, minSeconds);
+                    if constexpr (std::is_floating_point_v<T>) {
+                        measure(name + "projectPoints", batch, [&]() {
+                            projectPoints(affine, in.data(), out.data(), batch);
+                            doNotOptimize(out);
+                        }, minSeconds);
+                    }
+                }
+
+            // one op is one vector of the soa container
+            template<int dim, typename T>
+                void benchSoA()
+                {
+                    const std::string name = "Vector" + std::to_string(dim) + suffix<T>() + "SoA ";
+                    const std::vector<Vector<dim, T>> a = makeVectors<dim, T>(0), b = makeVectors<dim, T>(5);
+                    VectorSoA<dim, T> sa(a.data(), batch), sb(b.data(), batch);
+                    std::vector<T> out(batch);
+
+                    measure(name + "operator+=", batch, [&]() {
+                        sa += sb;
+                        doNotOptimize(sa);
+                    }, minSeconds);
+                    measure(name + "fma", batch, [&]() {
+                        sa.fma(sb, T(0.5));
+                        doNotOptimize(sa);
+                    }, minSeconds);
+                    measure(name + "dot", batch, [&]() {
+                        sa.dot(sb, out.data());
+                        doNotOptimize(out);
+                    }, minSeconds);
+                    measure(name + "getLength", batch, [&]() {
+                        sa.getLength(out.data());
+                        doNotOptimize(out);
+                    }, minSeconds);
+                    measure(name + "normalize", batch, [&]() {
+                        sa.normalize();
+                        doNotOptimize(sa);
+                    }, minSeconds);
+                }
+
+            template<typename T>
+                void benchQuaternion()
+                {
+                    using Q = Quaternion<T>;
+                    const std::string name = "Quaternion" + suffix<T>() + " ";
+                    const std::vector<Vector<3, T>> v = makeVectors<3, T>(0);
+                    std::vector<Q> a(batch), b(batch);
+                    for (std::size_t i = 0; i < batch; i++) {
+                        a[i] = Q::fromAxisAngle(v[i].getNormalized(), T(0.01) * i);
+                        b[i] = Q::fromAxisAngle(v[(i + 5) % batch].getNormalized(), T(-0.02) * i);
+                    }
+                    const std::vector<Matrix<4, 4, T>> m = [&] {
+                        std::vector<Matrix<4, 4, T>> result(batch);
+                        for (std::size_t i = 0; i < batch; i++)
+                            result[i] = a[i].toMatrix4();
+                        return result;
+                    }();
+
+                    benchBatch<Q>(name + "operator*", [&](std::size_t i) { return a[i] * b[i]; });
+                    benchBatch<Q>(name + "getNormalized", [&](std::size_t i) { return a[i].getNormalized(); });
+                    benchBatch<Q>(name + "getInverse", [&](std::size_t i) { return a[i].getInverse(); });
+                    benchBatch<Q>(name + "nlerp", [&](std::size_t i) { return nlerp(a[i], b[i], T(0.3)); });
+                    benchBatch<Q>(name + "slerp", [&](std::size_t i) { return slerp(a[i], b[i], T(0.3)); });
+                    benchBatch<Q>(name + "fromAxisAngle", [&](std::size_t i) { return Q::fromAxisAngle(v[i], T(0.5)); });
+                    benchBatch<Q>(name + "fromMatrix", [&](std::size_t i) { return Q::fromMatrix(m[i]); });
+                    benchBatch<Matrix<3, 3, T>>(name + "toMatrix3", [&](std::size_t i) { return a[i].toMatrix3(); });
+                    benchBatch<Matrix<4, 4, T>>(name + "toMatrix4", [&](std::size_t i) { return a[i].toMatrix4(); });
+                    benchBatch<Vector<3, T>>(name + "rotate", [&](std::size_t i) { return a[i].rotate(v[i]); });
+
+                    std::vector<Vector<3, T>> out(batch);
+                    measure(name + "rotate batch", batch, [&]() {
+                        rotate(a[0], v.data(), out.data(), batch);
+                        doNotOptimize(out);
+                    }, minSeconds);
+                    measure(name + "rotate per-element batch", batch, [&]() {
+                        rotate(a.data(), v.data(), out.data(), batch);
+                        doNotOptimize(out);
+                    }, minSeconds);
+                }
+
+            template<typename T>
+                void benchAffineTransform()
+                {
+                    using A = AffineTransform<T>;
+                    const std::string name = "AffineTransform" + suffix<T>() + " ";
+                    const std::vector<Vector<3, T>> v = makeVectors<3, T>(0);
+                    std::vector<A> a(batch), b(batch);
+                    for (std::size_t i = 0; i < batch; i++) {
+                        const Quaternion<T> q = Quaternion<T>::fromAxisAngle(v[i].getNormalized(), T(0.01) * i);
+                        a[i] = A(q.toMatrix3(), v[i]);
+                        b[i] = A(q.getConjugate().toMatrix3(), v[(i + 5) % batch]);
+                    }
+
+                    benchBatch<A>(name + "operator*", [&](std::size_t i) { return a[i] * b[i]; });
+                    benchBatch<Vector<3, T>>(name + "transformPoint", [&](std::size_t i) { return a[i].transformPoint(v[i]); });
+                    benchBatch<Vector<3, T>>(name + "transformDirection", [&](std::size_t i) { return a[i].transformDirection(v[i]); });
+                    benchBatch<A>(name + "getInverse", [&](std::size_t i) { return a[i].getInverse(); });
+                    benchBatch<A>(name + "getRigidInverse", [&](std::size_t i) { return a[i].getRigidInverse(); });
+                    benchBatch<Matrix<4, 4, T>>(name + "toMatrix4", [&](std::size_t i) { return a[i].toMatrix4(); });
+
+                    std::vector<A> out(batch);
+                    measure(name + "compose batch", batch, [&]() {
+                        compose(a.data(), b.data(), out.data(), batch);
+                        doNotOptimize(out);
+                    }, minSeconds);
+                }
+
+            // per-frame scratch buffers from the heap and from an arena, one op is one element
+            void benchScratch()
+            {
+                const std::vector<Vector3> in = makeVectors<3, float>(0);
+                const Matrix4 affine = makeMatrices<4, float>(0)[0];
+
+                measure("scratch std::vector<Vector3>", batch, [&]() {
+                    std::vector<Vector3> scratch(batch);
+                    transformPoints(affine, in.data(), scratch.data(), batch);
+                    doNotOptimize(scratch);
+                }, minSeconds);
+
+                Arena arena;
+                measure("scratch Arena<Vector3> + reset", batch, [&]() {
+                    Vector3 *scratch = arena.allocate<Vector3>(batch);
+                    transformPoints(affine, in.data(), scratch, batch);
+                    doNotOptimize(scratch);
+                    arena.reset();
+                }, minSeconds);
+
+                // matrices of a plain std::vector may straddle cache lines, AlignedMatrix4 never does
+                const std::vector<Matrix4> a = makeMatrices<4, float>(0), b = makeMatrices<4, float>(5);
+                const std::vector<AlignedMatrix4> alignedA(a.begin(), a.end()), alignedB(b.begin(), b.end());
+                benchBatch<Matrix4>("AlignedMatrix4 operator* matrix", [&](std::size_t i) { return alignedA[i] * alignedB[i]; });
+            }
+
+            // bulk conversion of a vertex stream against converting element by element, ops are floats
+            template<typename T>
+                void benchStorage(const std::string &name)
+                {
+                    const std::size_t count = batch * 16;
+                    std::vector<float> in(count), out(count);
+                    for (std::size_t i = 0; i < count; i++)
+                        in[i] = static_cast<float>(i % 1000) / 1000.0f;
+                    std::vector<T> packed(count);
+
+                    measure(name + " static_cast", count, [&]() {
+                        for (std::size_t i = 0; i < count; i++)
+                            packed[i] = static_cast<T>(in[i]);
+                        doNotOptimize(packed);
+                    }, minSeconds);
+                    measure(name + " pack", count, [&]() {
+                        pack(in.data(), packed.data(), count);
+                        doNotOptimize(packed);
+                    }, minSeconds);
+                    measure(name + " unpack", count, [&]() {
+                        unpack(packed.data(), out.data(), count);
+                        doNotOptimize(out);
+                    }, minSeconds);
+                }
+
+            // one ray at a time against the same rays as packets of 16, ops are rays
+            void benchRayPackets()
+            {
+                const std::vector<Vector3> origins = makeVectors<3, float>(0);
+                const std::vector<Vector3> directions = makeVectors<3, float>(1);
+                std::vector<RayPacket16> packets(batch / 16);
+                for (std::size_t i = 0; i < batch; i++)
+                    packets[i / 16].set(static_cast<int>(i % 16), Rayf(origins[i], directions[i]));
+
+                const AABBf box(Vector3(-0.5f, -0.5f, -0.5f), Vector3(0.5f, 0.5f, 0.5f));
+                const Spheref sphere(Vector3(0.0f, 0.0f, 0.0f), 0.5f);
+                const Trianglef triangle(Vector3(-1.0f, -1.0f, 0.0f), Vector3(1.0f, -1.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+
+                measure("ray scalar AABB", batch, [&]() {
+                    std::size_t hits = 0;
+                    float t;
+                    for (std::size_t i = 0; i < batch; i++)
+                        hits += intersect(Rayf(origins[i], directions[i]), box, t);
+                    doNotOptimize(hits);
+                }, minSeconds);
+                measure("ray packet16 AABB", batch, [&]() {
+                    std::uint32_t hits = 0;
+                    for (const RayPacket16 &packet : packets)
+                        hits ^= intersect(packet, box);
+                    doNotOptimize(hits);
+                }, minSeconds);
+
+                measure("ray scalar sphere", batch, [&]() {
+                    std::size_t hits = 0;
+                    float t;
+                    for (std::size_t i = 0; i < batch; i++)
+                        hits += intersect(Rayf(origins[i], directions[i]), sphere, t);
+                    doNotOptimize(hits);
+                }, minSeconds);
+                measure("ray packet16 sphere", batch, [&]() {
+                    std::uint32_t hits = 0;
+                    for (RayPacket16 &packet : packets)
+                        hits ^= intersect(packet, sphere);
+                    doNotOptimize(hits);
+                }, minSeconds);
+
+                measure("ray scalar triangle", batch, [&]() {
+                    std::size_t hits = 0;
+                    float t;
+                    for (std::size_t i = 0; i < batch; i++)
+                        hits += intersect(Rayf(origins[i], directions[i]), triangle, t);
+                    doNotOptimize(hits);
+                }, minSeconds);
+                measure("ray packet16 triangle", batch, [&]() {
+                    std::uint32_t hits = 0;
+                    for (RayPacket16 &packet : packets)
+                        hits ^= intersect(packet, triangle);
+                    doNotOptimize(hits);
+                }, minSeconds);
+            }
+
+            // the stringstream baseline is what print() used to do for every value
+            void benchFormat()
+            {
+                const std::vector<Matrix4> matrices = makeMatrices<4, float>(0);
+
+                measure("format Matrix4 stringstream", batch, [&]() {
+                    std::size_t total = 0;
+                    for (std::size_t i = 0; i < batch; i++) {
+                        std::stringstream ss;
+                        for (int row = 0; row < 4; row++) {
+                            ss << "[ ";
+                            for (int col = 0; col < 4; col++)
+                                ss << matrices[i][row][col] << " ";
+                            ss << "]\n";
+                        }
+                        total += ss.str().size();
+                    }
+                    doNotOptimize(total);
+                }, minSeconds);
+
+                char text[1024];
+                measure("format Matrix4 to_chars", batch, [&]() {
+                    std::size_t total = 0;
+                    for (std::size_t i = 0; i < batch; i++)
+                        total += matrices[i].format(text, text + sizeof(text)) - text;
+                    doNotOptimize(total);
+                }, minSeconds);
+
+                // bulk mode, the sink only counts bytes so that no i/o is timed
+                std::size_t written = 0;
+                FormatWriter writer([](void *context, const char*, std::size_t size) { *static_cast<std::size_t*>(context) += size; }, &written);
+                measure("FormatWriter writeAll Matrix4", batch, [&]() {
+                    writer.writeAll(matrices.data(), batch);
+                    writer.flush();
+                }, minSeconds);
+                doNotOptimize(written);
+            }
+        }
+
+        void runCoreBench()
+        {
+            benchType<float>();
+            benchType<double>();
+            benchType<int>();
+
+            benchBatchTransform<2, float>();
+            benchBatchTransform<3, float>();
+            benchBatchTransform<3, double>();
+            benchBatchTransform<3, int>();
+
+            benchSoA<3, float>();
+            benchSoA<4, float>();
+            benchSoA<3, double>();
+
+            benchScratch();
+            benchFormat();
+            benchRayPackets();
+
+            benchStorage<Half>("Half");
+            benchStorage<Snorm16>("Snorm16");
+            benchStorage<Unorm8>("Unorm8");
+
+            benchQuaternion<float>();
+            benchQuaternion<double>();
+
+            benchAffineTransform<float>();
+            benchAffineTransform<double>();
+
+            const std::vector<float> angles = [] {
+                std::vector<float> result(batch);
+                for (std::size_t i = 0; i < batch; i++)
+                    result[i] = 0.001f * i;
+                return result;
+            }();
+            const std::vector<Vector3> positions = makeVectors<3, float>(0);
+            const std::vector<Vector2> positions2 = makeVectors<2, float>(0);
+
+            benchBatch<Matrix4>("createPerspectiveProjection", [&](std::size_t i) { return createPerspectiveProjection(1 + angles[i], 1.5f, 0.1f, 100.f); });
+            benchBatch<Matrix4>("createOrthographicProjection near/far", [&](std::size_t i) { return createOrthographicProjection(-1.f, angles[i] + 1, 1.f, -1.f, 0.1f, 100.f); });
+            benchBatch<Matrix4>("createOrthographicProjection", [&](std::size_t i) { return createOrthographicProjection(-1.f, angles[i] + 1, 1.f, -1.f); });
+            benchBatch<Matrix4>("createTranslation Vector3", [&](std::size_t i) { return createTranslation(positions[i]); });
+            benchBatch<Matrix3>("createTranslation Vector2", [&](std::size_t i) { return createTranslation(positions2[i]); });
+            benchBatch<Matrix4>("createRotationX", [&](std::size_t i) { return createRotationX(angles[i]); });
+            benchBatch<Matrix4>("createRotationY", [&](std::size_t i) { return createRotationY(angles[i]); });
+            benchBatch<Matrix4>("createRotationZ", [&](std::size_t i) { return createRotationZ(angles[i]); });
+            benchBatch<Matrix3>("createRotation", [&](std::size_t i) { return createRotation(angles[i]); });
+            benchBatch<Matrix4>("createScale", [&](std::size_t i) { return createScale(positions[i]); });
+            benchBatch<Matrix4>("createViewMatrix", [&](std::size_t i) { return createViewMatrix(positions[i], Vector3 {angles[i], 0.f, -1.f}, Vector3 {0.f, 1.f, 0.f}); });
+
+            {
+                std::vector<Quaternionf> rotations(batch);
+                std::vector<Vector3> eulerAngles(batch);
+                for (std::size_t i = 0; i < batch; i++) {
+                    rotations[i] = Quaternionf::fromAxisAngle(Vector3 {0.f, 1.f, 0.f}, angles[i]);
+                    eulerAngles[i] = Vector3 {angles[i], 2 * angles[i], 3 * angles[i]};
+                }
+
+                benchBatch<Matrix4>("createTRS Quaternionf", [&](std::size_t i) { return createTRS(positions[i], rotations[i], positions[i]); });
+                benchBatch<Matrix4>("createTRS euler", [&](std::size_t i) { return createTRS(positions[i], eulerAngles[i], positions[i]); });
+                // the same model matrix as a product of the single builders
+                benchBatch<Matrix4>("createTranslation * rotation * createScale", [&](std::size_t i) {
+                    return createTranslation(positions[i]) * rotations[i].toMatrix4() * createScale(positions[i]);
+                });
+            }
+
+            {
+                std::vector<float> s(batch), c(batch);
+                measure("sincos", batch, [&]() {
+                    for (std::size_t i = 0; i < batch; i++)
+                        sincos(angles[i], s[i], c[i]);
+                    doNotOptimize(s);
+                    doNotOptimize(c);
+                }, minSeconds);
+                measure("approx::sincos array", batch, [&]() {
+                    approx::sincos(angles.data(), s.data(), c.data(), batch);
+                    doNotOptimize(s);
+                    doNotOptimize(c);
+                }, minSeconds);
+                measure("approx::sin array", batch, [&]() {
+                    approx::sin(angles.data(), s.data(), batch);
+                    doNotOptimize(s);
+                }, minSeconds);
+                measure("approx::cos array", batch, [&]() {
+                    approx::cos(angles.data(), c.data(), batch);
+                    doNotOptimize(c);
+                }, minSeconds);
+                measure("approx::tan array", batch, [&]() {
+                    approx::tan(angles.data(), s.data(), batch);
+                    doNotOptimize(s);
+                }, minSeconds);
+                benchBatch<float>("approx::sin", [&](std::size_t i) { return approx::sin(angles[i]); });
+                benchBatch<float>("approx::tan", [&](std::size_t i) { return approx::tan(angles[i]); });
+            }
+
+            benchBatch<double>("toRadians", [&](std::size_t i) { return toRadians(angles[i]); });
+            benchBatch<double>("toDegrees", [&](std::size_t i) { return toDegrees(angles[i]); });
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#include "Bench.h"
+
+#include <cmath>
+#include <vector>
+#include <random>
+#include <cstdio>
+
+#include "../include/EquationSolving.h"
+
+namespace mathlib {
+    namespace bench {
+        namespace {
+            constexpr std::size_t batch = 1 << 16;
+
+            // ray-sphere style coefficients: a = |d|^2, b = 2 * d.(o - c), c = |o - c|^2 - r^2
+            // roughly half of the equations have real solutions
+            template<typename T>
+                void makeCoefficients(std::vector<T> &a, std::vector<T> &b, std::vector<T> &c)
+                {
+                    std::mt19937 rng(42);
+                    std::uniform_real_distribution<T> dist(-1, 1);
+                    a.resize(batch);
+                    b.resize(batch);
+                    c.resize(batch);
+                    for (std::size_t i = 0; i < batch; i++) {
+                        a[i] = 1 + std::abs(dist(rng));
+                        b[i] = 4 * dist(rng);
+                        c[i] = 2 * dist(rng);
+                    }
+                }
+
+            // compare the batch results against the scalar double solver
+            template<typename T>
+                void checkAccuracy(const std::string &name, const std::vector<T> &a, const std::vector<T> &b, const std::vector<T> &c,
+                        const std::vector<T> &x0, const std::vector<T> &x1, const std::vector<unsigned char> &valid)
+                {
+                    std::size_t mismatches = 0;
+                    double maxError = 0;
+                    for (std::size_t i = 0; i < batch; i++) {
+                        double r0, r1;
+                        const bool solved = solveQuadratic(a[i], b[i], c[i], r0, r1);
+                        if (solved != static_cast<bool>(valid[i])) {
+                            mismatches++;
+                            continue;
+                        }
+                        if (!solved)
+                            continue;
+
+                        maxError = std::max(maxError, std::abs(x0[i] - r0) / std::max(1.0, std::abs(r0)));
+                        maxError = std::max(maxError, std::abs(x1[i] - r1) / std::max(1.0, std::abs(r1)));
+                    }
+                    std::printf("%-48s %12zu mask mismatches, max relative error %g\n", ("  " + name).c_str(), mismatches, maxError);
+                }
+
+            template<typename T>
+                void benchBatch(const std::string &name)
+                {
+                    std::vector<T> a, b, c;
+                    makeCoefficients(a, b, c);
+                    std::vector<T> x0(batch), x1(batch);
+                    std::vector<unsigned char> valid(batch);
+
+                    measure(name + " batch", batch, [&]() {
+                        doNotOptimize(solveQuadratic(a.data(), b.data(), c.data(), x0.data(), x1.data(), valid.data(), batch));
+                    });
+                    checkAccuracy(name, a, b, c, x0, x1, valid);
+                }
+        }
+
+        void runEquationBench()
+        {
+            {
+                std::vector<double> a, b, c;
+                makeCoefficients(a, b, c);
+                std::vector<double> x0(batch), x1(batch);
+                std::vector<unsigned char> valid(batch);
+
+                measure("solveQuadratic scalar", batch, [&]() {
+                    for (std::size_t i = 0; i < batch; i++)
+                        valid[i] = solveQuadratic(a[i], b[i], c[i], x0[i], x1[i]);
+                    doNotOptimize(x0);
+                    doNotOptimize(x1);
+                });
+            }
+
+            benchBatch<float>("solveQuadratic float");
+            benchBatch<double>("solveQuadratic double");
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include "Bench.h"
+
+#include <vector>
+
+#include "../include/Expression.h"
+
+namespace mathlib {
+    namespace bench {
+        namespace {
+            constexpr std::size_t batch = 1 << 16;
+
+            template<typename T>
+                std::vector<T> makeBatch(typename expr::Traits<T>::ValueType seed)
+                {
+                    std::vector<T> result(batch);
+                    for (std::size_t i = 0; i < batch; i++)
+                        for (int n = 0; n < expr::Traits<T>::size; n++)
+                            result[i].data()[n] = seed + static_cast<typename expr::Traits<T>::ValueType>((i + n) % 17);
+                    return result;
+                }
+
+            // r = a + b * s - c * t + d / u over a batch, once with eager temporaries and once fused
+            template<typename V>
+                void benchVectorExpression(const std::string &name)
+                {
+                    using vtype = typename expr::Traits<V>::ValueType;
+                    const std::vector<V> a = makeBatch<V>(1), b = makeBatch<V>(2), c = makeBatch<V>(3), d = makeBatch<V>(4);
+                    std::vector<V> r(batch);
+                    const vtype s = 1.5, t = 0.25, u = 4;
+
+                    measure(name + " eager", batch, [&]() {
+                        for (std::size_t i = 0; i < batch; i++)
+                            r[i] = a[i] + b[i] * s - c[i] * t + d[i] / u;
+                        doNotOptimize(r);
+                    });
+
+                    measure(name + " fused", batch, [&]() {
+                        for (std::size_t i = 0; i < batch; i++)
+                            assign(r[i], lazy(a[i]) + lazy(b[i]) * s - lazy(c[i]) * t + lazy(d[i]) / u);
+                        doNotOptimize(r);
+                    });
+                }
+
+            // r = a + b - c + d * s over a batch of matrices
+            template<typename M>
+                void benchMatrixExpression(const std::string &name)
+                {
+                    using vtype = typename expr::Traits<M>::ValueType;
+                    const std::vector<M> a = makeBatch<M>(1), b = makeBatch<M>(2), c = makeBatch<M>(3), d = makeBatch<M>(4);
+                    std::vector<M> r(batch);
+                    const vtype s = 2;
+
+                    measure(name + " eager", batch, [&]() {
+                        for (std::size_t i = 0; i < batch; i++) {
+                            M scaled;
+                            for (int n = 0; n < expr::Traits<M>::size; n++)
+                                scaled.data()[n] = d[i].data()[n] * s;
+                            r[i] = a[i] + b[i] - c[i] + scaled;
+                        }
+                        doNotOptimize(r);
+                    });
+
+                    measure(name + " fused", batch, [&]() {
+                        for (std::size_t i = 0; i < batch; i++)
+                            assign(r[i], lazy(a[i]) + lazy(b[i]) - lazy(c[i]) + lazy(d[i]) * s);
+                        doNotOptimize(r);
+                    });
+                }
+        }
+
+        void runExpressionBench()
+        {
+            benchVectorExpression<Vector3f>("expression Vector3f a+b*s-c*t+d/u");
+            benchVectorExpression<Vector4f>("expression Vector4f a+b*s-c*t+d/u");
+            benchVectorExpression<Vector4d>("expression Vector4d a+b*s-c*t+d/u");
+            benchVectorExpression<Vector<16, float>>("expression Vector16f a+b*s-c*t+d/u");
+            benchMatrixExpression<Matrix4f>("expression Matrix4f a+b-c+d*s");
+            benchMatrixExpression<Matrix4d>("expression Matrix4d a+b-c+d*s");
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#include "Bench.h"
+
+#include <random>
+#include <cstring>
+
+#include "../include/Kernels.h"
+
+namespace mathlib {
+    namespace bench {
+        namespace {
+            constexpr int cases = 200000;
+
+            // the generic loops of Matrix::operator*, Matrix::operator*(Vector), AffineTransform::operator* and
+            // Vector::dot written out with the same statements, so the compiler contracts them the same way
+            template<typename T>
+                void multiply(const T *a, const T *b, T *r)
+                {
+                    for (int i = 0; i < 16; i++)
+                        r[i] = 0;
+                    for (int row = 0; row < 4; row++)
+                        for (int n = 0; n < 4; n++) {
+                            const T value = a[row * 4 + n];
+                            for (int col = 0; col < 4; col++)
+                                r[row * 4 + col] += value * b[n * 4 + col];
+                        }
+                }
+
+            template<typename T>
+                void transform(const T *a, const T *v, T *r)
+                {
+                    for (int row = 0; row < 4; row++) {
+                        T sum = 0;
+                        for (int col = 0; col < 4; col++)
+                            sum += a[row * 4 + col] * v[col];
+                        r[row] = sum;
+                    }
+                }
+
+            template<typename T>
+                void affineMultiply(const T *a, const T *b, T *r)
+                {
+                    for (int row = 0; row < 3; row++)
+                        for (int col = 0; col < 4; col++) {
+                            T sum = 0;
+                            for (int n = 0; n < 3; n++)
+                                sum += a[row * 4 + n] * b[n * 4 + col];
+                            if (col == 3)
+                                sum += a[row * 4 + 3];
+                            r[row * 4 + col] = sum;
+                        }
+                }
+
+            template<typename T>
+                void dot(const T *a, const T *b, T *r)
+                {
+                    T sum = 0;
+                    for (int n = 0; n < 4; n++)
+                        sum += a[n] * b[n];
+                    r[0] = sum;
+                }
+
+            // run kernel and reference on random operands and count the results that differ in any bit
+            template<typename T, int outputs, typename Kernel, typename Reference>
+                void check(const char *name, Kernel kernel, Reference reference)
+                {
+                    std::mt19937 random(42);
+                    std::uniform_real_distribution<T> distribution(T(-1), T(1));
+
+                    long differing = 0;
+                    for (int i = 0; i < cases; i++) {
+                        T a[16], b[16], expected[outputs], actual[outputs];
+                        for (int n = 0; n < 16; n++) {
+                            a[n] = distribution(random);
+                            b[n] = distribution(random);
+                        }
+                        reference(a, b, expected);
+                        kernel(a, b, actual);
+                        for (int n = 0; n < outputs; n++)
+                            differing += std::memcmp(&expected[n], &actual[n], sizeof(T)) != 0;
+                    }
+                    std::printf("%-48s %12ld of %d values differ%s\n", name, differing, cases * outputs,
+                            differing == 0 ? "" : "  MISMATCH");
+                }
+
+            template<typename T>
+                void checkType(const char *type)
+                {
+                    const std::string suffix = std::string(" ") + type;
+                    if constexpr (detail::MultiplyKernel<4, 4, 4, T>::simd)
+                        check<T, 16>(("kernel check multiply 4x4" + suffix).c_str(), detail::MultiplyKernel<4, 4, 4, T>::run, multiply<T>);
+                    if constexpr (detail::TransformKernel<4, 4, T>::simd)
+                        check<T, 4>(("kernel check transform 4x4" + suffix).c_str(), detail::TransformKernel<4, 4, T>::run, transform<T>);
+                    if constexpr (detail::AffineMultiplyKernel<T>::simd)
+                        check<T, 12>(("kernel check affine multiply" + suffix).c_str(), detail::AffineMultiplyKernel<T>::run, affineMultiply<T>);
+                    if constexpr (detail::DotKernel<4, T>::simd)
+                        check<T, 1>(("kernel check dot 4" + suffix).c_str(), [](const T *a, const T *b, T *r) {
+                            r[0] = detail::DotKernel<4, T>::run(a, b);
+                        }, dot<T>);
+                }
+        }
+
+        void runKernelCheck()
+        {
+            // the simd kernels replace the generic loops only where their results are bit-for-bit identical,
+            // every line should report zero differing values for the compiler flags of this build
+            checkType<float>("float");
+            checkType<double>("double");
+        }
+    }
+}
@@ -0,0 +1,283 @@
+#include "Bench.h"
+
+#include <cmath>
+#include <vector>
+#include <cstdio>
+
+#include "../include/Frustum.h"
+#include "../include/Eigensolver.h"
+#include "../include/ThreadPool.h"
+#include "../include/Instrumentation.h"
+#include "../include/Quaternion.h"
+#include "../include/SparseMatrix.h"
+#include "../include/IterativeSolver.h"
+#include "../include/DenseMatrix.h"
+#include "../include/BatchTransform.h"
+#include "../include/MatrixTransform.h"
+
+namespace mathlib {
+    namespace bench {
+        namespace {
+            // thread counts 1, 2, 4, ... up to the hardware concurrency
+            std::vector<int> threadCounts()
+            {
+                std::vector<int> counts;
+                const int hardware = ThreadPool::defaultThreadCount();
+                for (int threads = 1; threads < hardware; threads *= 2)
+                    counts.push_back(threads);
+                counts.push_back(hardware);
+                return counts;
+            }
+
+            // run one measurement per thread count and report the speedup over a single thread
+            template<typename F>
+                void scaling(const std::string &name, std::size_t opsPerCall, F f)
+                {
+                    double serial = 0;
+                    for (int threads : threadCounts()) {
+                        ThreadPool::setGlobalThreadCount(threads);
+                        const Result result = measure(name + " threads=" + std::to_string(threads), opsPerCall, f);
+                        if (threads == 1)
+                            serial = result.nsPerOp;
+                        std::printf("%-48s %12.2fx\n", "  speedup", serial / result.nsPerOp);
+                    }
+                    ThreadPool::setGlobalThreadCount(ThreadPool::defaultThreadCount());
+                }
+        }
+
+        void runParallelBench()
+        {
+            {
+                // counted fixed-size products from every worker; compare a build with MATHLIB_ENABLE_INSTRUMENTATION
+                // against one without for the overhead, the snapshot sums the counters of the pools scaling
+                // created and retired and is empty when the switch is off
+                std::vector<Matrix4> models(1 << 20, createTranslation(Vector3 {1.f, 2.f, 3.f}));
+                const Matrix4 rotation = createRotationY(0.001f);
+                instrumentation::reset();
+                scaling("parallelFor Matrix4 multiply 1M", models.size(), [&]() {
+                    ThreadPool::global().parallelFor(0, models.size(), 4096, [&](std::size_t first, std::size_t last) {
+                        for (std::size_t i = first; i < last; i++)
+                            models[i] = rotation * models[i];
+                    });
+                    doNotOptimize(models);
+                });
+                FormatWriter writer(stdout);
+                instrumentation::takeSnapshot().writeText(writer);
+            }
+
+            {
+                const int n = 1024;
+                DenseMatrixf a(n, n), b(n, n), c(n, n);
+                a.fill(1.f);
+                b.fill(0.5f);
+                // one op is one multiply-add
+                scaling("gemm float 1024", static_cast<std::size_t>(n) * n * n, [&]() {
+                    gemm(1.f, a, b, 0.f, c);
+                    doNotOptimize(c);
+                });
+            }
+
+            {
+                // strassen against gemm with every thread, ops are the n^3 multiply-adds of the classical product
+                // so that ns/op of both is comparable; the crossover decides strassenCutoff
+                for (int n : {256, 512, 1024, 2048}) {
+                    DenseMatrixf a(n, n), b(n, n), c(n, n);
+                    a.fill(1.f);
+                    b.fill(0.5f);
+                    const std::size_t ops = static_cast<std::size_t>(n) * n * n;
+                    measure("gemm float " + std::to_string(n), ops, [&]() {
+                        gemm(1.f, a, b, 0.f, c);
+                        doNotOptimize(c);
+                    });
+                    for (int cutoff = n / 2; cutoff >= 128; cutoff /= 2)
+                        measure("strassen float " + std::to_string(n) + " cutoff=" + std::to_string(cutoff), ops, [&]() {
+                            strassen(a, b, c, cutoff);
+                            doNotOptimize(c);
+                        });
+                }
+            }
+
+            {
+                const int n = 2048;
+                DenseMatrixf a(n, n), b(n, n);
+                a.fill(1.f);
+                const std::size_t elements = static_cast<std::size_t>(n) * n;
+                measure("transpose naive float 2048", elements, [&]() {
+                    for (int i = 0; i < n; i++)
+                        for (int j = 0; j < n; j++)
+                            b(j, i) = a(i, j);
+                    doNotOptimize(b);
+                });
+                measure("transpose blocked float 2048", elements, [&]() {
+                    b = a.getTransposed();
+                    doNotOptimize(b);
+                });
+                measure("transpose in place float 2048", elements, [&]() {
+                    a.transpose();
+                    doNotOptimize(a);
+                });
+            }
+
+            {
+                const int n = 1024;
+                DenseMatrixf a(n, n), b(n, n), c(n, n);
+                a.fill(1.f);
+                b.fill(0.5f);
+                const std::size_t ops = static_cast<std::size_t>(n) * n * n;
+                measure("gemm A*B^T transposed copy float 1024", ops, [&]() {
+                    c = a * b.getTransposed();
+                    doNotOptimize(c);
+                });
+                measure("gemm A*B^T multiplyByTransposed float 1024", ops, [&]() {
+                    c = a.multiplyByTransposed(b);
+                    doNotOptimize(c);
+                });
+                measure("gemm A^T*B multiplyTransposed float 1024", ops, [&]() {
+                    c = a.multiplyTransposed(b);
+                    doNotOptimize(c);
+                });
+            }
+
+            {
+                const int n = 4096;
+                DenseMatrixd a(n, n);
+                DenseVectord x(n), y(n);
+                a.fill(1.0);
+                x.fill(0.5);
+                scaling("gemv double 4096", static_cast<std::size_t>(n) * n, [&]() {
+                    gemv(1.0, a, x, 0.0, y);
+                    doNotOptimize(y);
+                });
+            }
+
+            {
+                std::vector<Vector3> points(1 << 22, Vector3 {1.f, 2.f, 3.f});
+                const Matrix4 matrix = createTranslation(Vector3 {1.f, 0.f, 0.f});
+                scaling("transformPoints 4M", points.size(), [&]() {
+                    transformPoints(matrix, points.data(), points.data(), points.size());
+                    doNotOptimize(points);
+                });
+            }
+
+            {
+                const std::size_t nodes = 1 << 17;
+                std::vector<Vector3> translations(nodes), scales(nodes, Vector3 {1.f, 1.f, 1.f});
+                std::vector<Quaternionf> rotations(nodes);
+                std::vector<Matrix4> models(nodes);
+                for (std::size_t i = 0; i < nodes; i++) {
+                    translations[i] = Vector3 {static_cast<float>(i), 0.f, 0.f};
+                    rotations[i] = Quaternionf::fromAxisAngle(Vector3 {0.f, 0.f, 1.f}, 0.001f * i);
+                }
+                scaling("createTRS 128k", nodes, [&]() {
+                    createTRS(translations.data(), rotations.data(), scales.data(), models.data(), nodes);
+                    doNotOptimize(models);
+                });
+            }
+
+            {
+                // a 16M-object scene on a 256^3 grid seen from its center, roughly a tenth is visible
+                const std::size_t objects = 1 << 24;
+                VectorSoA<3, float> centers(objects), mins(objects), maxs(objects);
+                std::vector<float> radii(objects, 0.5f);
+                for (std::size_t i = 0; i < objects; i++) {
+                    const Vector3 center(static_cast<float>(i % 256) - 128.f, static_cast<float>(i / 256 % 256) - 128.f, static_cast<float>(i / 65536) - 128.f);
+                    centers.set(i, center);
+                    mins.set(i, center - Vector3(0.5f, 0.5f, 0.5f));
+                    maxs.set(i, center + Vector3(0.5f, 0.5f, 0.5f));
+                }
+                const Frustum frustum(createPerspectiveProjection(60.f, 16.f / 9.f, 0.1f, 200.f)
+                        * createViewMatrix(Vector3(0.f, 0.f, 0.f), Vector3(0.f, 0.f, -1.f), Vector3(0.f, 1.f, 0.f)));
+                std::vector<unsigned char> visible(objects);
+                std::vector<std::uint32_t> indices(objects);
+
+                scaling("cullSpheres mask 16M", objects, [&]() {
+                    doNotOptimize(cullSpheres(frustum, centers, radii.data(), visible.data()));
+                });
+                scaling("cullBoxes indices 16M", objects, [&]() {
+                    doNotOptimize(cullBoxes(frustum, mins, maxs, indices.data()));
+                });
+            }
+
+            {
+                // covariance-like matrices of 1M point clusters
+                const std::size_t clusters = 1 << 20;
+                std::vector<Matrix3f> covariances(clusters);
+                for (std::size_t i = 0; i < clusters; i++) {
+                    const Vector3 axis(1.f + static_cast<float>(i % 7), static_cast<float>(i % 13) - 6.f, 0.25f * static_cast<float>(i % 5));
+                    for (int r = 0; r < 3; r++)
+                        for (int c = 0; c < 3; c++)
+                            covariances[i][r][c] = axis[r] * axis[c] + (r == c ? 0.5f : 0.f);
+                }
+                std::vector<Vector3> values(clusters);
+                std::vector<Matrix3f> vectors(clusters);
+                scaling("eigenSymmetric 3x3 float 1M", clusters, [&]() {
+                    eigenSymmetric(covariances.data(), values.data(), vectors.data(), clusters);
+                    doNotOptimize(vectors);
+                });
+            }
+
+            {
+                const int n = 512;
+                DenseMatrixd a(n, n);
+                for (int i = 0; i < n; i++)
+                    for (int j = 0; j <= i; j++)
+                        a(i, j) = a(j, i) = 1.0 / (1 + i + j) + (i == j ? 1.0 : 0.0);
+                SymmetricEigenDecomposition<double> eigen;
+                scaling("symmetric eigen double 512", 1, [&]() {
+                    doNotOptimize(eigen.factor(a));
+                });
+                scaling("symmetric eigenvalues double 512", 1, [&]() {
+                    doNotOptimize(eigen.factor(a, false));
+                });
+
+                const int rows = 512, cols = 256;
+                DenseMatrixd b(rows, cols);
+                for (int i = 0; i < rows; i++)
+                    for (int j = 0; j < cols; j++)
+                        b(i, j) = std::sin(0.37 * i + 1.3 * j) + (i == j ? 2.0 : 0.0);
+                SingularValueDecomposition<double> svd;
+                scaling("jacobi svd double 512x256", 1, [&]() {
+                    doNotOptimize(svd.factor(b));
+                });
+            }
+
+            {
+                // 5-point laplacian on a 1024 x 1024 grid, 1M rows with 5 nonzeros each
+                const int m = 1024, n = m * m;
+                SparseBuilderd builder(n, n);
+                builder.reserve(static_cast<std::size_t>(n) * 5);
+                for (int i = 0; i < m; i++) {
+                    for (int j = 0; j < m; j++) {
+                        const int row = i * m + j;
+                        builder.add(row, row, 4.0);
+                        if (i > 0)
+                            builder.add(row, row - m, -1.0);
+                        if (i < m - 1)
+                            builder.add(row, row + m, -1.0);
+                        if (j > 0)
+                            builder.add(row, row - 1, -1.0);
+                        if (j < m - 1)
+                            builder.add(row, row + 1, -1.0);
+                    }
+                }
+                const CsrMatrixd a(builder);
+                DenseVectord x(n), y(n);
+                x.fill(1.0);
+                scaling("csr spmv double 1M", a.nonZeros(), [&]() {
+                    a.multiply(x, y);
+                    doNotOptimize(y);
+                });
+
+                // a fixed number of iterations, the tolerance is out of reach
+                IterativeSolverOptions options;
+                options.maxIterations = 20;
+                options.tolerance = 0;
+                scaling("conjugateGradient double 1M x20", 20, [&]() {
+                    DenseVectord solution;
+                    conjugateGradient(a, x, solution, options);
+                    doNotOptimize(solution);
+                });
+            }
+        }
+    }
+}
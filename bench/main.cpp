@@ -0,0 +1,94 @@
+#include "Bench.h"
+
+#include <cstring>
+
+#include "../include/Simd.h"
+
+namespace {
+    struct Suite {
+        const char *name;
+        void (*run)();
+    };
+
+    const Suite suites[] = {
+        {"core", mathlib::bench::runCoreBench},
+        {"equation", mathlib::bench::runEquationBench},
+        {"expression", mathlib::bench::runExpressionBench},
+        {"kernels", mathlib::bench::runKernelCheck},
+        {"parallel", mathlib::bench::runParallelBench},
+    };
+
+    const char *simdLevel()
+    {
+#if defined(MATHLIB_AVX)
+        return "avx";
+#elif defined(MATHLIB_SSE2)
+        return "sse2";
+#else
+        return "none";
+#endif
+    }
+
+    // one object per measurement, stable keys so that results can be compared release over release
+    bool writeJson(const char *path)
+    {
+        std::FILE *file = std::fopen(path, "w");
+        if (!file)
+            return false;
+
+        std::fprintf(file, "{\n  \"simd\": \"%s\",\n  \"results\": [", simdLevel());
+        const std::vector<mathlib::bench::Result> &results = mathlib::bench::results();
+        for (std::size_t i = 0; i < results.size(); i++) {
+            const mathlib::bench::Result &result = results[i];
+            std::fprintf(file, "%s\n    {\"name\": \"%s\", \"ns_per_op\": %.6g, \"ops_per_second\": %.6g, \"allocations_per_op\": %.6g}",
+                    i == 0 ? "" : ",", result.name.c_str(), result.nsPerOp, result.opsPerSecond, result.allocationsPerOp);
+        }
+        std::fprintf(file, "\n  ]\n}\n");
+        return std::fclose(file) == 0;
+    }
+
+    void usage(const char *program)
+    {
+        std::fprintf(stderr, "usage: %s [--json FILE] [SUITE...]\nsuites:", program);
+        for (const Suite &suite : suites)
+            std::fprintf(stderr, " %s", suite.name);
+        std::fprintf(stderr, "\nwithout a suite argument every suite runs\n");
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *jsonPath = nullptr;
+    std::vector<const Suite*> selected;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+            continue;
+        }
+
+        const Suite *match = nullptr;
+        for (const Suite &suite : suites)
+            if (std::strcmp(argv[i], suite.name) == 0)
+                match = &suite;
+
+        if (!match) {
+            usage(argv[0]);
+            return 1;
+        }
+        selected.push_back(match);
+    }
+
+    if (selected.empty())
+        for (const Suite &suite : suites)
+            selected.push_back(&suite);
+
+    for (const Suite *suite : selected)
+        suite->run();
+
+    if (jsonPath && !writeJson(jsonPath)) {
+        std::fprintf(stderr, "could not write %s\n", jsonPath);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "Inverse.h"
+#include "Kernels.h"
+#include "BatchTransform.h"
+
+namespace mathlib {
+    // 3d affine transform stored as the upper 3x4 block of a 4x4 matrix whose last row is the
+    // implicit [0 0 0 1], e.g. anything built from createTranslation, createRotation* and createScale
+    // 12 instead of 16 values, and composition takes 36 instead of 64 multiplies
+    // row-major order, the linear part in the first three columns and the translation in the last
+    template<typename vtype = float>
+        class AffineTransform {
+            private:
+                Matrix<3, 4, vtype> _val = {
+                    vtype(1), vtype(0), vtype(0), vtype(0),
+                    vtype(0), vtype(1), vtype(0), vtype(0),
+                    vtype(0), vtype(0), vtype(1), vtype(0)
+                };
+
+                using ThisType = AffineTransform<vtype>;
+
+            public:
+                // default constructor that creates the identity transform
+                constexpr AffineTransform() = default;
+
+                constexpr explicit AffineTransform(const Matrix<3, 4, vtype> &matrix)
+                    : _val(matrix) {}
+
+                // the last row of matrix is assumed to be [0 0 0 1] and is dropped
+                constexpr explicit AffineTransform(const Matrix<4, 4, vtype> &matrix)
+                {
+                    for (int row = 0; row < 3; row++)
+                        for (int col = 0; col < 4; col++)
+                            _val[row][col] = matrix[row][col];
+                }
+
+                constexpr AffineTransform(const Matrix<3, 3, vtype> &linear, const Vector<3, vtype> &translation)
+                {
+                    for (int row = 0; row < 3; row++) {
+                        for (int col = 0; col < 3; col++)
+                            _val[row][col] = linear[row][col];
+                        _val[row][3] = translation[row];
+                    }
+                }
+
+                constexpr const std::array<vtype, 4> &operator[](int row) const
+                {
+                    return _val[row];
+                }
+
+                constexpr std::array<vtype, 4> &operator[](int row)
+                {
+                    return _val[row];
+                }
+
+                // pointer to the contiguous row-major 3x4 storage
+                constexpr const vtype *data() const { return _val.data(); }
+                constexpr vtype *data() { return _val.data(); }
+
+                constexpr const Matrix<3, 4, vtype> &getMatrix() const
+                {
+                    return _val;
+                }
+
+                constexpr Matrix<3, 3, vtype> getLinear() const
+                {
+                    return Matrix<3, 3, vtype> {
+                        _val[0][0], _val[0][1], _val[0][2],
+                        _val[1][0], _val[1][1], _val[1][2],
+                        _val[2][0], _val[2][1], _val[2][2]
+                    };
+                }
+
+                constexpr Vector<3, vtype> getTranslation() const
+                {
+                    return Vector<3, vtype> {_val[0][3], _val[1][3], _val[2][3]};
+                }
+
+                // full homogeneous matrix, e.g. to be multiplied with a projection
+                constexpr Matrix<4, 4, vtype> toMatrix4() const
+                {
+                    return Matrix<4, 4, vtype> {
+                        _val[0][0], _val[0][1], _val[0][2], _val[0][3],
+                        _val[1][0], _val[1][1], _val[1][2], _val[1][3],
+                        _val[2][0], _val[2][1], _val[2][2], _val[2][3],
+                        vtype(0), vtype(0), vtype(0), vtype(1)
+                    };
+                }
+
+                // composition, (a * b) applies b first and then a, same as the 4x4 product
+                constexpr ThisType operator*(const ThisType &other) const
+                {
+                    ThisType result;
+                    if constexpr (detail::AffineMultiplyKernel<vtype>::simd) {
+                        if (!detail::isConstantEvaluated()) {
+                            detail::AffineMultiplyKernel<vtype>::run(data(), other.data(), result.data());
+                            return result;
+                        }
+                    }
+
+                    for (int row = 0; row < 3; row++) {
+                        for (int col = 0; col < 4; col++) {
+                            vtype sum = 0;
+                            for (int n = 0; n < 3; n++)
+                                sum += _val[row][n] * other._val[n][col];
+                            if (col == 3)
+                                sum += _val[row][3];
+                            result._val[row][col] = sum;
+                        }
+                    }
+                    return result;
+                }
+
+                constexpr ThisType &operator*=(const ThisType &other)
+                {
+                    return (*this) = (*this) * other;
+                }
+
+                // point (implicit w = 1)
+                constexpr Vector<3, vtype> transformPoint(const Vector<3, vtype> &v) const
+                {
+                    Vector<3, vtype> result;
+                    for (int row = 0; row < 3; row++)
+                        result[row] = _val[row][0] * v[0] + _val[row][1] * v[1] + _val[row][2] * v[2] + _val[row][3];
+                    return result;
+                }
+
+                // direction (implicit w = 0), translation has no effect
+                constexpr Vector<3, vtype> transformDirection(const Vector<3, vtype> &v) const
+                {
+                    Vector<3, vtype> result;
+                    for (int row = 0; row < 3; row++)
+                        result[row] = _val[row][0] * v[0] + _val[row][1] * v[1] + _val[row][2] * v[2];
+                    return result;
+                }
+
+                constexpr bool operator==(const ThisType &other) const
+                {
+                    return _val == other._val;
+                }
+
+                constexpr bool operator!=(const ThisType &other) const
+                {
+                    return !((*this) == other);
+                }
+
+                // return true if the linear part is invertible and store the inverse in result,
+                // otherwise result is set to the zero transform
+                bool getInverse(ThisType &result) const
+                {
+                    static_assert(std::is_floating_point_v<vtype>, "inverse requires a floating point type");
+                    Matrix<3, 3, vtype> linear = getLinear();
+
+                    // built in a local and assigned once, result may be this transform
+                    Matrix<3, 4, vtype> inverse;
+                    const bool invertible = detail::invert<3>(linear.data(), linear.data());
+                    if (invertible) {
+                        for (int row = 0; row < 3; row++) {
+                            vtype translation = 0;
+                            for (int col = 0; col < 3; col++) {
+                                inverse[row][col] = linear[row][col];
+                                translation -= linear[row][col] * _val[col][3];
+                            }
+                            inverse[row][3] = translation;
+                        }
+                    }
+                    result._val = inverse;
+                    return invertible;
+                }
+
+                // return the inverse or the zero transform if the linear part is singular
+                ThisType getInverse() const
+                {
+                    ThisType result;
+                    getInverse(result);
+                    return result;
+                }
+
+                // inverse of a rigid transform (rotation and translation only):
+                // the rotation part is orthonormal, so its inverse is its transpose
+                constexpr ThisType getRigidInverse() const
+                {
+                    ThisType result;
+                    for (int row = 0; row < 3; row++) {
+                        vtype translation = 0;
+                        for (int col = 0; col < 3; col++) {
+                            result._val[row][col] = _val[col][row];
+                            translation -= _val[col][row] * _val[col][3];
+                        }
+                        result._val[row][3] = translation;
+                    }
+                    return result;
+                }
+        };
+
+    // batch versions over the simd/parallel kernels of BatchTransform.h, in and out may alias
+    template<typename vtype>
+        void transformPoints(const AffineTransform<vtype> &transform, const Vector<3, vtype> *in, Vector<3, vtype> *out, std::size_t count)
+        {
+            transformPoints(transform.toMatrix4(), in, out, count);
+        }
+
+    template<typename vtype>
+        void transformDirections(const AffineTransform<vtype> &transform, const Vector<3, vtype> *in, Vector<3, vtype> *out, std::size_t count)
+        {
+            transformDirections(transform.toMatrix4(), in, out, count);
+        }
+
+    // out[n] = parents[n] * locals[n], e.g. local to world transforms of a scene graph level,
+    // out may alias either input
+    template<typename vtype>
+        void compose(const AffineTransform<vtype> *parents, const AffineTransform<vtype> *locals, AffineTransform<vtype> *out, std::size_t count)
+        {
+            for (std::size_t n = 0; n < count; n++)
+                out[n] = parents[n] * locals[n];
+        }
+
+    using AffineTransformf = AffineTransform<float>;
+    using AffineTransformd = AffineTransform<double>;
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Matrix.h"
+#include "Simd.h"
+#include "ThreadPool.h"
+#include "Instrumentation.h"
+
+namespace mathlib {
+    // batch transforms apply one matrix to a contiguous array of vectors
+    // the matrix is loaded once and kept in registers while the data is streamed;
+    // in and out may point to the same array to transform in place; large batches are split
+    // across ThreadPool::global()
+
+    namespace detail {
+        // w selects the implicit homogeneous coordinate: 1 for points, 0 for directions
+        template<int dim, typename vtype, int w, bool divide>
+            void transformAffineGeneric(const Matrix<dim + 1, dim + 1, vtype> &matrix,
+                    const Vector<dim, vtype> *in, Vector<dim, vtype> *out, std::size_t count)
+            {
+                vtype m[dim + 1][dim + 1];
+                for (int row = 0; row < dim + 1; row++)
+                    for (int col = 0; col < dim + 1; col++)
+                        m[row][col] = matrix[row][col];
+
+                for (std::size_t i = 0; i < count; i++) {
+                    vtype v[dim];
+                    for (int n = 0; n < dim; n++)
+                        v[n] = in[i][n];
+
+                    vtype r[dim + 1];
+                    for (int row = 0; row < dim + 1; row++) {
+                        vtype sum = 0;
+                        for (int col = 0; col < dim; col++)
+                            sum += m[row][col] * v[col];
+                        r[row] = (w == 1) ? sum + m[row][dim] : sum;
+                    }
+
+                    for (int n = 0; n < dim; n++) {
+                        if constexpr (divide)
+                            out[i][n] = r[n] / r[dim];
+                        else
+                            out[i][n] = r[n];
+                    }
+                }
+            }
+
+#if defined(MATHLIB_SSE2)
+        inline void transformAffineSse(const Matrix<4, 4, float> &matrix,
+                const Vector<3, float> *in, Vector<3, float> *out, std::size_t count, float w, bool divide)
+        {
+            __m128 c0 = _mm_loadu_ps(matrix.data());
+            __m128 c1 = _mm_loadu_ps(matrix.data() + 4);
+            __m128 c2 = _mm_loadu_ps(matrix.data() + 8);
+            __m128 c3 = _mm_loadu_ps(matrix.data() + 12);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            const __m128 offset = _mm_mul_ps(c3, _mm_set1_ps(w));
+
+            for (std::size_t i = 0; i < count; i++) {
+                const float *p = in[i].data();
+                __m128 acc = _mm_mul_ps(c0, _mm_set1_ps(p[0]));
+                acc = _mm_add_ps(acc, _mm_mul_ps(c1, _mm_set1_ps(p[1])));
+                acc = _mm_add_ps(acc, _mm_mul_ps(c2, _mm_set1_ps(p[2])));
+                acc = _mm_add_ps(acc, offset);
+                if (divide)
+                    acc = _mm_div_ps(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(3, 3, 3, 3)));
+
+                // store only xyz so that neither the next element nor the end of the array is touched
+                float *o = out[i].data();
+                _mm_storel_pi(reinterpret_cast<__m64 *>(o), acc);
+                _mm_store_ss(o + 2, _mm_movehl_ps(acc, acc));
+            }
+        }
+
+        inline void transformSse(const Matrix<4, 4, float> &matrix,
+                const Vector<4, float> *in, Vector<4, float> *out, std::size_t count)
+        {
+            __m128 c0 = _mm_loadu_ps(matrix.data());
+            __m128 c1 = _mm_loadu_ps(matrix.data() + 4);
+            __m128 c2 = _mm_loadu_ps(matrix.data() + 8);
+            __m128 c3 = _mm_loadu_ps(matrix.data() + 12);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+            for (std::size_t i = 0; i < count; i++) {
+                const float *p = in[i].data();
+                __m128 acc = _mm_setzero_ps();
+                acc = _mm_add_ps(acc, _mm_mul_ps(c0, _mm_set1_ps(p[0])));
+                acc = _mm_add_ps(acc, _mm_mul_ps(c1, _mm_set1_ps(p[1])));
+                acc = _mm_add_ps(acc, _mm_mul_ps(c2, _mm_set1_ps(p[2])));
+                acc = _mm_add_ps(acc, _mm_mul_ps(c3, _mm_set1_ps(p[3])));
+                _mm_storeu_ps(out[i].data(), acc);
+            }
+        }
+#endif
+
+        template<int dim, typename vtype>
+            void transformGeneric(const Matrix<dim, dim, vtype> &matrix, const Vector<dim, vtype> *in, Vector<dim, vtype> *out, std::size_t count)
+            {
+                vtype m[dim][dim];
+                for (int row = 0; row < dim; row++)
+                    for (int col = 0; col < dim; col++)
+                        m[row][col] = matrix[row][col];
+
+                for (std::size_t i = 0; i < count; i++) {
+                    vtype v[dim];
+                    for (int n = 0; n < dim; n++)
+                        v[n] = in[i][n];
+
+                    for (int row = 0; row < dim; row++) {
+                        vtype sum = 0;
+                        for (int col = 0; col < dim; col++)
+                            sum += m[row][col] * v[col];
+                        out[i][row] = sum;
+                    }
+                }
+            }
+
+        // batches below this size are transformed on the calling thread only
+        constexpr std::size_t batchParallelThreshold = 1 << 15;
+
+        // split a batch across the global thread pool, kernel(in, out, count) transforms one chunk
+        template<typename In, typename Out, typename Kernel>
+            void forEachChunk(const In *in, Out *out, std::size_t count, Kernel kernel)
+            {
+                MATHLIB_TIME(BatchTransform, count);
+                if (count < batchParallelThreshold || ThreadPool::global().size() == 1) {
+                    kernel(in, out, count);
+                    return;
+                }
+
+                ThreadPool::global().parallelFor(0, count, batchParallelThreshold / 4, [&](std::size_t first, std::size_t last) {
+                    kernel(in + first, out + first, last - first);
+                });
+            }
+    }
+
+    // out[i] = matrix * in[i] for full homogeneous vectors
+    // results are identical to calling Matrix::operator* on every element
+    template<int dim, typename vtype>
+        void transform(const Matrix<dim, dim, vtype> &matrix, const Vector<dim, vtype> *in, Vector<dim, vtype> *out, std::size_t count)
+        {
+            detail::forEachChunk(in, out, count, [&matrix](const Vector<dim, vtype> *first, Vector<dim, vtype> *dest, std::size_t n) {
+#if defined(MATHLIB_SSE2)
+                if constexpr (dim == 4 && std::is_same_v<vtype, float>) {
+                    detail::transformSse(matrix, first, dest, n);
+                    return;
+                }
+#endif
+                detail::transformGeneric<dim, vtype>(matrix, first, dest, n);
+            });
+        }
+
+    // transform points (implicit w = 1), e.g. by a matrix built from createTranslation/createRotation/createScale
+    template<int dim, typename vtype>
+        void transformPoints(const Matrix<dim + 1, dim + 1, vtype> &matrix, const Vector<dim, vtype> *in, Vector<dim, vtype> *out, std::size_t count)
+        {
+            detail::forEachChunk(in, out, count, [&matrix](const Vector<dim, vtype> *first, Vector<dim, vtype> *dest, std::size_t n) {
+#if defined(MATHLIB_SSE2)
+                if constexpr (dim == 3 && std::is_same_v<vtype, float>) {
+                    detail::transformAffineSse(matrix, first, dest, n, 1.f, false);
+                    return;
+                }
+#endif
+                detail::transformAffineGeneric<dim, vtype, 1, false>(matrix, first, dest, n);
+            });
+        }
+
+    // transform directions (implicit w = 0), translation has no effect
+    template<int dim, typename vtype>
+        void transformDirections(const Matrix<dim + 1, dim + 1, vtype> &matrix, const Vector<dim, vtype> *in, Vector<dim, vtype> *out, std::size_t count)
+        {
+            detail::forEachChunk(in, out, count, [&matrix](const Vector<dim, vtype> *first, Vector<dim, vtype> *dest, std::size_t n) {
+#if defined(MATHLIB_SSE2)
+                if constexpr (dim == 3 && std::is_same_v<vtype, float>) {
+                    detail::transformAffineSse(matrix, first, dest, n, 0.f, false);
+                    return;
+                }
+#endif
+                detail::transformAffineGeneric<dim, vtype, 0, false>(matrix, first, dest, n);
+            });
+        }
+
+    // transform points (implicit w = 1) and divide by the resulting w,
+    // e.g. by a matrix built from createPerspectiveProjection
+    // points with a resulting w of zero produce inf/nan
+    template<int dim, typename vtype>
+        void projectPoints(const Matrix<dim + 1, dim + 1, vtype> &matrix, const Vector<dim, vtype> *in, Vector<dim, vtype> *out, std::size_t count)
+        {
+            detail::forEachChunk(in, out, count, [&matrix](const Vector<dim, vtype> *first, Vector<dim, vtype> *dest, std::size_t n) {
+#if defined(MATHLIB_SSE2)
+                if constexpr (dim == 3 && std::is_same_v<vtype, float>) {
+                    detail::transformAffineSse(matrix, first, dest, n, 1.f, true);
+                    return;
+                }
+#endif
+                detail::transformAffineGeneric<dim, vtype, 1, true>(matrix, first, dest, n);
+            });
+        }
+}
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "DenseMatrix.h"
+#include "DenseVector.h"
+
+namespace mathlib {
+    // binary container for arrays of Vector/Matrix and for DenseVector/DenseMatrix
+    //
+    // layout, everything in native byte order:
+    //   header (64 bytes): magic "MATHLIB\0", version, endian tag, entry count, offset of the entry table
+    //   payloads: the raw element storage of every array, each starting at a multiple of 64 bytes
+    //   entry table: one 128-byte record per array (name, scalar type, shape, offset, size)
+    // the table is written last so that arrays can be streamed out one by one
+    //
+    // BinaryReader maps the file and hands out views into the mapping, nothing is copied or parsed;
+    // the payload alignment keeps every view valid for aligned sse/avx loads
+
+    enum class ScalarType : std::uint32_t {
+        Float32 = 1,
+        Float64 = 2,
+        Int32 = 3
+    };
+
+    enum class ArrayKind : std::uint32_t {
+        // count fixed-size Vector<elementRows, T>
+        Vectors = 1,
+        // count fixed-size Matrix<elementRows, elementCols, T>
+        Matrices = 2,
+        // one DenseVector of count elements
+        DenseVector = 3,
+        // one rows x cols DenseMatrix in the stored order
+        DenseMatrix = 4
+    };
+
+    // description of one stored array as kept in the entry table
+    struct BinaryEntry {
+        static constexpr std::size_t maxNameLength = 63;
+
+        std::string name;
+        ArrayKind kind;
+        ScalarType scalar;
+        int elementRows;
+        int elementCols;
+        int rows;
+        int cols;
+        StorageOrder order;
+        std::uint64_t count;
+        std::uint64_t offset;
+        std::uint64_t bytes;
+    };
+
+    // non-owning view of count contiguous elements, e.g. inside a BinaryReader mapping
+    template<typename T>
+        class ArrayView {
+            private:
+                T *_data = nullptr;
+                std::size_t _size = 0;
+
+            public:
+                constexpr ArrayView() = default;
+
+                constexpr ArrayView(T *data, std::size_t size)
+                    : _data(data), _size(size) {}
+
+                constexpr T *data() const { return _data; }
+                constexpr std::size_t size() const { return _size; }
+                constexpr bool empty() const { return _size == 0; }
+
+                constexpr T &operator[](std::size_t i) const { return _data[i]; }
+
+                constexpr T *begin() const { return _data; }
+                constexpr T *end() const { return _data + _size; }
+        };
+
+    // non-owning view of a stored DenseMatrix, indexed like DenseMatrix
+    template<typename vtype>
+        class DenseMatrixView {
+            private:
+                const vtype *_data = nullptr;
+                int _rows = 0;
+                int _cols = 0;
+                StorageOrder _order = StorageOrder::RowMajor;
+
+            public:
+                DenseMatrixView() = default;
+
+                DenseMatrixView(const vtype *data, int rows, int cols, StorageOrder order)
+                    : _data(data), _rows(rows), _cols(cols), _order(order) {}
+
+                int rows() const { return _rows; }
+                int cols() const { return _cols; }
+                StorageOrder order() const { return _order; }
+                bool empty() const { return _data == nullptr; }
+
+                std::ptrdiff_t rowStride() const { return _order == StorageOrder::RowMajor ? _cols : 1; }
+                std::ptrdiff_t colStride() const { return _order == StorageOrder::RowMajor ? 1 : _rows; }
+
+                const vtype *data() const { return _data; }
+
+                const vtype &operator()(int row, int col) const
+                {
+                    return _data[row * rowStride() + col * colStride()];
+                }
+
+                // owning copy, e.g. to modify the data or to keep it beyond the lifetime of the reader
+                DenseMatrix<vtype> toDenseMatrix() const
+                {
+                    DenseMatrix<vtype> result(_rows, _cols, _order);
+                    std::copy(_data, _data + static_cast<std::size_t>(_rows) * _cols, result.data());
+                    return result;
+                }
+        };
+
+    namespace detail {
+        template<typename T>
+            constexpr ScalarType scalarTypeOf()
+            {
+                static_assert(std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, std::int32_t>,
+                        "only float, double and int32 arrays can be stored");
+                if constexpr (std::is_same_v<T, float>)
+                    return ScalarType::Float32;
+                else if constexpr (std::is_same_v<T, double>)
+                    return ScalarType::Float64;
+                else
+                    return ScalarType::Int32;
+            }
+
+        // elements are written and mapped as raw bytes
+        template<typename Element, typename T, int values>
+            constexpr bool isPacked()
+            {
+                return std::is_trivially_copyable_v<Element> && sizeof(Element) == sizeof(T) * values;
+            }
+    }
+
+    // writes a container file array by array; every write returns false once an i/o error occurred,
+    // and close() must succeed for the file to be readable
+    class BinaryWriter {
+        private:
+            std::FILE *_file = nullptr;
+            std::vector<BinaryEntry> _entries;
+            std::uint64_t _position = 0;
+            bool _failed = false;
+
+            bool writeArray(BinaryEntry entry, const void *data);
+
+        public:
+            BinaryWriter() = default;
+            explicit BinaryWriter(const std::string &path);
+            ~BinaryWriter();
+
+            BinaryWriter(const BinaryWriter &other) = delete;
+            BinaryWriter &operator=(const BinaryWriter &other) = delete;
+
+            // create or truncate path, returns false if it cannot be opened
+            bool open(const std::string &path);
+
+            // write the entry table and the header, returns false if any write failed
+            bool close();
+
+            bool isOpen() const { return _file != nullptr; }
+
+            // names must be unique and at most BinaryEntry::maxNameLength bytes long
+            template<int dim, typename vtype>
+                bool write(const std::string &name, const Vector<dim, vtype> *data, std::size_t count)
+                {
+                    static_assert(detail::isPacked<Vector<dim, vtype>, vtype, dim>(), "vector type is not tightly packed");
+                    return writeArray(BinaryEntry {name, ArrayKind::Vectors, detail::scalarTypeOf<vtype>(), dim, 1, 0, 0,
+                            StorageOrder::RowMajor, count, 0, count * sizeof(Vector<dim, vtype>)}, data);
+                }
+
+            template<int rows, int cols, typename vtype>
+                bool write(const std::string &name, const Matrix<rows, cols, vtype> *data, std::size_t count)
+                {
+                    static_assert(detail::isPacked<Matrix<rows, cols, vtype>, vtype, rows * cols>(), "matrix type is not tightly packed");
+                    return writeArray(BinaryEntry {name, ArrayKind::Matrices, detail::scalarTypeOf<vtype>(), rows, cols, 0, 0,
+                            StorageOrder::RowMajor, count, 0, count * sizeof(Matrix<rows, cols, vtype>)}, data);
+                }
+
+            template<typename vtype>
+                bool write(const std::string &name, const DenseVector<vtype> &vector)
+                {
+                    const std::uint64_t count = static_cast<std::uint64_t>(vector.size());
+                    return writeArray(BinaryEntry {name, ArrayKind::DenseVector, detail::scalarTypeOf<vtype>(), 1, 1, vector.size(), 1,
+                            StorageOrder::RowMajor, count, 0, count * sizeof(vtype)}, vector.data());
+                }
+
+            template<typename vtype>
+                bool write(const std::string &name, const DenseMatrix<vtype> &matrix)
+                {
+                    const std::uint64_t count = static_cast<std::uint64_t>(matrix.rows()) * matrix.cols();
+                    return writeArray(BinaryEntry {name, ArrayKind::DenseMatrix, detail::scalarTypeOf<vtype>(), 1, 1, matrix.rows(), matrix.cols(),
+                            matrix.order(), count, 0, count * sizeof(vtype)}, matrix.data());
+                }
+    };
+
+    // read-only memory mapping of a container file; the views stay valid until close() or destruction
+    // lookups with a missing name or a mismatching type return an empty view
+    class BinaryReader {
+        private:
+            const unsigned char *_mapping = nullptr;
+            std::size_t _mappingSize = 0;
+            // false where the file had to be read into heap memory instead of being mapped
+            bool _mapped = false;
+            std::vector<BinaryEntry> _entries;
+
+            const void *payload(const std::string &name, ArrayKind kind, ScalarType scalar, int elementRows, int elementCols,
+                    const BinaryEntry **entry = nullptr) const;
+
+        public:
+            BinaryReader() = default;
+            explicit BinaryReader(const std::string &path);
+            ~BinaryReader();
+
+            BinaryReader(const BinaryReader &other) = delete;
+            BinaryReader &operator=(const BinaryReader &other) = delete;
+
+            // map path and validate header and entry table, returns false for missing, truncated,
+            // foreign-endian or newer-version files
+            bool open(const std::string &path);
+            void close();
+
+            bool isOpen() const { return _mapping != nullptr; }
+
+            const std::vector<BinaryEntry> &entries() const { return _entries; }
+
+            // nullptr if there is no array of this name
+            const BinaryEntry *find(const std::string &name) const;
+
+            template<int dim, typename vtype>
+                ArrayView<const Vector<dim, vtype>> getVectors(const std::string &name) const
+                {
+                    static_assert(detail::isPacked<Vector<dim, vtype>, vtype, dim>(), "vector type is not tightly packed");
+                    const BinaryEntry *entry = nullptr;
+                    const void *data = payload(name, ArrayKind::Vectors, detail::scalarTypeOf<vtype>(), dim, 1, &entry);
+                    if (data == nullptr)
+                        return {};
+                    return {static_cast<const Vector<dim, vtype>*>(data), static_cast<std::size_t>(entry->count)};
+                }
+
+            template<int rows, int cols, typename vtype>
+                ArrayView<const Matrix<rows, cols, vtype>> getMatrices(const std::string &name) const
+                {
+                    static_assert(detail::isPacked<Matrix<rows, cols, vtype>, vtype, rows * cols>(), "matrix type is not tightly packed");
+                    const BinaryEntry *entry = nullptr;
+                    const void *data = payload(name, ArrayKind::Matrices, detail::scalarTypeOf<vtype>(), rows, cols, &entry);
+                    if (data == nullptr)
+                        return {};
+                    return {static_cast<const Matrix<rows, cols, vtype>*>(data), static_cast<std::size_t>(entry->count)};
+                }
+
+            template<typename vtype>
+                ArrayView<const vtype> getDenseVector(const std::string &name) const
+                {
+                    const BinaryEntry *entry = nullptr;
+                    const void *data = payload(name, ArrayKind::DenseVector, detail::scalarTypeOf<vtype>(), 1, 1, &entry);
+                    if (data == nullptr)
+                        return {};
+                    return {static_cast<const vtype*>(data), static_cast<std::size_t>(entry->count)};
+                }
+
+            template<typename vtype>
+                DenseMatrixView<vtype> getDenseMatrix(const std::string &name) const
+                {
+                    const BinaryEntry *entry = nullptr;
+                    const void *data = payload(name, ArrayKind::DenseMatrix, detail::scalarTypeOf<vtype>(), 1, 1, &entry);
+                    if (data == nullptr)
+                        return {};
+                    return {static_cast<const vtype*>(data), entry->rows, entry->cols, entry->order};
+                }
+    };
+}
@@ -1,6 +1,15 @@
 #pragma once
 
+#include "Constants.h"
+
 namespace mathlib {
-    double toRadians(double degrees);
-    double toDegrees(double radians);
+    constexpr double toRadians(double degrees)
+    {
+        return degrees * PI / 180.0;
+    }
+
+    constexpr double toDegrees(double radians)
+    {
+        return radians * 180.0 / PI;
+    }
 }
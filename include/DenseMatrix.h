@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+
+#include "Gemm.h"
+#include "Matrix.h"
+#include "Memory.h"
+#include "DenseVector.h"
+
+namespace mathlib {
+    enum class StorageOrder {
+        RowMajor,
+        ColumnMajor
+    };
+
+    // runtime-sized matrix with contiguous, 64-byte aligned heap storage
+    // meant for systems too large for the fixed-size Matrix, multiplication uses the blocked gemm kernel
+    template<typename vtype = float>
+        class DenseMatrix {
+            private:
+                AlignedBuffer<vtype> _val;
+                int _rows = 0;
+                int _cols = 0;
+                StorageOrder _order = StorageOrder::RowMajor;
+
+                using ThisType = DenseMatrix<vtype>;
+
+            public:
+                // default constructor that creates an empty matrix
+                DenseMatrix() = default;
+
+                // constructor that creates a zero-initialized rows x cols matrix
+                DenseMatrix(int rows, int cols, StorageOrder order = StorageOrder::RowMajor)
+                    : _val(static_cast<std::size_t>(rows) * cols), _rows {rows}, _cols {cols}, _order {order} {}
+
+                // copy constructor that converts from a fixed-size matrix
+                template<int rows, int cols, typename T>
+                    DenseMatrix(const Matrix<rows, cols, T> &other, StorageOrder order = StorageOrder::RowMajor)
+                    : DenseMatrix(rows, cols, order)
+                    {
+                        for (int row = 0; row < rows; row++)
+                            for (int col = 0; col < cols; col++)
+                                (*this)(row, col) = static_cast<vtype>(other[row][col]);
+                    }
+
+                static ThisType makeIdentity(int size, StorageOrder order = StorageOrder::RowMajor)
+                {
+                    ThisType result(size, size, order);
+                    for (int i = 0; i < size; i++)
+                        result(i, i) = 1;
+                    return result;
+                }
+
+                int rows() const { return _rows; }
+                int cols() const { return _cols; }
+                StorageOrder order() const { return _order; }
+
+                // distance between two consecutive elements of a column resp. a row
+                std::ptrdiff_t rowStride() const { return _order == StorageOrder::RowMajor ? _cols : 1; }
+                std::ptrdiff_t colStride() const { return _order == StorageOrder::RowMajor ? 1 : _rows; }
+
+                const vtype *data() const { return _val.data(); }
+                vtype *data() { return _val.data(); }
+
+                const vtype &operator()(int row, int col) const
+                {
+                    return _val[row * rowStride() + col * colStride()];
+                }
+
+                vtype &operator()(int row, int col)
+                {
+                    return _val[row * rowStride() + col * colStride()];
+                }
+
+                // resize to rows x cols, the contents are zeroed
+                void resize(int rows, int cols)
+                {
+                    _val.assign(static_cast<std::size_t>(rows) * cols, vtype(0));
+                    _rows = rows;
+                    _cols = cols;
+                }
+
+                void fill(vtype value)
+                {
+                    std::fill(_val.begin(), _val.end(), value);
+                }
+
+                // copy of this matrix stored in the given order
+                ThisType toOrder(StorageOrder order) const
+                {
+                    ThisType result(_rows, _cols, order);
+                    copyStrided(_rows, _cols, data(), rowStride(), colStride(), result.data(), result.rowStride(), result.colStride());
+                    return result;
+                }
+
+                // cols x rows transpose in the same storage order, copied with the cache-oblivious copyStrided
+                ThisType getTransposed() const
+                {
+                    ThisType result(_cols, _rows, _order);
+                    copyStrided(_rows, _cols, data(), rowStride(), colStride(), result.data(), result.colStride(), result.rowStride());
+                    return result;
+                }
+
+                // square matrices are transposed in place tile by tile, others through a transposed copy
+                ThisType &transpose()
+                {
+                    if (_rows == _cols)
+                        transposeSquare(_rows, data(), rowStride(), colStride());
+                    else
+                        *this = getTransposed();
+                    return *this;
+                }
+
+                // this^T * other without forming the transpose, gemm reads this with swapped strides
+                ThisType multiplyTransposed(const ThisType &other) const
+                {
+                    assert(_rows == other._rows);
+                    ThisType result(_cols, other._cols, _order);
+                    gemm(_cols, other._cols, _rows, vtype(1), data(), colStride(), rowStride(),
+                            other.data(), other.rowStride(), other.colStride(), vtype(0), result.data(), result.rowStride(), result.colStride());
+                    return result;
+                }
+
+                // this * other^T without forming the transpose
+                ThisType multiplyByTransposed(const ThisType &other) const
+                {
+                    assert(_cols == other._cols);
+                    ThisType result(_rows, other._rows, _order);
+                    gemm(_rows, other._rows, _cols, vtype(1), data(), rowStride(), colStride(),
+                            other.data(), other.colStride(), other.rowStride(), vtype(0), result.data(), result.rowStride(), result.colStride());
+                    return result;
+                }
+
+                // operations
+                ThisType operator+(const ThisType &other) const
+                {
+                    assert(_rows == other._rows && _cols == other._cols);
+                    ThisType result(_rows, _cols, _order);
+                    for (int row = 0; row < _rows; row++)
+                        for (int col = 0; col < _cols; col++)
+                            result(row, col) = (*this)(row, col) + other(row, col);
+                    return result;
+                }
+
+                ThisType operator-(const ThisType &other) const
+                {
+                    assert(_rows == other._rows && _cols == other._cols);
+                    ThisType result(_rows, _cols, _order);
+                    for (int row = 0; row < _rows; row++)
+                        for (int col = 0; col < _cols; col++)
+                            result(row, col) = (*this)(row, col) - other(row, col);
+                    return result;
+                }
+
+                // the result is stored in the order of this matrix
+                ThisType operator*(const ThisType &other) const
+                {
+                    ThisType result(_rows, other._cols, _order);
+                    gemm(vtype(1), *this, other, vtype(0), result);
+                    return result;
+                }
+
+                DenseVector<vtype> operator*(const DenseVector<vtype> &v) const
+                {
+                    DenseVector<vtype> result(_rows);
+                    gemv(vtype(1), *this, v, vtype(0), result);
+                    return result;
+                }
+
+                bool operator==(const ThisType &other) const
+                {
+                    if (_rows != other._rows || _cols != other._cols)
+                        return false;
+
+                    for (int row = 0; row < _rows; row++)
+                        for (int col = 0; col < _cols; col++)
+                            if ((*this)(row, col) != other(row, col))
+                                return false;
+                    return true;
+                }
+
+                bool operator!=(const ThisType &other) const
+                {
+                    return !(this->operator==(other));
+                }
+        };
+
+    // c = alpha * a * b + beta * c, any combination of storage orders is allowed
+    // c must already have the size a.rows() x b.cols() and must not alias a or b
+    template<typename vtype>
+        void gemm(vtype alpha, const DenseMatrix<vtype> &a, const DenseMatrix<vtype> &b, vtype beta, DenseMatrix<vtype> &c)
+        {
+            assert(a.cols() == b.rows() && c.rows() == a.rows() && c.cols() == b.cols());
+            gemm(a.rows(), b.cols(), a.cols(),
+                    alpha, a.data(), a.rowStride(), a.colStride(),
+                    b.data(), b.rowStride(), b.colStride(),
+                    beta, c.data(), c.rowStride(), c.colStride());
+        }
+
+    // c = a * b for square matrices by strassen-winograd recursion down to cutoff, see strassen in Gemm.h
+    // c must already have the size of a and must not alias a or b
+    template<typename vtype>
+        void strassen(const DenseMatrix<vtype> &a, const DenseMatrix<vtype> &b, DenseMatrix<vtype> &c, int cutoff = strassenCutoff)
+        {
+            assert(a.rows() == a.cols() && b.rows() == a.rows() && b.cols() == a.cols() && c.rows() == a.rows() && c.cols() == a.cols());
+            strassen(a.rows(), a.data(), a.rowStride(), a.colStride(), b.data(), b.rowStride(), b.colStride(),
+                    c.data(), c.rowStride(), c.colStride(), cutoff);
+        }
+
+    // y = alpha * a * x + beta * y, y must already have the size a.rows() and must not alias x
+    template<typename vtype>
+        void gemv(vtype alpha, const DenseMatrix<vtype> &a, const DenseVector<vtype> &x, vtype beta, DenseVector<vtype> &y)
+        {
+            assert(a.cols() == x.size() && y.size() == a.rows());
+            gemv(a.rows(), a.cols(), alpha, a.data(), a.rowStride(), a.colStride(), x.data(), beta, y.data());
+        }
+
+    using DenseMatrixf = DenseMatrix<float>;
+    using DenseMatrixd = DenseMatrix<double>;
+}
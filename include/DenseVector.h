@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cmath>
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+
+#include "Memory.h"
+#include "Vector.h"
+
+namespace mathlib {
+    // runtime-sized vector with contiguous, 64-byte aligned heap storage
+    // counterpart of DenseMatrix for matrix-vector products and linear solves
+    template<typename vtype = float>
+        class DenseVector {
+            private:
+                AlignedBuffer<vtype> _val;
+
+                using ThisType = DenseVector<vtype>;
+
+            public:
+                // default constructor that creates an empty vector
+                DenseVector() = default;
+
+                // constructor that creates a zero-initialized vector of the given size
+                explicit DenseVector(int size)
+                    : _val(size) {}
+
+                // copy constructor that converts from a fixed-size vector
+                template<int dim, typename T>
+                    DenseVector(const Vector<dim, T> &other)
+                    : _val(dim)
+                    {
+                        for (int n = 0; n < dim; n++)
+                            _val[n] = static_cast<vtype>(other[n]);
+                    }
+
+                int size() const { return static_cast<int>(_val.size()); }
+
+                const vtype *data() const { return _val.data(); }
+                vtype *data() { return _val.data(); }
+
+                const vtype &operator[](int i) const { return _val[i]; }
+                vtype &operator[](int i) { return _val[i]; }
+
+                // resize to size elements, the contents are zeroed
+                void resize(int size)
+                {
+                    _val.assign(size, vtype(0));
+                }
+
+                void fill(vtype value)
+                {
+                    std::fill(_val.begin(), _val.end(), value);
+                }
+
+                // element-wise operations
+                ThisType operator+(const ThisType &other) const
+                {
+                    ThisType result(*this);
+                    return result += other;
+                }
+
+                ThisType operator-(const ThisType &other) const
+                {
+                    ThisType result(*this);
+                    return result -= other;
+                }
+
+                ThisType &operator+=(const ThisType &other)
+                {
+                    assert(size() == other.size());
+                    for (int n = 0; n < size(); n++)
+                        _val[n] += other._val[n];
+                    return *this;
+                }
+
+                ThisType &operator-=(const ThisType &other)
+                {
+                    assert(size() == other.size());
+                    for (int n = 0; n < size(); n++)
+                        _val[n] -= other._val[n];
+                    return *this;
+                }
+
+                // scalar operations
+                ThisType operator*(vtype scale) const
+                {
+                    ThisType result(*this);
+                    return result *= scale;
+                }
+
+                ThisType &operator*=(vtype scale)
+                {
+                    for (int n = 0; n < size(); n++)
+                        _val[n] *= scale;
+                    return *this;
+                }
+
+                bool operator==(const ThisType &other) const
+                {
+                    return _val == other._val;
+                }
+
+                bool operator!=(const ThisType &other) const
+                {
+                    return !(this->operator==(other));
+                }
+
+                vtype dot(const ThisType &other) const
+                {
+                    assert(size() == other.size());
+                    vtype sum = 0;
+                    for (int n = 0; n < size(); n++)
+                        sum += _val[n] * other._val[n];
+                    return sum;
+                }
+
+                vtype getLengthSquared() const
+                {
+                    return dot(*this);
+                }
+
+                vtype getLength() const
+                {
+                    return std::sqrt(getLengthSquared());
+                }
+        };
+
+    using DenseVectorf = DenseVector<float>;
+    using DenseVectord = DenseVector<double>;
+}
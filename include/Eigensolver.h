@@ -0,0 +1,756 @@
+#pragma once
+
+#include <cmath>
+#include <atomic>
+#include <limits>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+
+#include "Gemm.h"
+#include "Matrix.h"
+#include "Vector.h"
+#include "ThreadPool.h"
+#include "DenseMatrix.h"
+#include "DenseVector.h"
+#include "Instrumentation.h"
+
+namespace mathlib {
+    // spectral decompositions: eigenvalues and eigenvectors of symmetric matrices and the singular value
+    // decomposition of general ones; eigenvalues come in ascending, singular values in descending order and
+    // the vectors are the columns of the returned matrices, so that a = vectors * diag(values) * vectors^T
+
+    namespace detail {
+        // columns per panel of the tridiagonal reduction and reflectors per block of its back-transformation
+        constexpr int tridiagonalBlock = 32;
+        // rows of the eigenvector matrix that are rotated together, small enough to stay in the l1 cache
+        constexpr int rotationBlock = 256;
+        // rotation sweeps and jacobi rounds touching fewer elements than this run on the calling thread only
+        constexpr std::size_t spectralParallelThreshold = 1 << 15;
+
+        template<typename T>
+            void cross3(const T *a, const T *b, T *out)
+            {
+                out[0] = a[1] * b[2] - a[2] * b[1];
+                out[1] = a[2] * b[0] - a[0] * b[2];
+                out[2] = a[0] * b[1] - a[1] * b[0];
+            }
+
+        template<typename T>
+            T dot3(const T *a, const T *b)
+            {
+                return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+            }
+
+        // unit eigenvector of the symmetric a for the eigenvalue with the largest gap to the other two:
+        // the rows of a - value * I span a plane, the longest cross product of two rows is its normal
+        template<typename T>
+            void separatedEigenvector3(const T (&a)[3][3], T value, T *out)
+            {
+                T rows[3][3];
+                for (int i = 0; i < 3; i++)
+                    for (int j = 0; j < 3; j++)
+                        rows[i][j] = (i == j) ? a[i][j] - value : a[i][j];
+
+                T candidates[3][3];
+                cross3(rows[0], rows[1], candidates[0]);
+                cross3(rows[0], rows[2], candidates[1]);
+                cross3(rows[1], rows[2], candidates[2]);
+
+                int best = 0;
+                T bestLength = dot3(candidates[0], candidates[0]);
+                for (int i = 1; i < 3; i++) {
+                    const T length = dot3(candidates[i], candidates[i]);
+                    if (length > bestLength) {
+                        best = i;
+                        bestLength = length;
+                    }
+                }
+
+                const T inv = T(1) / std::sqrt(bestLength);
+                for (int j = 0; j < 3; j++)
+                    out[j] = candidates[best][j] * inv;
+            }
+
+        // the two eigenpairs of the symmetric a orthogonal to its eigenvector first: the restriction of a to the
+        // plane orthogonal to first is a symmetric 2x2 matrix, diagonalized by one jacobi rotation; this stays
+        // accurate for (nearly) repeated eigenvalues, where the closed-form eigenvalues lose half their digits
+        template<typename T>
+            void complementEigen3(const T (&a)[3][3], const T *first, T *values, T *second, T *third)
+            {
+                T u[3], v[3];
+                if (std::abs(first[0]) > std::abs(first[1])) {
+                    const T inv = T(1) / std::sqrt(first[0] * first[0] + first[2] * first[2]);
+                    u[0] = -first[2] * inv;
+                    u[1] = 0;
+                    u[2] = first[0] * inv;
+                } else {
+                    const T inv = T(1) / std::sqrt(first[1] * first[1] + first[2] * first[2]);
+                    u[0] = 0;
+                    u[1] = first[2] * inv;
+                    u[2] = -first[1] * inv;
+                }
+                cross3(first, u, v);
+
+                T au[3], av[3];
+                for (int i = 0; i < 3; i++) {
+                    au[i] = a[i][0] * u[0] + a[i][1] * u[1] + a[i][2] * u[2];
+                    av[i] = a[i][0] * v[0] + a[i][1] * v[1] + a[i][2] * v[2];
+                }
+                const T m00 = dot3(u, au), m01 = dot3(u, av), m11 = dot3(v, av);
+
+                // [c s; -s c] diagonalizes [m00 m01; m01 m11] to diag(m00 - t * m01, m11 + t * m01)
+                T c = 1, s = 0, t = 0;
+                if (m01 != T(0)) {
+                    const T zeta = (m11 - m00) / (2 * m01);
+                    t = std::copysign(T(1), zeta) / (std::abs(zeta) + std::sqrt(T(1) + zeta * zeta));
+                    c = T(1) / std::sqrt(T(1) + t * t);
+                    s = c * t;
+                }
+                T low = m00 - t * m01, high = m11 + t * m01;
+                T lowVector[3], highVector[3];
+                for (int j = 0; j < 3; j++) {
+                    lowVector[j] = c * u[j] - s * v[j];
+                    highVector[j] = s * u[j] + c * v[j];
+                }
+                if (high < low) {
+                    std::swap(low, high);
+                    std::swap(lowVector, highVector);
+                }
+                values[0] = low;
+                values[1] = high;
+                for (int j = 0; j < 3; j++) {
+                    second[j] = lowVector[j];
+                    third[j] = highVector[j];
+                }
+            }
+
+        // closed-form eigenvalues of the symmetric a, ascending, from the trigonometric solution of the
+        // characteristic polynomial of (a - q * I) / p; a is scaled to a largest element of 1 beforehand
+        // returns false for a diagonal matrix, whose eigenvalues are then the unsorted diagonal
+        template<typename T>
+            bool eigenvalues3(T (&a)[3][3], T &scale, T *values, T &halfDeterminant)
+            {
+                scale = 0;
+                for (int i = 0; i < 3; i++)
+                    for (int j = i; j < 3; j++)
+                        scale = std::max(scale, std::abs(a[i][j]));
+                if (scale == T(0)) {
+                    values[0] = values[1] = values[2] = 0;
+                    return false;
+                }
+
+                const T inv = T(1) / scale;
+                for (int i = 0; i < 3; i++)
+                    for (int j = 0; j < 3; j++)
+                        a[i][j] *= inv;
+
+                const T offDiagonal = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+                if (offDiagonal == T(0)) {
+                    for (int i = 0; i < 3; i++)
+                        values[i] = a[i][i] * scale;
+                    return false;
+                }
+
+                const T q = (a[0][0] + a[1][1] + a[2][2]) / T(3);
+                const T b00 = a[0][0] - q, b11 = a[1][1] - q, b22 = a[2][2] - q;
+                const T p = std::sqrt((b00 * b00 + b11 * b11 + b22 * b22 + T(2) * offDiagonal) / T(6));
+                const T c00 = b11 * b22 - a[1][2] * a[1][2];
+                const T c01 = a[0][1] * b22 - a[1][2] * a[0][2];
+                const T c02 = a[0][1] * a[1][2] - b11 * a[0][2];
+                const T determinant = (b00 * c00 - a[0][1] * c01 + a[0][2] * c02) / (p * p * p);
+                halfDeterminant = std::clamp(determinant * T(0.5), T(-1), T(1));
+
+                // the roots of x^3 - 3x - det = 0 are 2 cos(angle + 2k pi / 3); angle is in [0, pi / 3],
+                // so 2 cos(angle + 2 pi / 3) = -cos(angle) - sqrt(3) sin(angle) with a non-negative sine
+                const T cosine = std::cos(std::acos(halfDeterminant) / T(3));
+                const T sine = std::sqrt(std::max(T(1) - cosine * cosine, T(0)));
+                const T beta2 = cosine * T(2);
+                const T beta0 = -cosine - T(1.73205080756887729) * sine;
+                const T beta1 = -(beta0 + beta2);
+                values[0] = (q + p * beta0) * scale;
+                values[1] = (q + p * beta1) * scale;
+                values[2] = (q + p * beta2) * scale;
+                return true;
+            }
+
+        // sort the eigenvalues of a diagonal matrix ascending, the eigenvectors are the permuted unit vectors
+        template<typename T>
+            void sortDiagonal3(T *values, T (*vectors)[3])
+            {
+                int order[3] = {0, 1, 2};
+                std::sort(order, order + 3, [&](int x, int y) { return values[x] < values[y]; });
+                const T sorted[3] = {values[order[0]], values[order[1]], values[order[2]]};
+                for (int k = 0; k < 3; k++) {
+                    values[k] = sorted[k];
+                    if (vectors)
+                        for (int i = 0; i < 3; i++)
+                            vectors[i][k] = (i == order[k]) ? T(1) : T(0);
+                }
+            }
+
+        // eigenvalues of the symmetric input, ascending, and optionally the eigenvectors as columns of vectors
+        // (after Eberly, "A Robust Eigensolver for 3 x 3 Symmetric Matrices"): closed-form eigenvalues, the
+        // eigenvector of the best separated one from cross products and the other two pairs from the 2x2 problem
+        // in the plane orthogonal to it, so the vectors are orthonormal by construction
+        template<typename T>
+            void symmetricEigen3(const T (&input)[3][3], T *values, T (*vectors)[3])
+            {
+                T a[3][3];
+                for (int i = 0; i < 3; i++)
+                    for (int j = 0; j < 3; j++)
+                        a[i][j] = input[std::max(i, j)][std::min(i, j)];
+
+                T scale, halfDeterminant = 0;
+                if (!eigenvalues3(a, scale, values, halfDeterminant)) {
+                    sortDiagonal3(values, vectors);
+                    return;
+                }
+                if (!vectors)
+                    return;
+
+                // a is scaled here, its largest eigenvalue is separated if the determinant is positive
+                T columns[3][3], pair[2];
+                if (halfDeterminant >= 0) {
+                    separatedEigenvector3(a, values[2] / scale, columns[2]);
+                    complementEigen3(a, columns[2], pair, columns[0], columns[1]);
+                    values[0] = std::min(pair[0], values[2] / scale) * scale;
+                    values[1] = std::min(pair[1], values[2] / scale) * scale;
+                } else {
+                    separatedEigenvector3(a, values[0] / scale, columns[0]);
+                    complementEigen3(a, columns[0], pair, columns[1], columns[2]);
+                    values[1] = std::max(pair[0], values[0] / scale) * scale;
+                    values[2] = std::max(pair[1], values[0] / scale) * scale;
+                }
+                for (int i = 0; i < 3; i++)
+                    for (int k = 0; k < 3; k++)
+                        vectors[i][k] = columns[k][i];
+            }
+
+        // householder reduction of the symmetric a (row-major, both triangles) to tridiagonal form
+        // q^T * a * q with diagonal d and subdiagonal e; the reflectors stay below the subdiagonal of a
+        // with their leading 1 stored on it. panels of tridiagonalBlock columns are reduced against the
+        // not yet updated trailing matrix (lapack latrd), which then gets the rank-2k update through gemm
+        template<typename vtype>
+            void tridiagonalize(DenseMatrix<vtype> &a, std::vector<vtype> &d, std::vector<vtype> &e, std::vector<vtype> &tau)
+            {
+                const int n = a.rows();
+                const std::ptrdiff_t lda = n;
+                vtype *data = a.data();
+                d.assign(n, vtype(0));
+                e.assign(n, vtype(0));
+                tau.assign(n, vtype(0));
+
+                DenseMatrix<vtype> w(n, tridiagonalBlock);
+                std::vector<vtype> v(n), y(n), wv(tridiagonalBlock), vv(tridiagonalBlock);
+                for (int k = 0; k < n - 1; k += tridiagonalBlock) {
+                    const int kb = std::min(tridiagonalBlock, n - 1 - k);
+                    for (int i = 0; i < kb; i++) {
+                        const int c = k + i;
+
+                        // column c -= v * w(c)^T + w * v(c)^T over the reflectors of this panel so far
+                        for (int r = c; r < n; r++) {
+                            vtype sum = 0;
+                            for (int j = 0; j < i; j++)
+                                sum += a(r, k + j) * w(c, j) + w(r, j) * a(c, k + j);
+                            a(r, c) -= sum;
+                        }
+                        d[c] = a(c, c);
+
+                        // reflector h = I - tau * v * v^T mapping a(c + 1:n, c) onto e[c] * e_1
+                        vtype tail = 0;
+                        for (int r = c + 2; r < n; r++)
+                            tail += a(r, c) * a(r, c);
+                        const vtype alpha = a(c + 1, c);
+                        if (tail == vtype(0)) {
+                            e[c] = alpha;
+                        } else {
+                            const vtype norm = std::sqrt(alpha * alpha + tail);
+                            const vtype beta = (alpha >= vtype(0)) ? -norm : norm;
+                            tau[c] = (beta - alpha) / beta;
+                            const vtype scale = vtype(1) / (alpha - beta);
+                            for (int r = c + 2; r < n; r++)
+                                a(r, c) *= scale;
+                            e[c] = beta;
+                        }
+                        a(c + 1, c) = 1;
+
+                        // w(c + 1:n, i) = tau * a22 * v with a22 corrected for this panel, plus the
+                        // multiple of v that makes a22 - v * w^T - w * v^T the transformed matrix
+                        const int len = n - c - 1;
+                        for (int r = 0; r < len; r++)
+                            v[r] = a(c + 1 + r, c);
+                        gemv(len, len, vtype(1), data + (c + 1) * lda + c + 1, lda, 1, v.data(), vtype(0), y.data());
+                        std::fill(wv.begin(), wv.begin() + i, vtype(0));
+                        std::fill(vv.begin(), vv.begin() + i, vtype(0));
+                        for (int r = 0; r < len; r++)
+                            for (int j = 0; j < i; j++) {
+                                wv[j] += w(c + 1 + r, j) * v[r];
+                                vv[j] += a(c + 1 + r, k + j) * v[r];
+                            }
+                        vtype dot = 0;
+                        for (int r = 0; r < len; r++) {
+                            vtype sum = y[r];
+                            for (int j = 0; j < i; j++)
+                                sum -= a(c + 1 + r, k + j) * wv[j] + w(c + 1 + r, j) * vv[j];
+                            y[r] = tau[c] * sum;
+                            dot += y[r] * v[r];
+                        }
+                        const vtype correction = vtype(-0.5) * tau[c] * dot;
+                        for (int r = 0; r < len; r++)
+                            w(c + 1 + r, i) = y[r] + correction * v[r];
+                    }
+
+                    // a22 -= v * w^T + w * v^T, both triangles so that the next panels can use gemv on a22
+                    const int s = k + kb;
+                    const int rest = n - s;
+                    gemm(rest, rest, kb, vtype(-1), data + s * lda + k, lda, 1, w.data() + s * tridiagonalBlock, 1, tridiagonalBlock,
+                            vtype(1), data + s * lda + s, lda, 1);
+                    gemm(rest, rest, kb, vtype(-1), w.data() + s * tridiagonalBlock, tridiagonalBlock, 1, data + s * lda + k, 1, lda,
+                            vtype(1), data + s * lda + s, lda, 1);
+                }
+                d[n - 1] = a(n - 1, n - 1);
+            }
+
+        // z = q * z for the reflectors left in a by tridiagonalize, z column-major n x n
+        // every block of reflectors is applied as I - v * t * v^T (compact wy form) with two gemm calls
+        template<typename vtype>
+            void applyReflectors(const DenseMatrix<vtype> &a, const std::vector<vtype> &tau, DenseMatrix<vtype> &z)
+            {
+                const int n = a.rows();
+                if (n < 2)
+                    return;
+
+                for (int k = (n - 2) / tridiagonalBlock * tridiagonalBlock; k >= 0; k -= tridiagonalBlock) {
+                    const int kb = std::min(tridiagonalBlock, n - 1 - k);
+                    const int m = n - k - 1;
+
+                    // reflector j acts on rows k + 1 + j and below, with unit first element
+                    DenseMatrix<vtype> v(m, kb);
+                    for (int j = 0; j < kb; j++) {
+                        v(j, j) = 1;
+                        for (int r = j + 1; r < m; r++)
+                            v(r, j) = a(k + 1 + r, k + j);
+                    }
+
+                    // upper triangular t of h(k) * ... * h(k + kb - 1) = I - v * t * v^T, from the gram matrix v^T * v
+                    DenseMatrix<vtype> gram(kb, kb), t(kb, kb);
+                    gemm(kb, kb, m, vtype(1), v.data(), 1, kb, v.data(), kb, 1, vtype(0), gram.data(), kb, 1);
+                    for (int j = 0; j < kb; j++) {
+                        t(j, j) = tau[k + j];
+                        for (int i = 0; i < j; i++) {
+                            vtype sum = 0;
+                            for (int l = i; l < j; l++)
+                                sum += t(i, l) * gram(l, j);
+                            t(i, j) = -tau[k + j] * sum;
+                        }
+                    }
+
+                    // z -= v * (t * (v^T * z))
+                    vtype *zk = z.data() + k + 1;
+                    DenseMatrix<vtype> w(kb, n);
+                    gemm(kb, n, m, vtype(1), v.data(), 1, kb, zk, 1, n, vtype(0), w.data(), n, 1);
+                    for (int col = 0; col < n; col++)
+                        for (int i = 0; i < kb; i++) {
+                            vtype sum = 0;
+                            for (int l = i; l < kb; l++)
+                                sum += t(i, l) * w(l, col);
+                            w(i, col) = sum;
+                        }
+                    gemm(m, n, kb, vtype(-1), v.data(), kb, 1, w.data(), n, 1, vtype(1), zk, 1, n);
+                }
+            }
+
+        // implicit ql iteration with wilkinson-like shifts on the tridiagonal (d, e) (jama tql2); the
+        // rotations of one sweep are recorded and then applied to the column-major z in row blocks, so a
+        // block of z stays in cache for the whole sweep and the blocks spread across ThreadPool::global()
+        template<typename vtype>
+            bool tridiagonalQL(std::vector<vtype> &d, std::vector<vtype> &e, DenseMatrix<vtype> *z)
+            {
+                constexpr int maxIterations = 30;
+                const int n = static_cast<int>(d.size());
+                const vtype eps = std::numeric_limits<vtype>::epsilon();
+                std::vector<vtype> cosines(n), sines(n);
+
+                auto rotate = [&](int l, int m) {
+                    vtype *data = z->data();
+                    auto rowsKernel = [&](std::size_t first, std::size_t last) {
+                        for (std::size_t block = first; block < last; block += rotationBlock) {
+                            const std::size_t blockEnd = std::min(last, block + rotationBlock);
+                            for (int i = m - 1; i >= l; i--) {
+                                const vtype c = cosines[i], s = sines[i];
+                                vtype *zi = data + static_cast<std::ptrdiff_t>(i) * n;
+                                vtype *zj = zi + n;
+                                for (std::size_t row = block; row < blockEnd; row++) {
+                                    const vtype h = zj[row];
+                                    zj[row] = s * zi[row] + c * h;
+                                    zi[row] = c * zi[row] - s * h;
+                                }
+                            }
+                        }
+                    };
+
+                    if (static_cast<std::size_t>(n) * (m - l) < spectralParallelThreshold || ThreadPool::global().size() == 1)
+                        rowsKernel(0, n);
+                    else
+                        ThreadPool::global().parallelFor(0, n, rotationBlock, rowsKernel);
+                };
+
+                vtype f = 0, tst1 = 0;
+                for (int l = 0; l < n; l++) {
+                    tst1 = std::max(tst1, std::abs(d[l]) + std::abs(e[l]));
+                    int m = l;
+                    while (m < n - 1 && std::abs(e[m]) > eps * tst1)
+                        m++;
+
+                    int iterations = 0;
+                    while (m > l && std::abs(e[l]) > eps * tst1) {
+                        if (++iterations > maxIterations)
+                            return false;
+
+                        // shift from the leading 2x2 block
+                        vtype g = d[l];
+                        vtype p = (d[l + 1] - g) / (2 * e[l]);
+                        vtype r = std::hypot(p, vtype(1));
+                        if (p < 0)
+                            r = -r;
+                        d[l] = e[l] / (p + r);
+                        d[l + 1] = e[l] * (p + r);
+                        const vtype dl1 = d[l + 1];
+                        vtype h = g - d[l];
+                        for (int i = l + 2; i < n; i++)
+                            d[i] -= h;
+                        f += h;
+
+                        // chase the bulge from m up to l
+                        p = d[m];
+                        vtype c = 1, c2 = 1, c3 = 1, s = 0, s2 = 0;
+                        const vtype el1 = e[l + 1];
+                        for (int i = m - 1; i >= l; i--) {
+                            c3 = c2;
+                            c2 = c;
+                            s2 = s;
+                            g = c * e[i];
+                            h = c * p;
+                            r = std::hypot(p, e[i]);
+                            e[i + 1] = s * r;
+                            s = e[i] / r;
+                            c = p / r;
+                            p = c * d[i] - s * g;
+                            d[i + 1] = h + s * (c * g + s * d[i]);
+                            cosines[i] = c;
+                            sines[i] = s;
+                        }
+                        if (z)
+                            rotate(l, m);
+                        p = -s * s2 * c3 * el1 * e[l] / dl1;
+                        e[l] = s * p;
+                        d[l] = c * p;
+                    }
+                    d[l] += f;
+                    e[l] = 0;
+                }
+                return true;
+            }
+    }
+
+    // eigenvalues (ascending) and orthonormal eigenvectors (columns of vectors) of the symmetric a,
+    // only the lower triangle of a is read; closed form, no iteration; the eigenvectors of a repeated eigenvalue
+    // are any orthonormal basis of its eigenspace
+    template<typename vtype>
+        void eigenSymmetric(const Matrix<3, 3, vtype> &a, Vector<3, vtype> &values, Matrix<3, 3, vtype> &vectors)
+        {
+            MATHLIB_COUNT(EigenSymmetric3, 1);
+            vtype in[3][3], v[3][3], lambda[3];
+            for (int i = 0; i < 3; i++)
+                for (int j = 0; j < 3; j++)
+                    in[i][j] = a[i][j];
+            detail::symmetricEigen3(in, lambda, v);
+            for (int i = 0; i < 3; i++) {
+                values[i] = lambda[i];
+                for (int j = 0; j < 3; j++)
+                    vectors[i][j] = v[i][j];
+            }
+        }
+
+    // the same for count matrices, e.g. the covariance matrices of point clusters; large batches are split
+    // across ThreadPool::global(); vectors may be null when only the eigenvalues are needed, which are then the
+    // plain closed-form ones: a repeated eigenvalue may come out split by about sqrt(epsilon) times the largest element
+    void eigenSymmetric(const Matrix3f *a, Vector<3, float> *values, Matrix3f *vectors, std::size_t count);
+    void eigenSymmetric(const Matrix3d *a, Vector<3, double> *values, Matrix3d *vectors, std::size_t count);
+
+    // eigen-decomposition of a symmetric matrix: blocked householder reduction to tridiagonal form,
+    // implicit ql iteration on the tridiagonal and blocked back-transformation of the eigenvectors
+    // only the lower triangle of a is read; the eigenvectors are stored column-major, one per column
+    template<typename vtype = float>
+        class SymmetricEigenDecomposition {
+            private:
+                DenseVector<vtype> _values;
+                DenseMatrix<vtype> _vectors;
+                bool _converged = false;
+
+            public:
+                SymmetricEigenDecomposition() = default;
+
+                explicit SymmetricEigenDecomposition(const DenseMatrix<vtype> &a, bool computeVectors = true)
+                {
+                    factor(a, computeVectors);
+                }
+
+                template<int n>
+                    explicit SymmetricEigenDecomposition(const Matrix<n, n, vtype> &a, bool computeVectors = true)
+                    {
+                        factor(DenseMatrix<vtype>(a), computeVectors);
+                    }
+
+                // return true if the iteration converged; without computeVectors only the eigenvalues are computed
+                bool factor(const DenseMatrix<vtype> &a, bool computeVectors = true)
+                {
+                    MATHLIB_TIME(SymmetricEigen, static_cast<std::uint64_t>(a.rows()) * a.cols());
+                    assert(a.rows() == a.cols());
+                    const int n = a.rows();
+                    _values.resize(n);
+                    _vectors = computeVectors ? DenseMatrix<vtype>::makeIdentity(n, StorageOrder::ColumnMajor) : DenseMatrix<vtype>();
+                    _converged = false;
+                    if (n == 0)
+                        return _converged = true;
+
+                    DenseMatrix<vtype> reduced = a.toOrder(StorageOrder::RowMajor);
+                    for (int i = 0; i < n; i++)
+                        for (int j = i + 1; j < n; j++)
+                            reduced(i, j) = reduced(j, i);
+
+                    std::vector<vtype> d, e, tau;
+                    detail::tridiagonalize(reduced, d, e, tau);
+                    if (!detail::tridiagonalQL(d, e, computeVectors ? &_vectors : nullptr))
+                        return false;
+                    if (computeVectors)
+                        detail::applyReflectors(reduced, tau, _vectors);
+
+                    // ascending order, the vectors follow their values
+                    for (int i = 0; i < n - 1; i++) {
+                        const int smallest = static_cast<int>(std::min_element(d.begin() + i, d.end()) - d.begin());
+                        if (smallest == i)
+                            continue;
+                        std::swap(d[i], d[smallest]);
+                        if (computeVectors)
+                            std::swap_ranges(_vectors.data() + static_cast<std::ptrdiff_t>(i) * n,
+                                    _vectors.data() + static_cast<std::ptrdiff_t>(i + 1) * n, _vectors.data() + static_cast<std::ptrdiff_t>(smallest) * n);
+                    }
+                    for (int i = 0; i < n; i++)
+                        _values[i] = d[i];
+                    return _converged = true;
+                }
+
+                bool hasConverged() const
+                {
+                    return _converged;
+                }
+
+                const DenseVector<vtype> &getEigenvalues() const
+                {
+                    return _values;
+                }
+
+                // column i belongs to eigenvalue i; empty if the vectors were not computed
+                const DenseMatrix<vtype> &getEigenvectors() const
+                {
+                    return _vectors;
+                }
+        };
+
+    // singular value decomposition a = u * diag(s) * v^T of an m x n matrix by one-sided jacobi rotations
+    // (hestenes): pairs of columns are rotated until all of them are orthogonal, the column norms are then the
+    // singular values; the pairs of one round of the round-robin ordering are disjoint and are rotated in parallel
+    // with k = min(m, n), u is m x k and v is n x k, both column-major; columns of u that belong to a zero
+    // singular value are zero
+    template<typename vtype = float>
+        class SingularValueDecomposition {
+            private:
+                DenseMatrix<vtype> _u;
+                DenseVector<vtype> _values;
+                DenseMatrix<vtype> _v;
+                bool _converged = false;
+
+            public:
+                SingularValueDecomposition() = default;
+
+                explicit SingularValueDecomposition(const DenseMatrix<vtype> &a)
+                {
+                    factor(a);
+                }
+
+                template<int rows, int cols>
+                    explicit SingularValueDecomposition(const Matrix<rows, cols, vtype> &a)
+                    {
+                        factor(DenseMatrix<vtype>(a));
+                    }
+
+                // return true if the rotations converged
+                bool factor(const DenseMatrix<vtype> &a)
+                {
+                    MATHLIB_TIME(SingularValueDecomposition, static_cast<std::uint64_t>(a.rows()) * a.cols());
+                    constexpr int maxSweeps = 30;
+
+                    // wide matrices are decomposed as a^T = v * s * u^T
+                    const bool wide = a.rows() < a.cols();
+                    const int m = wide ? a.cols() : a.rows();
+                    const int n = wide ? a.rows() : a.cols();
+                    DenseMatrix<vtype> g = wide ? a.getTransposed().toOrder(StorageOrder::ColumnMajor) : a.toOrder(StorageOrder::ColumnMajor);
+                    DenseMatrix<vtype> v = DenseMatrix<vtype>::makeIdentity(n, StorageOrder::ColumnMajor);
+                    _converged = false;
+
+                    // round-robin tournament: slot 0 stays, the others move by one every round; an odd
+                    // number of columns gets a dummy column -1 whose partner sits the round out
+                    const int slots = n + (n % 2);
+                    std::vector<int> order(slots);
+                    for (int i = 0; i < slots; i++)
+                        order[i] = (i < n) ? i : -1;
+
+                    const vtype tolerance = std::sqrt(static_cast<vtype>(m)) * std::numeric_limits<vtype>::epsilon();
+                    vtype *gData = g.data();
+                    vtype *vData = v.data();
+                    for (int sweep = 0; sweep < maxSweeps && !_converged; sweep++) {
+                        std::atomic<std::size_t> rotations {0};
+                        for (int round = 0; round < slots - 1; round++) {
+                            auto pairsKernel = [&](std::size_t first, std::size_t last) {
+                                std::size_t rotated = 0;
+                                for (std::size_t pair = first; pair < last; pair++) {
+                                    const int p = order[pair], q = order[slots - 1 - pair];
+                                    if (p < 0 || q < 0)
+                                        continue;
+                                    rotated += rotateColumns(m, n, gData, vData, p, q, tolerance);
+                                }
+                                rotations += rotated;
+                            };
+
+                            if (static_cast<std::size_t>(m) * slots < detail::spectralParallelThreshold || ThreadPool::global().size() == 1)
+                                pairsKernel(0, slots / 2);
+                            else
+                                ThreadPool::global().parallelFor(0, slots / 2, 1, pairsKernel);
+                            if (slots > 2)
+                                std::rotate(order.begin() + 1, order.end() - 1, order.end());
+                        }
+                        _converged = (rotations == 0);
+                    }
+
+                    // singular values are the column norms, descending; u gets the normalized columns
+                    std::vector<vtype> norms(n);
+                    for (int j = 0; j < n; j++) {
+                        vtype sum = 0;
+                        for (int i = 0; i < m; i++)
+                            sum += g(i, j) * g(i, j);
+                        norms[j] = std::sqrt(sum);
+                    }
+                    std::vector<int> byValue(n);
+                    for (int j = 0; j < n; j++)
+                        byValue[j] = j;
+                    std::stable_sort(byValue.begin(), byValue.end(), [&](int x, int y) { return norms[x] > norms[y]; });
+
+                    DenseMatrix<vtype> &u = wide ? _v : _u;
+                    DenseMatrix<vtype> &right = wide ? _u : _v;
+                    u = DenseMatrix<vtype>(m, n, StorageOrder::ColumnMajor);
+                    right = DenseMatrix<vtype>(n, n, StorageOrder::ColumnMajor);
+                    _values.resize(n);
+                    for (int k = 0; k < n; k++) {
+                        const int j = byValue[k];
+                        _values[k] = norms[j];
+                        const vtype inv = (norms[j] > vtype(0)) ? vtype(1) / norms[j] : vtype(0);
+                        for (int i = 0; i < m; i++)
+                            u(i, k) = g(i, j) * inv;
+                        for (int i = 0; i < n; i++)
+                            right(i, k) = v(i, j);
+                    }
+                    return _converged;
+                }
+
+                bool hasConverged() const
+                {
+                    return _converged;
+                }
+
+                const DenseMatrix<vtype> &getU() const
+                {
+                    return _u;
+                }
+
+                const DenseVector<vtype> &getSingularValues() const
+                {
+                    return _values;
+                }
+
+                const DenseMatrix<vtype> &getV() const
+                {
+                    return _v;
+                }
+
+                // number of singular values above max(m, n) * epsilon * the largest one
+                int getRank() const
+                {
+                    if (_values.size() == 0)
+                        return 0;
+                    const vtype threshold = cutoff();
+                    int rank = 0;
+                    while (rank < _values.size() && _values[rank] > threshold)
+                        rank++;
+                    return rank;
+                }
+
+                // minimum norm least squares solution of a * x = b, singular values below the rank threshold are dropped
+                DenseVector<vtype> solve(const DenseVector<vtype> &b) const
+                {
+                    assert(b.size() == _u.rows());
+                    const int rank = getRank();
+                    DenseVector<vtype> x(_v.rows());
+                    for (int k = 0; k < rank; k++) {
+                        vtype projection = 0;
+                        for (int i = 0; i < _u.rows(); i++)
+                            projection += _u(i, k) * b[i];
+                        projection /= _values[k];
+                        for (int i = 0; i < _v.rows(); i++)
+                            x[i] += _v(i, k) * projection;
+                    }
+                    return x;
+                }
+
+            private:
+                vtype cutoff() const
+                {
+                    return static_cast<vtype>(std::max(_u.rows(), _v.rows())) * std::numeric_limits<vtype>::epsilon() * _values[0];
+                }
+
+                // orthogonalize columns p and q of g, with the same rotation applied to v; returns 1 if they were rotated
+                static std::size_t rotateColumns(int m, int n, vtype *g, vtype *v, int p, int q, vtype tolerance)
+                {
+                    vtype *gp = g + static_cast<std::ptrdiff_t>(p) * m, *gq = g + static_cast<std::ptrdiff_t>(q) * m;
+                    vtype alpha = 0, beta = 0, gamma = 0;
+                    for (int i = 0; i < m; i++) {
+                        alpha += gp[i] * gp[i];
+                        beta += gq[i] * gq[i];
+                        gamma += gp[i] * gq[i];
+                    }
+                    if (!(std::abs(gamma) > tolerance * std::sqrt(alpha * beta)))
+                        return 0;
+
+                    // the rotation that zeroes the off-diagonal of [alpha gamma; gamma beta], smaller angle
+                    const vtype zeta = (beta - alpha) / (2 * gamma);
+                    const vtype t = std::copysign(vtype(1), zeta) / (std::abs(zeta) + std::sqrt(vtype(1) + zeta * zeta));
+                    const vtype c = vtype(1) / std::sqrt(vtype(1) + t * t);
+                    const vtype s = c * t;
+                    for (int i = 0; i < m; i++) {
+                        const vtype x = gp[i], y = gq[i];
+                        gp[i] = c * x - s * y;
+                        gq[i] = s * x + c * y;
+                    }
+                    vtype *vp = v + static_cast<std::ptrdiff_t>(p) * n, *vq = v + static_cast<std::ptrdiff_t>(q) * n;
+                    for (int i = 0; i < n; i++) {
+                        const vtype x = vp[i], y = vq[i];
+                        vp[i] = c * x - s * y;
+                        vq[i] = s * x + c * y;
+                    }
+                    return 1;
+                }
+        };
+}
@@ -1,7 +1,19 @@
 #pragma once
 
+#include <cstddef>
+
 namespace mathlib {
     // return true if solutions exists
     // x0 <= x1 is guaranteed
     bool solveQuadratic(double a, double b, double c, double &x0, double &x1);
+
+    // solve a[n] * x^2 + b[n] * x + c[n] = 0 for every n in [0, count), the coefficients are separate arrays
+    // valid[n] is set to 1 if real solutions exist and x0[n] <= x1[n] hold them, otherwise valid[n] is 0
+    // and x0[n], x1[n] are unspecified
+    // branch-free simd kernel, returns the number of equations with real solutions
+    std::size_t solveQuadratic(const float *a, const float *b, const float *c,
+            float *x0, float *x1, unsigned char *valid, std::size_t count);
+
+    std::size_t solveQuadratic(const double *a, const double *b, const double *c,
+            double *x0, double *x1, unsigned char *valid, std::size_t count);
 }
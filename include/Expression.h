@@ -0,0 +1,244 @@
+#pragma once
+
+#include <utility>
+#include <type_traits>
+
+#include "Matrix.h"
+#include "Vector.h"
+
+namespace mathlib {
+    // opt-in expression templates for element-wise Vector and Matrix arithmetic
+    // operands wrapped with lazy() build an expression tree instead of a value; it is computed
+    // in a single pass without temporaries when assigned or evaluated:
+    //
+    //     Vector3 r = evaluate(lazy(a) + lazy(b) * s - lazy(c));
+    //     assign(r, lazy(a) + lazy(b) * s - lazy(c));
+    //
+    // expressions hold references to their operands and must not outlive them
+    namespace expr {
+        template<typename T>
+            struct Traits;
+
+        template<int dim, typename vtype>
+            struct Traits<Vector<dim, vtype>> {
+                using ValueType = vtype;
+                static constexpr int size = dim;
+                static constexpr bool isMatrix = false;
+            };
+
+        template<int rows, int cols, typename vtype>
+            struct Traits<Matrix<rows, cols, vtype>> {
+                using ValueType = vtype;
+                static constexpr int size = rows * cols;
+                static constexpr bool isMatrix = true;
+            };
+
+        // crtp base of every expression node
+        template<typename Derived>
+            struct Expression {
+                const Derived &self() const
+                {
+                    return static_cast<const Derived&>(*this);
+                }
+            };
+
+        // leaf node referencing an existing Vector or Matrix
+        template<typename T>
+            class Terminal : public Expression<Terminal<T>> {
+                private:
+                    const T &_ref;
+
+                public:
+                    using ResultType = T;
+                    using ValueType = typename Traits<T>::ValueType;
+
+                    explicit Terminal(const T &ref)
+                        : _ref {ref} {}
+
+                    ValueType operator[](int i) const
+                    {
+                        return _ref.data()[i];
+                    }
+        };
+
+        template<typename L, typename R, typename Op>
+            class Binary : public Expression<Binary<L, R, Op>> {
+                static_assert(std::is_same_v<typename L::ResultType, typename R::ResultType>,
+                        "operands of an expression must have the same type");
+
+                private:
+                    const L _l;
+                    const R _r;
+
+                public:
+                    using ResultType = typename L::ResultType;
+                    using ValueType = typename L::ValueType;
+
+                    Binary(const L &l, const R &r)
+                        : _l {l}, _r {r} {}
+
+                    ValueType operator[](int i) const
+                    {
+                        return Op::apply(_l[i], _r[i]);
+                    }
+            };
+
+        template<typename E, typename Op>
+            class Scalar : public Expression<Scalar<E, Op>> {
+                public:
+                    using ResultType = typename E::ResultType;
+                    using ValueType = typename E::ValueType;
+
+                private:
+                    const E _e;
+                    const ValueType _scalar;
+
+                public:
+                    Scalar(const E &e, ValueType scalar)
+                        : _e {e}, _scalar {scalar} {}
+
+                    ValueType operator[](int i) const
+                    {
+                        return Op::apply(_e[i], _scalar);
+                    }
+            };
+
+        template<typename E>
+            class Negate : public Expression<Negate<E>> {
+                private:
+                    const E _e;
+
+                public:
+                    using ResultType = typename E::ResultType;
+                    using ValueType = typename E::ValueType;
+
+                    explicit Negate(const E &e)
+                        : _e {e} {}
+
+                    ValueType operator[](int i) const
+                    {
+                        return -_e[i];
+                    }
+            };
+
+        struct Add {
+            template<typename T>
+                static T apply(T a, T b) { return a + b; }
+        };
+
+        struct Subtract {
+            template<typename T>
+                static T apply(T a, T b) { return a - b; }
+        };
+
+        struct Multiply {
+            template<typename T>
+                static T apply(T a, T b) { return a * b; }
+        };
+
+        struct Divide {
+            template<typename T>
+                static T apply(T a, T b) { return a / b; }
+        };
+
+        template<typename L, typename R>
+            Binary<L, R, Add> operator+(const Expression<L> &l, const Expression<R> &r)
+            {
+                return {l.self(), r.self()};
+            }
+
+        template<typename L, typename R>
+            Binary<L, R, Subtract> operator-(const Expression<L> &l, const Expression<R> &r)
+            {
+                return {l.self(), r.self()};
+            }
+
+        // element-wise product like Vector::operator*, not defined for matrices
+        template<typename L, typename R>
+            Binary<L, R, Multiply> operator*(const Expression<L> &l, const Expression<R> &r)
+            {
+                static_assert(!Traits<typename L::ResultType>::isMatrix,
+                        "element-wise matrix products are not supported, use Matrix::operator*");
+                return {l.self(), r.self()};
+            }
+
+        template<typename L, typename R>
+            Binary<L, R, Divide> operator/(const Expression<L> &l, const Expression<R> &r)
+            {
+                static_assert(!Traits<typename L::ResultType>::isMatrix,
+                        "element-wise matrix quotients are not supported");
+                return {l.self(), r.self()};
+            }
+
+        template<typename E>
+            Scalar<E, Multiply> operator*(const Expression<E> &e, typename E::ValueType scale)
+            {
+                return {e.self(), scale};
+            }
+
+        template<typename E>
+            Scalar<E, Multiply> operator*(typename E::ValueType scale, const Expression<E> &e)
+            {
+                return {e.self(), scale};
+            }
+
+        template<typename E>
+            Scalar<E, Divide> operator/(const Expression<E> &e, typename E::ValueType scale)
+            {
+                return {e.self(), scale};
+            }
+
+        template<typename E>
+            Negate<E> operator-(const Expression<E> &e)
+            {
+                return Negate<E> {e.self()};
+            }
+
+        // fully unrolled evaluation, lets the compiler keep every element in registers and vectorize across them
+        template<typename T, typename E, int... index>
+            inline void assignElements(T &dest, const E &e, std::integer_sequence<int, index...>)
+            {
+                const typename E::ValueType values[] = {e[index]...};
+                auto *out = dest.data();
+                ((out[index] = values[index]), ...);
+            }
+    }
+
+    // start an expression from an existing vector or matrix
+    template<int dim, typename vtype>
+        expr::Terminal<Vector<dim, vtype>> lazy(const Vector<dim, vtype> &vec)
+        {
+            return expr::Terminal<Vector<dim, vtype>> {vec};
+        }
+
+    template<int rows, int cols, typename vtype>
+        expr::Terminal<Matrix<rows, cols, vtype>> lazy(const Matrix<rows, cols, vtype> &mat)
+        {
+            return expr::Terminal<Matrix<rows, cols, vtype>> {mat};
+        }
+
+    // temporaries would dangle inside the expression
+    template<int dim, typename vtype>
+        void lazy(const Vector<dim, vtype> &&vec) = delete;
+
+    template<int rows, int cols, typename vtype>
+        void lazy(const Matrix<rows, cols, vtype> &&mat) = delete;
+
+    // compute the expression into dest in a single pass
+    // all values are computed before the first store, so dest may appear in the expression
+    // and the compiler does not have to assume that the stores clobber the operands
+    template<typename T, typename E>
+        inline void assign(T &dest, const expr::Expression<E> &e)
+        {
+            static_assert(std::is_same_v<T, typename E::ResultType>, "destination must match the expression type");
+            expr::assignElements(dest, e.self(), std::make_integer_sequence<int, expr::Traits<T>::size>());
+        }
+
+    template<typename E>
+        inline typename E::ResultType evaluate(const expr::Expression<E> &e)
+        {
+            typename E::ResultType result;
+            assign(result, e);
+            return result;
+        }
+}
@@ -0,0 +1,532 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+
+#include "Gemm.h"
+#include "Matrix.h"
+#include "Vector.h"
+#include "DenseMatrix.h"
+#include "DenseVector.h"
+#include "Instrumentation.h"
+
+namespace mathlib {
+    // factorizations for repeated linear solves: factor once in O(n^3), then every
+    // right-hand side costs O(n^2); a DenseMatrix of right-hand sides is solved column-wise in one sweep
+    // the factors are kept in row-major DenseMatrix storage, fixed-size matrices and vectors are converted
+
+    namespace detail {
+        // columns per panel of the blocked factorizations; the trailing updates run through gemm
+        constexpr int factorizationBlock = 64;
+
+        template<typename vtype>
+            DenseMatrix<vtype> toRowMajor(const DenseMatrix<vtype> &a)
+            {
+                return (a.order() == StorageOrder::RowMajor) ? a : a.toOrder(StorageOrder::RowMajor);
+            }
+
+        // solve l * x = b in place for unit (or general) lower triangular l, b: n x nrhs row-major
+        template<typename vtype>
+            void forwardSubstitute(const DenseMatrix<vtype> &l, bool unitDiagonal, vtype *b, int nrhs)
+            {
+                const int n = l.rows();
+                for (int i = 0; i < n; i++) {
+                    vtype *bi = b + static_cast<std::ptrdiff_t>(i) * nrhs;
+                    for (int j = 0; j < i; j++) {
+                        const vtype factor = l(i, j);
+                        const vtype *bj = b + static_cast<std::ptrdiff_t>(j) * nrhs;
+                        for (int c = 0; c < nrhs; c++)
+                            bi[c] -= factor * bj[c];
+                    }
+                    if (!unitDiagonal)
+                        for (int c = 0; c < nrhs; c++)
+                            bi[c] /= l(i, i);
+                }
+            }
+
+        // solve u * x = b in place for the upper triangle of u (first n rows), b: n x nrhs row-major
+        template<typename vtype>
+            void backSubstitute(const DenseMatrix<vtype> &u, int n, vtype *b, int nrhs)
+            {
+                for (int i = n - 1; i >= 0; i--) {
+                    vtype *bi = b + static_cast<std::ptrdiff_t>(i) * nrhs;
+                    for (int j = i + 1; j < n; j++) {
+                        const vtype factor = u(i, j);
+                        const vtype *bj = b + static_cast<std::ptrdiff_t>(j) * nrhs;
+                        for (int c = 0; c < nrhs; c++)
+                            bi[c] -= factor * bj[c];
+                    }
+                    for (int c = 0; c < nrhs; c++)
+                        bi[c] /= u(i, i);
+                }
+            }
+    }
+
+    // lu factorization with partial pivoting p * a = l * u of a square matrix
+    template<typename vtype = float>
+        class LUFactorization {
+            private:
+                DenseMatrix<vtype> _lu;
+                std::vector<int> _perm;
+                int _sign = 1;
+                bool _singular = true;
+
+            public:
+                LUFactorization() = default;
+
+                explicit LUFactorization(const DenseMatrix<vtype> &a)
+                {
+                    factor(a);
+                }
+
+                template<int n>
+                    explicit LUFactorization(const Matrix<n, n, vtype> &a)
+                    {
+                        factor(DenseMatrix<vtype>(a));
+                    }
+
+                // return true if a is non-singular; a singular matrix can not be used to solve
+                bool factor(const DenseMatrix<vtype> &a)
+                {
+                    MATHLIB_TIME(Factorization, static_cast<std::uint64_t>(a.rows()) * a.cols());
+                    assert(a.rows() == a.cols());
+                    _lu = detail::toRowMajor(a);
+                    const int n = _lu.rows();
+                    const std::ptrdiff_t lda = n;
+                    vtype *data = _lu.data();
+
+                    _perm.resize(n);
+                    for (int i = 0; i < n; i++)
+                        _perm[i] = i;
+                    _sign = 1;
+                    _singular = false;
+
+                    for (int k = 0; k < n; k += detail::factorizationBlock) {
+                        const int kb = std::min(detail::factorizationBlock, n - k);
+
+                        // unblocked factorization of the panel, rows are swapped over their full width
+                        for (int j = k; j < k + kb; j++) {
+                            int pivot = j;
+                            for (int i = j + 1; i < n; i++)
+                                if (std::abs(_lu(i, j)) > std::abs(_lu(pivot, j)))
+                                    pivot = i;
+
+                            if (_lu(pivot, j) == vtype(0)) {
+                                _singular = true;
+                                return false;
+                            }
+
+                            if (pivot != j) {
+                                std::swap_ranges(data + j * lda, data + (j + 1) * lda, data + pivot * lda);
+                                std::swap(_perm[j], _perm[pivot]);
+                                _sign = -_sign;
+                            }
+
+                            const vtype inv = vtype(1) / _lu(j, j);
+                            for (int i = j + 1; i < n; i++) {
+                                const vtype factor = _lu(i, j) * inv;
+                                _lu(i, j) = factor;
+                                for (int c = j + 1; c < k + kb; c++)
+                                    _lu(i, c) -= factor * _lu(j, c);
+                            }
+                        }
+
+                        const int rest = n - k - kb;
+                        if (rest == 0)
+                            continue;
+
+                        // u12 = l11^-1 * a12
+                        for (int i = k + 1; i < k + kb; i++)
+                            for (int p = k; p < i; p++) {
+                                const vtype factor = _lu(i, p);
+                                for (int c = k + kb; c < n; c++)
+                                    _lu(i, c) -= factor * _lu(p, c);
+                            }
+
+                        // a22 -= l21 * u12
+                        gemm(rest, rest, kb,
+                                vtype(-1), data + (k + kb) * lda + k, lda, 1,
+                                data + k * lda + k + kb, lda, 1,
+                                vtype(1), data + (k + kb) * lda + k + kb, lda, 1);
+                    }
+                    return true;
+                }
+
+                bool isSingular() const
+                {
+                    return _singular;
+                }
+
+                vtype getDeterminant() const
+                {
+                    if (_singular)
+                        return 0;
+
+                    vtype det = static_cast<vtype>(_sign);
+                    for (int i = 0; i < _lu.rows(); i++)
+                        det *= _lu(i, i);
+                    return det;
+                }
+
+                // combined factors: l below the diagonal (unit diagonal implied), u on and above it
+                const DenseMatrix<vtype> &getLU() const
+                {
+                    return _lu;
+                }
+
+                // row i of p * a is row getPermutation()[i] of a
+                const std::vector<int> &getPermutation() const
+                {
+                    return _perm;
+                }
+
+                // solve a * x = b for every column of b in place
+                void solveInPlace(DenseMatrix<vtype> &b) const
+                {
+                    assert(!_singular && b.rows() == _lu.rows());
+                    DenseMatrix<vtype> x(b.rows(), b.cols());
+                    for (int i = 0; i < b.rows(); i++)
+                        for (int c = 0; c < b.cols(); c++)
+                            x(i, c) = b(_perm[i], c);
+
+                    detail::forwardSubstitute(_lu, true, x.data(), x.cols());
+                    detail::backSubstitute(_lu, _lu.rows(), x.data(), x.cols());
+                    b = (b.order() == StorageOrder::RowMajor) ? std::move(x) : x.toOrder(b.order());
+                }
+
+                DenseVector<vtype> solve(const DenseVector<vtype> &b) const
+                {
+                    assert(!_singular && b.size() == _lu.rows());
+                    DenseVector<vtype> x(b.size());
+                    for (int i = 0; i < b.size(); i++)
+                        x[i] = b[_perm[i]];
+
+                    detail::forwardSubstitute(_lu, true, x.data(), 1);
+                    detail::backSubstitute(_lu, _lu.rows(), x.data(), 1);
+                    return x;
+                }
+
+                template<int n>
+                    Vector<n, vtype> solve(const Vector<n, vtype> &b) const
+                    {
+                        const DenseVector<vtype> x = solve(DenseVector<vtype>(b));
+                        Vector<n, vtype> result;
+                        for (int i = 0; i < n; i++)
+                            result[i] = x[i];
+                        return result;
+                    }
+        };
+
+    // cholesky factorization a = l * l^T of a symmetric positive definite matrix
+    // only the lower triangle of a is read
+    template<typename vtype = float>
+        class CholeskyFactorization {
+            private:
+                DenseMatrix<vtype> _l;
+                bool _positiveDefinite = false;
+
+            public:
+                CholeskyFactorization() = default;
+
+                explicit CholeskyFactorization(const DenseMatrix<vtype> &a)
+                {
+                    factor(a);
+                }
+
+                template<int n>
+                    explicit CholeskyFactorization(const Matrix<n, n, vtype> &a)
+                    {
+                        factor(DenseMatrix<vtype>(a));
+                    }
+
+                // return true if a is positive definite; otherwise the factorization can not be used to solve
+                bool factor(const DenseMatrix<vtype> &a)
+                {
+                    MATHLIB_TIME(Factorization, static_cast<std::uint64_t>(a.rows()) * a.cols());
+                    assert(a.rows() == a.cols());
+                    _l = detail::toRowMajor(a);
+                    const int n = _l.rows();
+                    const std::ptrdiff_t lda = n;
+                    vtype *data = _l.data();
+                    _positiveDefinite = false;
+
+                    for (int k = 0; k < n; k += detail::factorizationBlock) {
+                        const int kb = std::min(detail::factorizationBlock, n - k);
+
+                        // diagonal block, left-looking within the block
+                        for (int j = k; j < k + kb; j++) {
+                            vtype diagonal = _l(j, j);
+                            for (int p = k; p < j; p++)
+                                diagonal -= _l(j, p) * _l(j, p);
+                            if (!(diagonal > vtype(0)))
+                                return false;
+
+                            _l(j, j) = std::sqrt(diagonal);
+                            for (int i = j + 1; i < k + kb; i++) {
+                                vtype sum = _l(i, j);
+                                for (int p = k; p < j; p++)
+                                    sum -= _l(i, p) * _l(j, p);
+                                _l(i, j) = sum / _l(j, j);
+                            }
+                        }
+
+                        const int rest = n - k - kb;
+                        if (rest == 0)
+                            continue;
+
+                        // l21 = a21 * l11^-T
+                        for (int i = k + kb; i < n; i++)
+                            for (int j = k; j < k + kb; j++) {
+                                vtype sum = _l(i, j);
+                                for (int p = k; p < j; p++)
+                                    sum -= _l(i, p) * _l(j, p);
+                                _l(i, j) = sum / _l(j, j);
+                            }
+
+                        // a22 -= l21 * l21^T, the upper triangle is updated too and cleared at the end
+                        gemm(rest, rest, kb,
+                                vtype(-1), data + (k + kb) * lda + k, lda, 1,
+                                data + (k + kb) * lda + k, 1, lda,
+                                vtype(1), data + (k + kb) * lda + k + kb, lda, 1);
+                    }
+
+                    for (int i = 0; i < n; i++)
+                        for (int j = i + 1; j < n; j++)
+                            _l(i, j) = 0;
+
+                    _positiveDefinite = true;
+                    return true;
+                }
+
+                bool isPositiveDefinite() const
+                {
+                    return _positiveDefinite;
+                }
+
+                vtype getDeterminant() const
+                {
+                    if (!_positiveDefinite)
+                        return 0;
+
+                    vtype det = 1;
+                    for (int i = 0; i < _l.rows(); i++)
+                        det *= _l(i, i) * _l(i, i);
+                    return det;
+                }
+
+                // lower triangular factor
+                const DenseMatrix<vtype> &getL() const
+                {
+                    return _l;
+                }
+
+                // solve a * x = b for every column of b in place
+                void solveInPlace(DenseMatrix<vtype> &b) const
+                {
+                    assert(_positiveDefinite && b.rows() == _l.rows());
+                    DenseMatrix<vtype> x = detail::toRowMajor(b);
+                    solveRows(x.data(), x.cols());
+                    b = (b.order() == StorageOrder::RowMajor) ? std::move(x) : x.toOrder(b.order());
+                }
+
+                DenseVector<vtype> solve(const DenseVector<vtype> &b) const
+                {
+                    assert(_positiveDefinite && b.size() == _l.rows());
+                    DenseVector<vtype> x(b);
+                    solveRows(x.data(), 1);
+                    return x;
+                }
+
+                template<int n>
+                    Vector<n, vtype> solve(const Vector<n, vtype> &b) const
+                    {
+                        const DenseVector<vtype> x = solve(DenseVector<vtype>(b));
+                        Vector<n, vtype> result;
+                        for (int i = 0; i < n; i++)
+                            result[i] = x[i];
+                        return result;
+                    }
+
+            private:
+                // l * y = b, then l^T * x = y
+                void solveRows(vtype *b, int nrhs) const
+                {
+                    const int n = _l.rows();
+                    detail::forwardSubstitute(_l, false, b, nrhs);
+                    for (int i = n - 1; i >= 0; i--) {
+                        vtype *bi = b + static_cast<std::ptrdiff_t>(i) * nrhs;
+                        for (int j = i + 1; j < n; j++) {
+                            const vtype factor = _l(j, i);
+                            const vtype *bj = b + static_cast<std::ptrdiff_t>(j) * nrhs;
+                            for (int c = 0; c < nrhs; c++)
+                                bi[c] -= factor * bj[c];
+                        }
+                        for (int c = 0; c < nrhs; c++)
+                            bi[c] /= _l(i, i);
+                    }
+                }
+        };
+
+    // householder qr factorization a = q * r of an m x n matrix with m >= n
+    // solve() returns the least squares solution of a * x = b
+    template<typename vtype = float>
+        class QRFactorization {
+            private:
+                // r on and above the diagonal, householder vectors below it (leading 1 implied)
+                DenseMatrix<vtype> _qr;
+                std::vector<vtype> _tau;
+                bool _fullRank = false;
+
+            public:
+                QRFactorization() = default;
+
+                explicit QRFactorization(const DenseMatrix<vtype> &a)
+                {
+                    factor(a);
+                }
+
+                template<int rows, int cols>
+                    explicit QRFactorization(const Matrix<rows, cols, vtype> &a)
+                    {
+                        factor(DenseMatrix<vtype>(a));
+                    }
+
+                // return true if a has full column rank; otherwise the factorization can not be used to solve
+                bool factor(const DenseMatrix<vtype> &a)
+                {
+                    MATHLIB_TIME(Factorization, static_cast<std::uint64_t>(a.rows()) * a.cols());
+                    assert(a.rows() >= a.cols());
+                    _qr = detail::toRowMajor(a);
+                    const int m = _qr.rows();
+                    const int n = _qr.cols();
+                    _tau.assign(n, vtype(0));
+                    _fullRank = true;
+
+                    std::vector<vtype> w(n);
+                    for (int j = 0; j < n; j++) {
+                        vtype norm = 0;
+                        for (int i = j; i < m; i++)
+                            norm += _qr(i, j) * _qr(i, j);
+                        norm = std::sqrt(norm);
+
+                        if (norm == vtype(0)) {
+                            _fullRank = false;
+                            continue;
+                        }
+
+                        // h = I - tau * v * v^T maps column j onto beta * e_j
+                        const vtype x0 = _qr(j, j);
+                        const vtype beta = (x0 >= vtype(0)) ? -norm : norm;
+                        const vtype tau = (beta - x0) / beta;
+                        const vtype scale = vtype(1) / (x0 - beta);
+                        for (int i = j + 1; i < m; i++)
+                            _qr(i, j) *= scale;
+                        _qr(j, j) = beta;
+                        _tau[j] = tau;
+
+                        // apply h to the remaining columns: w = v^T * a, a -= tau * v * w
+                        for (int c = j + 1; c < n; c++)
+                            w[c] = _qr(j, c);
+                        for (int i = j + 1; i < m; i++) {
+                            const vtype vi = _qr(i, j);
+                            for (int c = j + 1; c < n; c++)
+                                w[c] += vi * _qr(i, c);
+                        }
+                        for (int c = j + 1; c < n; c++)
+                            _qr(j, c) -= tau * w[c];
+                        for (int i = j + 1; i < m; i++) {
+                            const vtype vi = _qr(i, j);
+                            for (int c = j + 1; c < n; c++)
+                                _qr(i, c) -= tau * vi * w[c];
+                        }
+                    }
+                    return _fullRank;
+                }
+
+                bool isFullRank() const
+                {
+                    return _fullRank;
+                }
+
+                // upper triangular n x n factor
+                DenseMatrix<vtype> getR() const
+                {
+                    const int n = _qr.cols();
+                    DenseMatrix<vtype> r(n, n);
+                    for (int i = 0; i < n; i++)
+                        for (int j = i; j < n; j++)
+                            r(i, j) = _qr(i, j);
+                    return r;
+                }
+
+                // least squares solutions for every column of b (m x nrhs), the result is n x nrhs
+                DenseMatrix<vtype> solve(const DenseMatrix<vtype> &b) const
+                {
+                    assert(_fullRank && b.rows() == _qr.rows());
+                    DenseMatrix<vtype> x = detail::toRowMajor(b);
+                    solveRows(x.data(), x.cols());
+
+                    DenseMatrix<vtype> result(_qr.cols(), b.cols(), b.order());
+                    for (int i = 0; i < result.rows(); i++)
+                        for (int c = 0; c < result.cols(); c++)
+                            result(i, c) = x(i, c);
+                    return result;
+                }
+
+                DenseVector<vtype> solve(const DenseVector<vtype> &b) const
+                {
+                    assert(_fullRank && b.size() == _qr.rows());
+                    DenseVector<vtype> x(b);
+                    solveRows(x.data(), 1);
+
+                    DenseVector<vtype> result(_qr.cols());
+                    for (int i = 0; i < result.size(); i++)
+                        result[i] = x[i];
+                    return result;
+                }
+
+                template<int rows, int cols = rows>
+                    Vector<cols, vtype> solve(const Vector<rows, vtype> &b) const
+                    {
+                        const DenseVector<vtype> x = solve(DenseVector<vtype>(b));
+                        Vector<cols, vtype> result;
+                        for (int i = 0; i < cols && i < x.size(); i++)
+                            result[i] = x[i];
+                        return result;
+                    }
+
+            private:
+                // b = q^T * b, then r * x = b for the first n rows
+                void solveRows(vtype *b, int nrhs) const
+                {
+                    const int m = _qr.rows();
+                    const int n = _qr.cols();
+                    std::vector<vtype> w(nrhs);
+                    for (int j = 0; j < n; j++) {
+                        const vtype *bj = b + static_cast<std::ptrdiff_t>(j) * nrhs;
+                        for (int c = 0; c < nrhs; c++)
+                            w[c] = bj[c];
+                        for (int i = j + 1; i < m; i++) {
+                            const vtype vi = _qr(i, j);
+                            const vtype *bi = b + static_cast<std::ptrdiff_t>(i) * nrhs;
+                            for (int c = 0; c < nrhs; c++)
+                                w[c] += vi * bi[c];
+                        }
+
+                        vtype *bjw = b + static_cast<std::ptrdiff_t>(j) * nrhs;
+                        for (int c = 0; c < nrhs; c++)
+                            bjw[c] -= _tau[j] * w[c];
+                        for (int i = j + 1; i < m; i++) {
+                            const vtype vi = _qr(i, j);
+                            vtype *bi = b + static_cast<std::ptrdiff_t>(i) * nrhs;
+                            for (int c = 0; c < nrhs; c++)
+                                bi[c] -= _tau[j] * vi * w[c];
+                        }
+                    }
+                    detail::backSubstitute(_qr, n, b, nrhs);
+                }
+        };
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdio>
+#include <cstddef>
+#include <charconv>
+#include <cstring>
+#include <type_traits>
+
+namespace mathlib {
+    // text formatting without heap allocation, built on std::to_chars
+    // types provide char *format(char *first, char *last, const FormatOptions &options) const, which writes
+    // into [first, last) and returns one past the last written character, or nullptr if the text does not fit
+
+    enum class FloatStyle {
+        // like the default of std::ostream (%g), precision significant digits
+        General,
+        // precision digits after the decimal point
+        Fixed,
+        // the shortest text that reads back to the same value, precision is ignored
+        Shortest
+    };
+
+    struct FormatOptions {
+        FloatStyle style = FloatStyle::General;
+        int precision = 6;
+    };
+
+    namespace detail {
+        // upper bound of the text of one scalar in General style up to precision 17 and in Shortest style
+        constexpr int maxScalarLength = 32;
+
+        template<typename vtype>
+            char *formatScalar(char *first, char *last, vtype value, const FormatOptions &options)
+            {
+                std::to_chars_result result;
+                if constexpr (std::is_floating_point_v<vtype>) {
+                    switch (options.style) {
+                        case FloatStyle::General:
+                            result = std::to_chars(first, last, value, std::chars_format::general, options.precision);
+                            break;
+                        case FloatStyle::Fixed:
+                            result = std::to_chars(first, last, value, std::chars_format::fixed, options.precision);
+                            break;
+                        default:
+                            result = std::to_chars(first, last, value);
+                            break;
+                    }
+                } else {
+                    result = std::to_chars(first, last, value);
+                }
+                return (result.ec == std::errc()) ? result.ptr : nullptr;
+            }
+
+        inline char *formatText(char *first, char *last, const char *text, std::size_t length)
+        {
+            if (first == nullptr || static_cast<std::size_t>(last - first) < length)
+                return nullptr;
+            std::memcpy(first, text, length);
+            return first + length;
+        }
+
+        // "[ v0 v1 ... ]", the layout of Vector::print
+        template<typename vtype>
+            char *formatValues(char *first, char *last, const vtype *values, int count, const FormatOptions &options)
+            {
+                first = formatText(first, last, "[ ", 2);
+                for (int n = 0; n < count && first != nullptr; n++) {
+                    first = formatScalar(first, last, values[n], options);
+                    first = formatText(first, last, " ", 1);
+                }
+                return formatText(first, last, "]", 1);
+            }
+    }
+
+    // scalars and every type with a format member
+    template<typename T>
+        char *format(char *first, char *last, const T &value, const FormatOptions &options = FormatOptions())
+        {
+            if constexpr (std::is_arithmetic_v<T>)
+                return detail::formatScalar(first, last, value, options);
+            else
+                return value.format(first, last, options);
+        }
+
+    // buffered text sink with a fixed internal buffer, writes to a FILE or hands full buffers to a callback
+    // never allocates; a single value larger than the buffer is not written and makes write() return false
+    class FormatWriter {
+        public:
+            using Callback = void (*)(void *context, const char *data, std::size_t size);
+
+            static constexpr std::size_t bufferSize = 8192;
+
+        private:
+            char _buffer[bufferSize];
+            std::size_t _size = 0;
+            std::FILE *_file = nullptr;
+            Callback _callback = nullptr;
+            void *_context = nullptr;
+
+            // run format(first, last) on the free space, flushing once and retrying if it does not fit
+            template<typename F>
+                bool append(F format)
+                {
+                    char *end = format(_buffer + _size, _buffer + bufferSize);
+                    if (end == nullptr) {
+                        flush();
+                        end = format(_buffer, _buffer + bufferSize);
+                        if (end == nullptr)
+                            return false;
+                    }
+                    _size = static_cast<std::size_t>(end - _buffer);
+                    return true;
+                }
+
+        public:
+            FormatOptions options;
+
+            explicit FormatWriter(std::FILE *file = stdout, const FormatOptions &options = FormatOptions())
+                : _file(file), options(options) {}
+
+            FormatWriter(Callback callback, void *context, const FormatOptions &options = FormatOptions())
+                : _callback(callback), _context(context), options(options) {}
+
+            ~FormatWriter()
+            {
+                flush();
+            }
+
+            FormatWriter(const FormatWriter &other) = delete;
+            FormatWriter &operator=(const FormatWriter &other) = delete;
+
+            void flush()
+            {
+                if (_size == 0)
+                    return;
+                if (_callback != nullptr)
+                    _callback(_context, _buffer, _size);
+                else if (_file != nullptr)
+                    std::fwrite(_buffer, 1, _size, _file);
+                _size = 0;
+            }
+
+            bool writeText(const char *text, std::size_t length)
+            {
+                while (length > 0) {
+                    if (_size == bufferSize)
+                        flush();
+                    const std::size_t chunk = (length < bufferSize - _size) ? length : bufferSize - _size;
+                    std::memcpy(_buffer + _size, text, chunk);
+                    _size += chunk;
+                    text += chunk;
+                    length -= chunk;
+                }
+                return true;
+            }
+
+            bool writeText(const char *text)
+            {
+                return writeText(text, std::strlen(text));
+            }
+
+            template<typename T>
+                bool write(const T &value)
+                {
+                    return append([&](char *first, char *last) { return format(first, last, value, options); });
+                }
+
+            // value followed by a newline
+            template<typename T>
+                bool writeLine(const T &value)
+                {
+                    return append([&](char *first, char *last) {
+                        char *end = format(first, last, value, options);
+                        return detail::formatText(end, last, "\n", 1);
+                    });
+                }
+
+            // bulk mode: one value per line, e.g. a whole transform or point buffer
+            template<typename T>
+                bool writeAll(const T *values, std::size_t count)
+                {
+                    bool ok = true;
+                    for (std::size_t i = 0; i < count; i++)
+                        ok = writeLine(values[i]) && ok;
+                    return ok;
+                }
+    };
+}
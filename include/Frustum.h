@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Matrix.h"
+#include "Geometry.h"
+#include "VectorSoA.h"
+
+namespace mathlib {
+    // view frustum as six planes with normalized normals pointing inwards
+    // the tests are conservative: a volume that is reported outside is guaranteed to be invisible, volumes close
+    // to a corner of the frustum may be reported visible although they are not
+    struct Frustum {
+        enum Side {
+            Left,
+            Right,
+            Bottom,
+            Top,
+            Near,
+            Far
+        };
+
+        Planef planes[6];
+
+        Frustum() = default;
+
+        // extract the planes of the clip volume -w <= x, y, z <= w of any clip matrix, e.g.
+        // createPerspectiveProjection(...) * view; with a model matrix appended the planes are in model space
+        explicit Frustum(const Matrix4 &clip);
+
+        bool contains(const Vector3 &point) const;
+        bool intersects(const Spheref &sphere) const;
+        bool intersects(const AABBf &box) const;
+    };
+
+    // batched culling of bounds stored as structure of arrays; large batches are split across ThreadPool::global()
+    // the mask overloads set visible[i] to 1 or 0, the index overloads write the indices of the visible volumes
+    // in ascending order into indices, which must have room for every volume; both return the number of visible volumes
+
+    // spheres with centers[i] and radii[i]
+    std::size_t cullSpheres(const Frustum &frustum, const VectorSoA<3, float> &centers, const float *radii, unsigned char *visible);
+    std::size_t cullSpheres(const Frustum &frustum, const VectorSoA<3, float> &centers, const float *radii, std::uint32_t *indices);
+
+    // boxes from mins[i] to maxs[i]
+    std::size_t cullBoxes(const Frustum &frustum, const VectorSoA<3, float> &mins, const VectorSoA<3, float> &maxs, unsigned char *visible);
+    std::size_t cullBoxes(const Frustum &frustum, const VectorSoA<3, float> &mins, const VectorSoA<3, float> &maxs, std::uint32_t *indices);
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "Instrumentation.h"
+
+namespace mathlib {
+    namespace detail {
+        // tiles of at most this many elements per side are copied with a plain double loop
+        constexpr int transposeTile = 32;
+    }
+
+    // b(i, j) = a(i, j) for rows x cols strided operands (see gemm), e.g. a change of storage order or, with
+    // the strides of one side swapped, an out-of-place transpose
+    // cache-oblivious: the larger dimension is halved until the tile fits, so reads and writes both stay in
+    // cache whatever the strides are; a and b must not overlap
+    template<typename vtype>
+        void copyStrided(int rows, int cols, const vtype *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                vtype *b, std::ptrdiff_t rsb, std::ptrdiff_t csb)
+        {
+            if (rows <= detail::transposeTile && cols <= detail::transposeTile) {
+                for (int i = 0; i < rows; i++)
+                    for (int j = 0; j < cols; j++)
+                        b[i * rsb + j * csb] = a[i * rsa + j * csa];
+                return;
+            }
+
+            if (rows >= cols) {
+                const int half = rows / 2;
+                copyStrided(half, cols, a, rsa, csa, b, rsb, csb);
+                copyStrided(rows - half, cols, a + half * rsa, rsa, csa, b + half * rsb, rsb, csb);
+            } else {
+                const int half = cols / 2;
+                copyStrided(rows, half, a, rsa, csa, b, rsb, csb);
+                copyStrided(rows, cols - half, a + half * csa, rsa, csa, b + half * csb, rsb, csb);
+            }
+        }
+
+    // transpose the square n x n matrix a in place, tile by tile: diagonal tiles are transposed in place,
+    // every tile above the diagonal is swapped with the transpose of its mirror below
+    template<typename vtype>
+        void transposeSquare(int n, vtype *a, std::ptrdiff_t rsa, std::ptrdiff_t csa)
+        {
+            constexpr int tile = detail::transposeTile;
+            for (int bi = 0; bi < n; bi += tile) {
+                const int iEnd = (bi + tile < n) ? bi + tile : n;
+                for (int bj = bi; bj < n; bj += tile) {
+                    const int jEnd = (bj + tile < n) ? bj + tile : n;
+                    for (int i = bi; i < iEnd; i++) {
+                        for (int j = (bi == bj) ? i + 1 : bj; j < jEnd; j++) {
+                            vtype &upper = a[i * rsa + j * csa];
+                            vtype &lower = a[j * rsa + i * csa];
+                            const vtype value = upper;
+                            upper = lower;
+                            lower = value;
+                        }
+                    }
+                }
+            }
+        }
+
+    // general matrix multiply c = alpha * a * b + beta * c with a: m x k, b: k x n, c: m x n
+    // the operands are strided, element (i, j) of a lives at a[i * rsa + j * csa], so both
+    // row-major (rs = cols, cs = 1) and column-major (rs = 1, cs = rows) storage is accepted
+    // c must not alias a or b; with beta == 0 the previous contents of c are never read
+    //
+    // float and double use the cache-blocked, register-tiled simd kernel compiled into the library,
+    // large products are split across ThreadPool::global()
+    void gemm(int m, int n, int k,
+            float alpha, const float *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+            const float *b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+            float beta, float *c, std::ptrdiff_t rsc, std::ptrdiff_t csc);
+
+    void gemm(int m, int n, int k,
+            double alpha, const double *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+            const double *b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+            double beta, double *c, std::ptrdiff_t rsc, std::ptrdiff_t csc);
+
+    // reference loop for every other element type
+    template<typename vtype>
+        void gemm(int m, int n, int k,
+                vtype alpha, const vtype *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                const vtype *b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+                vtype beta, vtype *c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+        {
+            MATHLIB_TIME(Gemm, static_cast<std::uint64_t>(m) * n * k);
+            for (int i = 0; i < m; i++) {
+                for (int j = 0; j < n; j++) {
+                    vtype sum = 0;
+                    for (int p = 0; p < k; p++)
+                        sum += a[i * rsa + p * csa] * b[p * rsb + j * csb];
+
+                    vtype &dst = c[i * rsc + j * csc];
+                    dst = (beta == vtype(0)) ? alpha * sum : alpha * sum + beta * dst;
+                }
+            }
+        }
+
+    // general matrix-vector multiply y = alpha * a * x + beta * y with a: m x n strided as in gemm
+    // y must not alias a or x; with beta == 0 the previous contents of y are never read
+    void gemv(int m, int n,
+            float alpha, const float *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+            const float *x, float beta, float *y);
+
+    void gemv(int m, int n,
+            double alpha, const double *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+            const double *x, double beta, double *y);
+
+    template<typename vtype>
+        void gemv(int m, int n,
+                vtype alpha, const vtype *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                const vtype *x, vtype beta, vtype *y)
+        {
+            MATHLIB_TIME(Gemv, static_cast<std::uint64_t>(m) * n);
+            for (int i = 0; i < m; i++) {
+                vtype sum = 0;
+                for (int j = 0; j < n; j++)
+                    sum += a[i * rsa + j * csa] * x[j];
+                y[i] = (beta == vtype(0)) ? alpha * sum : alpha * sum + beta * y[i];
+            }
+        }
+
+    // c = a * b for square n x n operands strided as in gemm, by strassen-winograd recursion: every level
+    // replaces one product by 7 half-size products and 15 additions, below cutoff gemm takes over
+    // sizes that do not halve evenly down to the cutoff are zero-padded once up front
+    // the error bound grows with the number of levels, so results differ from gemm in the last bits;
+    // c must not alias a or b
+    // with the blocked gemm strassen starts to win at n = 1024, see the parallel bench
+    constexpr int strassenCutoff = 512;
+
+    void strassen(int n, const float *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+            const float *b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+            float *c, std::ptrdiff_t rsc, std::ptrdiff_t csc, int cutoff = strassenCutoff);
+
+    void strassen(int n, const double *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+            const double *b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+            double *c, std::ptrdiff_t rsc, std::ptrdiff_t csc, int cutoff = strassenCutoff);
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+
+#include "Vector.h"
+#include "EquationSolving.h"
+
+namespace mathlib {
+    // geometric primitives in 3d and their ray intersection tests
+    // the scalar tests are header-only templates, the packet tests below run several rays at once
+
+    template<typename vtype = float>
+        struct Ray {
+            Vector<3, vtype> origin;
+            // does not have to be normalized, hit distances are in multiples of it
+            Vector<3, vtype> direction;
+
+            constexpr Ray() = default;
+
+            constexpr Ray(const Vector<3, vtype> &origin, const Vector<3, vtype> &direction)
+                : origin(origin), direction(direction) {}
+
+            constexpr Vector<3, vtype> at(vtype t) const
+            {
+                return origin + direction * t;
+            }
+        };
+
+    template<typename vtype = float>
+        struct Sphere {
+            Vector<3, vtype> center;
+            vtype radius = 0;
+
+            constexpr Sphere() = default;
+
+            constexpr Sphere(const Vector<3, vtype> &center, vtype radius)
+                : center(center), radius(radius) {}
+
+            constexpr bool contains(const Vector<3, vtype> &point) const
+            {
+                return (point - center).getLengthSquared() <= radius * radius;
+            }
+        };
+
+    // axis-aligned box, the default constructed box is empty and grows with extend()
+    template<typename vtype = float>
+        struct AABB {
+            Vector<3, vtype> min = Vector<3, vtype>(std::numeric_limits<vtype>::max(), std::numeric_limits<vtype>::max(), std::numeric_limits<vtype>::max());
+            Vector<3, vtype> max = Vector<3, vtype>(std::numeric_limits<vtype>::lowest(), std::numeric_limits<vtype>::lowest(), std::numeric_limits<vtype>::lowest());
+
+            constexpr AABB() = default;
+
+            constexpr AABB(const Vector<3, vtype> &min, const Vector<3, vtype> &max)
+                : min(min), max(max) {}
+
+            constexpr bool isEmpty() const
+            {
+                return min[0] > max[0] || min[1] > max[1] || min[2] > max[2];
+            }
+
+            constexpr bool contains(const Vector<3, vtype> &point) const
+            {
+                for (int n = 0; n < 3; n++)
+                    if (point[n] < min[n] || point[n] > max[n])
+                        return false;
+                return true;
+            }
+
+            constexpr void extend(const Vector<3, vtype> &point)
+            {
+                for (int n = 0; n < 3; n++) {
+                    min[n] = std::min(min[n], point[n]);
+                    max[n] = std::max(max[n], point[n]);
+                }
+            }
+
+            constexpr void extend(const AABB &other)
+            {
+                for (int n = 0; n < 3; n++) {
+                    min[n] = std::min(min[n], other.min[n]);
+                    max[n] = std::max(max[n], other.max[n]);
+                }
+            }
+
+            constexpr Vector<3, vtype> getCenter() const
+            {
+                return (min + max) / vtype(2);
+            }
+
+            constexpr Vector<3, vtype> getSize() const
+            {
+                return max - min;
+            }
+        };
+
+    // the points x with normal.dot(x) + distance == 0, the normal points to the positive side
+    template<typename vtype = float>
+        struct Plane {
+            Vector<3, vtype> normal;
+            vtype distance = 0;
+
+            constexpr Plane() = default;
+
+            constexpr Plane(const Vector<3, vtype> &normal, vtype distance)
+                : normal(normal), distance(distance) {}
+
+            // plane through point
+            constexpr Plane(const Vector<3, vtype> &normal, const Vector<3, vtype> &point)
+                : normal(normal), distance(-normal.dot(point)) {}
+
+            // signed distance in multiples of the length of normal
+            constexpr vtype getSignedDistance(const Vector<3, vtype> &point) const
+            {
+                return normal.dot(point) + distance;
+            }
+
+            // scale to a unit normal so that getSignedDistance() returns euclidean distances
+            void normalize()
+            {
+                const vtype length = normal.getLength();
+                normal = normal / length;
+                distance /= length;
+            }
+        };
+
+    template<typename vtype = float>
+        struct Triangle {
+            Vector<3, vtype> a;
+            Vector<3, vtype> b;
+            Vector<3, vtype> c;
+
+            constexpr Triangle() = default;
+
+            constexpr Triangle(const Vector<3, vtype> &a, const Vector<3, vtype> &b, const Vector<3, vtype> &c)
+                : a(a), b(b), c(c) {}
+
+            // not normalized, counter-clockwise winding faces the normal
+            constexpr Vector<3, vtype> getNormal() const
+            {
+                return (b - a).cross(c - a);
+            }
+        };
+
+    using Rayf = Ray<float>;
+    using Rayd = Ray<double>;
+    using Spheref = Sphere<float>;
+    using Sphered = Sphere<double>;
+    using AABBf = AABB<float>;
+    using AABBd = AABB<double>;
+    using Planef = Plane<float>;
+    using Planed = Plane<double>;
+    using Trianglef = Triangle<float>;
+    using Triangled = Triangle<double>;
+
+    // the scalar tests return true if the ray hits at a distance t >= 0 and write the nearest such t
+
+    template<typename vtype>
+        bool intersect(const Ray<vtype> &ray, const Sphere<vtype> &sphere, vtype &t)
+        {
+            const Vector<3, vtype> oc = ray.origin - sphere.center;
+            double t0, t1;
+            if (!solveQuadratic(ray.direction.dot(ray.direction), 2 * ray.direction.dot(oc),
+                        oc.dot(oc) - sphere.radius * sphere.radius, t0, t1))
+                return false;
+            // inside the sphere only the far root lies in front of the origin
+            if (t0 < 0)
+                t0 = t1;
+            if (t0 < 0)
+                return false;
+            t = static_cast<vtype>(t0);
+            return true;
+        }
+
+    // slab test, t is 0 if the origin lies inside the box
+    template<typename vtype>
+        bool intersect(const Ray<vtype> &ray, const AABB<vtype> &box, vtype &t)
+        {
+            vtype tNear = 0;
+            vtype tFar = std::numeric_limits<vtype>::infinity();
+            for (int n = 0; n < 3; n++) {
+                const vtype inverse = vtype(1) / ray.direction[n];
+                const vtype t0 = (box.min[n] - ray.origin[n]) * inverse;
+                const vtype t1 = (box.max[n] - ray.origin[n]) * inverse;
+                tNear = std::max(tNear, std::min(t0, t1));
+                tFar = std::min(tFar, std::max(t0, t1));
+            }
+            if (tNear > tFar)
+                return false;
+            t = tNear;
+            return true;
+        }
+
+    // rays parallel to the plane never hit, not even when they lie in it
+    template<typename vtype>
+        bool intersect(const Ray<vtype> &ray, const Plane<vtype> &plane, vtype &t)
+        {
+            const vtype denominator = plane.normal.dot(ray.direction);
+            if (denominator == 0)
+                return false;
+            const vtype hit = -plane.getSignedDistance(ray.origin) / denominator;
+            if (!(hit >= 0))
+                return false;
+            t = hit;
+            return true;
+        }
+
+    // möller-trumbore, both windings hit; u and v are the barycentric weights of b and c
+    template<typename vtype>
+        bool intersect(const Ray<vtype> &ray, const Triangle<vtype> &triangle, vtype &t, vtype &u, vtype &v)
+        {
+            const Vector<3, vtype> edge1 = triangle.b - triangle.a;
+            const Vector<3, vtype> edge2 = triangle.c - triangle.a;
+            const Vector<3, vtype> p = ray.direction.cross(edge2);
+            const vtype determinant = edge1.dot(p);
+            // parallel to the plane of the triangle
+            if (determinant == 0)
+                return false;
+
+            const vtype inverse = vtype(1) / determinant;
+            const Vector<3, vtype> s = ray.origin - triangle.a;
+            const vtype hitU = s.dot(p) * inverse;
+            const Vector<3, vtype> q = s.cross(edge1);
+            const vtype hitV = ray.direction.dot(q) * inverse;
+            const vtype hit = edge2.dot(q) * inverse;
+            if (!(hitU >= 0 && hitV >= 0 && hitU + hitV <= 1 && hit >= 0))
+                return false;
+
+            t = hit;
+            u = hitU;
+            v = hitV;
+            return true;
+        }
+
+    template<typename vtype>
+        bool intersect(const Ray<vtype> &ray, const Triangle<vtype> &triangle, vtype &t)
+        {
+            vtype u, v;
+            return intersect(ray, triangle, t, u, v);
+        }
+
+    // structure-of-arrays packet of width float rays for packet traversal
+    // every lane carries its own tMax, the distance of the closest hit found so far; the packet tests only
+    // report hits in [0, tMax) and the primitive tests shrink tMax of the lanes they hit
+    // masks have bit i set for lane i, lanes outside the active mask are never tested nor modified
+    template<int width>
+        struct alignas(64) RayPacket {
+            static_assert(width == 4 || width == 8 || width == 16, "ray packets hold 4, 8 or 16 rays");
+
+            static constexpr std::uint32_t allLanes = (std::uint32_t(1) << width) - 1;
+
+            float originX[width];
+            float originY[width];
+            float originZ[width];
+            float directionX[width];
+            float directionY[width];
+            float directionZ[width];
+            // 1 / direction, precomputed for the slab test
+            float inverseX[width];
+            float inverseY[width];
+            float inverseZ[width];
+            float tMax[width];
+
+            RayPacket()
+            {
+                for (int i = 0; i < width; i++)
+                    set(i, Rayf(Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f)));
+            }
+
+            void set(int lane, const Rayf &ray, float maxDistance = std::numeric_limits<float>::infinity())
+            {
+                originX[lane] = ray.origin[0];
+                originY[lane] = ray.origin[1];
+                originZ[lane] = ray.origin[2];
+                directionX[lane] = ray.direction[0];
+                directionY[lane] = ray.direction[1];
+                directionZ[lane] = ray.direction[2];
+                inverseX[lane] = 1.0f / ray.direction[0];
+                inverseY[lane] = 1.0f / ray.direction[1];
+                inverseZ[lane] = 1.0f / ray.direction[2];
+                tMax[lane] = maxDistance;
+            }
+
+            Rayf get(int lane) const
+            {
+                return Rayf(Vector3(originX[lane], originY[lane], originZ[lane]), Vector3(directionX[lane], directionY[lane], directionZ[lane]));
+            }
+        };
+
+    using RayPacket4 = RayPacket<4>;
+    using RayPacket8 = RayPacket<8>;
+    using RayPacket16 = RayPacket<16>;
+
+    // returns the active lanes whose ray enters the box no later than tMax, tMax is not modified
+    std::uint32_t intersect(const RayPacket4 &packet, const AABBf &box, std::uint32_t active = RayPacket4::allLanes);
+    std::uint32_t intersect(const RayPacket8 &packet, const AABBf &box, std::uint32_t active = RayPacket8::allLanes);
+    std::uint32_t intersect(const RayPacket16 &packet, const AABBf &box, std::uint32_t active = RayPacket16::allLanes);
+
+    // return the active lanes that hit closer than tMax and set their tMax to the hit distance
+    std::uint32_t intersect(RayPacket4 &packet, const Spheref &sphere, std::uint32_t active = RayPacket4::allLanes);
+    std::uint32_t intersect(RayPacket8 &packet, const Spheref &sphere, std::uint32_t active = RayPacket8::allLanes);
+    std::uint32_t intersect(RayPacket16 &packet, const Spheref &sphere, std::uint32_t active = RayPacket16::allLanes);
+
+    std::uint32_t intersect(RayPacket4 &packet, const Trianglef &triangle, std::uint32_t active = RayPacket4::allLanes);
+    std::uint32_t intersect(RayPacket8 &packet, const Trianglef &triangle, std::uint32_t active = RayPacket8::allLanes);
+    std::uint32_t intersect(RayPacket16 &packet, const Trianglef &triangle, std::uint32_t active = RayPacket16::allLanes);
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#include "Simd.h"
+#include "Matrix.h"
+#include "Vector.h"
+
+namespace mathlib {
+    // reduced precision storage types for vertex data, normals and other bandwidth-bound arrays
+    // every type converts implicitly from and to float, so it can be used as vtype of Vector and Matrix:
+    // arithmetic is done in float and rounded back on every store
+    // whole arrays should be converted with the pack/unpack functions below instead of element by element
+
+    namespace detail {
+        inline std::uint32_t floatBits(float value)
+        {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        inline float bitsToFloat(std::uint32_t bits)
+        {
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        // ieee binary16 with round to nearest even, overflow to infinity and nan preserved
+        inline std::uint16_t floatToHalf(float value)
+        {
+#if defined(MATHLIB_F16C)
+            return static_cast<std::uint16_t>(_cvtss_sh(value, _MM_FROUND_TO_NEAREST_INT));
+#else
+            std::uint32_t bits = floatBits(value);
+            const std::uint32_t sign = bits & 0x80000000u;
+            bits ^= sign;
+
+            std::uint32_t result;
+            if (bits >= 0x47800000u) {
+                // too large for a half or infinity; nan stays quiet and keeps the top of its payload like f16c
+                result = (bits > 0x7f800000u) ? 0x7e00u | ((bits >> 13) & 0x3ffu) : 0x7c00u;
+            } else if (bits < 0x38800000u) {
+                // subnormal half or zero: adding 0.5f aligns the mantissa so that the fpu does the rounding
+                result = floatBits(bitsToFloat(bits) + 0.5f) - 0x3f000000u;
+            } else {
+                // rebias the exponent and round the 13 dropped mantissa bits to nearest even
+                const std::uint32_t odd = (bits >> 13) & 1;
+                result = (bits + 0xc8000fffu + odd) >> 13;
+            }
+            return static_cast<std::uint16_t>(result | (sign >> 16));
+#endif
+        }
+
+        inline float halfToFloat(std::uint16_t half)
+        {
+#if defined(MATHLIB_F16C)
+            return _cvtsh_ss(half);
+#else
+            const std::uint32_t exponentMask = 0x7c00u << 13;
+            std::uint32_t bits = (half & 0x7fffu) << 13;
+            const std::uint32_t exponent = bits & exponentMask;
+            bits += (127 - 15) << 23;
+
+            if (exponent == exponentMask) {
+                // infinity or nan
+                bits += (128 - 16) << 23;
+            } else if (exponent == 0) {
+                // zero or subnormal, renormalized by the fpu
+                bits += 1 << 23;
+                bits = floatBits(bitsToFloat(bits) - bitsToFloat(113u << 23));
+            }
+            return bitsToFloat(bits | (static_cast<std::uint32_t>(half & 0x8000u) << 16));
+#endif
+        }
+    }
+
+    // 16-bit ieee float: 11 significant bits, range +-65504
+    class Half {
+        private:
+            std::uint16_t _bits = 0;
+
+        public:
+            constexpr Half() = default;
+
+            Half(float value)
+                : _bits(detail::floatToHalf(value)) {}
+
+            operator float() const
+            {
+                return detail::halfToFloat(_bits);
+            }
+
+            static constexpr Half fromBits(std::uint16_t bits)
+            {
+                Half result;
+                result._bits = bits;
+                return result;
+            }
+
+            constexpr std::uint16_t bits() const
+            {
+                return _bits;
+            }
+
+            Half &operator+=(float other) { return *this = float(*this) + other; }
+            Half &operator-=(float other) { return *this = float(*this) - other; }
+            Half &operator*=(float other) { return *this = float(*this) * other; }
+            Half &operator/=(float other) { return *this = float(*this) / other; }
+    };
+
+    // signed normalized 16-bit integer for values in [-1, 1], e.g. unit normals and tangents
+    // values outside the range are clamped, steps are 1 / 32767, nan converts to an unspecified value
+    class Snorm16 {
+        private:
+            std::int16_t _bits = 0;
+
+        public:
+            static constexpr float scale = 32767.0f;
+
+            constexpr Snorm16() = default;
+
+            Snorm16(float value)
+                : _bits(static_cast<std::int16_t>(std::lrint(std::clamp(value, -1.0f, 1.0f) * scale))) {}
+
+            operator float() const
+            {
+                return static_cast<float>(_bits) / scale;
+            }
+
+            static constexpr Snorm16 fromBits(std::int16_t bits)
+            {
+                Snorm16 result;
+                result._bits = bits;
+                return result;
+            }
+
+            constexpr std::int16_t bits() const
+            {
+                return _bits;
+            }
+
+            Snorm16 &operator+=(float other) { return *this = float(*this) + other; }
+            Snorm16 &operator-=(float other) { return *this = float(*this) - other; }
+            Snorm16 &operator*=(float other) { return *this = float(*this) * other; }
+            Snorm16 &operator/=(float other) { return *this = float(*this) / other; }
+    };
+
+    // unsigned normalized 8-bit integer for values in [0, 1], e.g. colors and blend weights
+    // values outside the range are clamped, steps are 1 / 255, nan converts to an unspecified value
+    class Unorm8 {
+        private:
+            std::uint8_t _bits = 0;
+
+        public:
+            static constexpr float scale = 255.0f;
+
+            constexpr Unorm8() = default;
+
+            Unorm8(float value)
+                : _bits(static_cast<std::uint8_t>(std::lrint(std::clamp(value, 0.0f, 1.0f) * scale))) {}
+
+            operator float() const
+            {
+                return static_cast<float>(_bits) / scale;
+            }
+
+            static constexpr Unorm8 fromBits(std::uint8_t bits)
+            {
+                Unorm8 result;
+                result._bits = bits;
+                return result;
+            }
+
+            constexpr std::uint8_t bits() const
+            {
+                return _bits;
+            }
+
+            Unorm8 &operator+=(float other) { return *this = float(*this) + other; }
+            Unorm8 &operator-=(float other) { return *this = float(*this) - other; }
+            Unorm8 &operator*=(float other) { return *this = float(*this) * other; }
+            Unorm8 &operator/=(float other) { return *this = float(*this) / other; }
+    };
+
+    static_assert(sizeof(Half) == 2 && sizeof(Snorm16) == 2 && sizeof(Unorm8) == 1, "storage types must not be padded");
+
+    using Vector2h = Vector<2, Half>;
+    using Vector3h = Vector<3, Half>;
+    using Vector4h = Vector<4, Half>;
+    using Matrix4h = Matrix<4, 4, Half>;
+
+    // bulk conversions between float arrays and the storage types, with the same rounding as the scalar
+    // conversions; half uses f16c when MATHLIB_F16C is defined and integer sse2 otherwise, the normalized types use sse2
+    void pack(const float *in, Half *out, std::size_t count);
+    void unpack(const Half *in, float *out, std::size_t count);
+    void pack(const float *in, Snorm16 *out, std::size_t count);
+    void unpack(const Snorm16 *in, float *out, std::size_t count);
+    void pack(const float *in, Unorm8 *out, std::size_t count);
+    void unpack(const Unorm8 *in, float *out, std::size_t count);
+
+    // the same for arrays of vectors and matrices, e.g. Vector3 normals into Vector<3, Snorm16>
+    template<int dim, typename T>
+        void pack(const Vector<dim, float> *in, Vector<dim, T> *out, std::size_t count)
+        {
+            static_assert(sizeof(Vector<dim, float>) == dim * sizeof(float) && sizeof(Vector<dim, T>) == dim * sizeof(T), "vector types must be packed");
+            pack(reinterpret_cast<const float*>(in), reinterpret_cast<T*>(out), count * dim);
+        }
+
+    template<int dim, typename T>
+        void unpack(const Vector<dim, T> *in, Vector<dim, float> *out, std::size_t count)
+        {
+            static_assert(sizeof(Vector<dim, float>) == dim * sizeof(float) && sizeof(Vector<dim, T>) == dim * sizeof(T), "vector types must be packed");
+            unpack(reinterpret_cast<const T*>(in), reinterpret_cast<float*>(out), count * dim);
+        }
+
+    template<int rows, int cols, typename T>
+        void pack(const Matrix<rows, cols, float> *in, Matrix<rows, cols, T> *out, std::size_t count)
+        {
+            static_assert(sizeof(Matrix<rows, cols, T>) == rows * cols * sizeof(T), "matrix types must be packed");
+            pack(reinterpret_cast<const float*>(in), reinterpret_cast<T*>(out), count * rows * cols);
+        }
+
+    template<int rows, int cols, typename T>
+        void unpack(const Matrix<rows, cols, T> *in, Matrix<rows, cols, float> *out, std::size_t count)
+        {
+            static_assert(sizeof(Matrix<rows, cols, T>) == rows * cols * sizeof(T), "matrix types must be packed");
+            unpack(reinterpret_cast<const T*>(in), reinterpret_cast<float*>(out), count * rows * cols);
+        }
+}
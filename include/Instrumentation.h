@@ -0,0 +1,185 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include "Format.h"
+#include "Kernels.h"
+
+// operation counters and timers for the library's own operations, switched at compile time:
+// with MATHLIB_INSTRUMENTATION defined (cmake option MATHLIB_ENABLE_INSTRUMENTATION, which defines it for the
+// library and everything that links against it) every instrumented operation counts its calls and items in
+// lock-free counters of the calling thread, and the expensive ones also add their wall time; without it the
+// MATHLIB_COUNT and MATHLIB_TIME macros expand to nothing, so the hot paths contain no instrumentation code
+// the snapshot api below exists in both builds and reports zeros when the switch is off
+
+namespace mathlib {
+    namespace instrumentation {
+        // items is the problem size of one call as noted, nested operations (e.g. gemm inside strassen)
+        // are counted on their own as well
+        enum class Operation {
+            MatrixMultiply,             // fixed-size Matrix * Matrix, items: multiply-adds
+            MatrixVectorMultiply,       // fixed-size Matrix * Vector, items: multiply-adds
+            MatrixInverse,              // getInverse and getAffineInverse, items: 1
+            VectorNormalize,            // getNormalized and normalize, items: 1
+            SolveQuadratic,             // scalar solveQuadratic, items: 1
+            SolveQuadraticBatch,        // batched solveQuadratic, items: equations
+            Gemm,                       // items: multiply-adds
+            Gemv,                       // items: multiply-adds
+            Strassen,                   // items: multiply-adds of the classical product
+            BatchTransform,             // transform, transformPoints, transformDirections, projectPoints, items: vectors
+            CreateTRS,                  // batched createTRS, items: matrices
+            FrustumCull,                // cullSpheres and cullBoxes, items: volumes
+            RayPacketIntersect,         // packet intersect, items: rays
+            StorageConversion,          // pack and unpack, items: scalars
+            SparseMultiply,             // sparse matrix times vector, items: nonzeros
+            IterativeSolve,             // conjugateGradient and bicgstab, items: rows
+            Factorization,              // lu, cholesky and qr factor, items: matrix elements
+            EigenSymmetric3,            // 3x3 symmetric eigen-decomposition, scalar and batched, items: matrices
+            SymmetricEigen,             // SymmetricEigenDecomposition::factor, items: matrix elements
+            SingularValueDecomposition  // SingularValueDecomposition::factor, items: matrix elements
+        };
+
+        constexpr std::size_t operationCount = static_cast<std::size_t>(Operation::SingularValueDecomposition) + 1;
+
+        // stable identifier of the operation, used as key in the text and json export
+        const char *getName(Operation operation);
+
+        constexpr bool isEnabled()
+        {
+#if defined(MATHLIB_INSTRUMENTATION)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        struct OperationStats {
+            std::uint64_t calls = 0;
+            std::uint64_t items = 0;
+            // wall time of the timed operations, zero for the ones that are only counted
+            std::uint64_t nanoseconds = 0;
+        };
+
+        // totals of every operation over all threads at one point in time
+        class Snapshot {
+            private:
+                std::array<OperationStats, operationCount> _stats {};
+
+            public:
+                const OperationStats &operator[](Operation operation) const
+                {
+                    return _stats[static_cast<std::size_t>(operation)];
+                }
+
+                OperationStats &operator[](Operation operation)
+                {
+                    return _stats[static_cast<std::size_t>(operation)];
+                }
+
+                // what happened between earlier and this snapshot, e.g. within one frame or request
+                Snapshot operator-(const Snapshot &earlier) const
+                {
+                    Snapshot result;
+                    for (std::size_t i = 0; i < operationCount; i++) {
+                        result._stats[i].calls = _stats[i].calls - earlier._stats[i].calls;
+                        result._stats[i].items = _stats[i].items - earlier._stats[i].items;
+                        result._stats[i].nanoseconds = _stats[i].nanoseconds - earlier._stats[i].nanoseconds;
+                    }
+                    return result;
+                }
+
+                // one line per operation that was called: name, calls, items and milliseconds
+                bool writeText(FormatWriter &writer) const;
+
+                // {"enabled": b, "operations": {"name": {"calls": c, "items": i, "nanoseconds": t}, ...}}, every operation listed
+                bool writeJson(FormatWriter &writer) const;
+        };
+
+        // sum of the counters of all running and finished threads since the last reset; may be called from
+        // any thread at any time, operations in flight on other threads may or may not be included
+        Snapshot takeSnapshot();
+
+        // start counting from zero again; the counters themselves are only ever written by their own thread,
+        // so this records the current totals as the baseline that takeSnapshot subtracts
+        void reset();
+
+        namespace detail {
+            // counters of one thread; only the owning thread writes, so a relaxed load and store replaces
+            // the read-modify-write, and takeSnapshot reads them with relaxed loads
+            struct ThreadCounters {
+                std::atomic<std::uint64_t> calls[operationCount] {};
+                std::atomic<std::uint64_t> items[operationCount] {};
+                std::atomic<std::uint64_t> nanoseconds[operationCount] {};
+
+                ThreadCounters();
+                ~ThreadCounters();
+
+                ThreadCounters(const ThreadCounters &other) = delete;
+                ThreadCounters &operator=(const ThreadCounters &other) = delete;
+            };
+
+            // the counters of the calling thread, registered on first use
+            ThreadCounters &threadCounters();
+
+            inline void increment(std::atomic<std::uint64_t> &counter, std::uint64_t value)
+            {
+                counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            }
+
+            inline void count(Operation operation, std::uint64_t items)
+            {
+                ThreadCounters &counters = threadCounters();
+                const std::size_t index = static_cast<std::size_t>(operation);
+                increment(counters.calls[index], 1);
+                increment(counters.items[index], items);
+            }
+
+            // counts on construction and adds the elapsed time on destruction
+            class ScopedTimer {
+                private:
+                    using Clock = std::chrono::steady_clock;
+
+                    Operation _operation;
+                    Clock::time_point _start;
+
+                public:
+                    ScopedTimer(Operation operation, std::uint64_t items)
+                        : _operation(operation)
+                    {
+                        count(operation, items);
+                        _start = Clock::now();
+                    }
+
+                    ~ScopedTimer()
+                    {
+                        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _start).count();
+                        increment(threadCounters().nanoseconds[static_cast<std::size_t>(_operation)], static_cast<std::uint64_t>(elapsed));
+                    }
+
+                    ScopedTimer(const ScopedTimer &other) = delete;
+                    ScopedTimer &operator=(const ScopedTimer &other) = delete;
+            };
+        }
+    }
+}
+
+// MATHLIB_COUNT(Operation, items) counts one call, also inside constexpr functions (skipped during constant
+// evaluation); MATHLIB_TIME(Operation, items) counts one call and times the rest of the enclosing scope,
+// it declares a variable and can not be used in constexpr functions; operation is an enumerator name of
+// instrumentation::Operation and items is not evaluated when instrumentation is off
+#if defined(MATHLIB_INSTRUMENTATION)
+#define MATHLIB_COUNT(operation, items) \
+    do { \
+        if (!::mathlib::detail::isConstantEvaluated()) \
+            ::mathlib::instrumentation::detail::count(::mathlib::instrumentation::Operation::operation, static_cast<std::uint64_t>(items)); \
+    } while (false)
+#define MATHLIB_TIME(operation, items) \
+    const ::mathlib::instrumentation::detail::ScopedTimer mathlibScopedTimer(::mathlib::instrumentation::Operation::operation, static_cast<std::uint64_t>(items))
+#else
+#define MATHLIB_COUNT(operation, items) ((void)0)
+#define MATHLIB_TIME(operation, items) ((void)0)
+#endif
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace mathlib {
+    namespace detail {
+        // determinants and inverses of n x n matrices in contiguous row-major storage
+        // 2x2, 3x3 and 4x4 use straight-line cofactor expansions without branches,
+        // larger sizes an lu decomposition with partial pivoting
+
+        template<typename vtype>
+            bool isInvertible(vtype det)
+            {
+                return det != vtype(0) && std::isfinite(vtype(1) / det);
+            }
+
+        // factor a in place into l * u with row permutation perm, returns the determinant
+        // (zero if a pivot vanishes)
+        template<int n, typename vtype>
+            vtype luDecompose(vtype *a, std::array<int, n> &perm)
+            {
+                vtype det = 1;
+                for (int i = 0; i < n; i++)
+                    perm[i] = i;
+
+                for (int k = 0; k < n; k++) {
+                    int pivot = k;
+                    for (int i = k + 1; i < n; i++)
+                        if (std::abs(a[i * n + k]) > std::abs(a[pivot * n + k]))
+                            pivot = i;
+
+                    if (a[pivot * n + k] == vtype(0))
+                        return 0;
+
+                    if (pivot != k) {
+                        for (int j = 0; j < n; j++)
+                            std::swap(a[k * n + j], a[pivot * n + j]);
+                        std::swap(perm[k], perm[pivot]);
+                        det = -det;
+                    }
+
+                    det *= a[k * n + k];
+                    const vtype inv = vtype(1) / a[k * n + k];
+                    for (int i = k + 1; i < n; i++) {
+                        const vtype factor = a[i * n + k] * inv;
+                        a[i * n + k] = factor;
+                        for (int j = k + 1; j < n; j++)
+                            a[i * n + j] -= factor * a[k * n + j];
+                    }
+                }
+                return det;
+            }
+
+        // constexpr up to 4x4, larger sizes go through the lu decomposition
+        template<int n, typename vtype>
+            constexpr vtype determinant(const vtype *a)
+            {
+                if constexpr (n == 1) {
+                    return a[0];
+                } else if constexpr (n == 2) {
+                    return a[0] * a[3] - a[1] * a[2];
+                } else if constexpr (n == 3) {
+                    return a[0] * (a[4] * a[8] - a[5] * a[7])
+                        - a[1] * (a[3] * a[8] - a[5] * a[6])
+                        + a[2] * (a[3] * a[7] - a[4] * a[6]);
+                } else if constexpr (n == 4) {
+                    const vtype s0 = a[0] * a[5] - a[4] * a[1];
+                    const vtype s1 = a[0] * a[6] - a[4] * a[2];
+                    const vtype s2 = a[0] * a[7] - a[4] * a[3];
+                    const vtype s3 = a[1] * a[6] - a[5] * a[2];
+                    const vtype s4 = a[1] * a[7] - a[5] * a[3];
+                    const vtype s5 = a[2] * a[7] - a[6] * a[3];
+                    const vtype c5 = a[10] * a[15] - a[14] * a[11];
+                    const vtype c4 = a[9] * a[15] - a[13] * a[11];
+                    const vtype c3 = a[9] * a[14] - a[13] * a[10];
+                    const vtype c2 = a[8] * a[15] - a[12] * a[11];
+                    const vtype c1 = a[8] * a[14] - a[12] * a[10];
+                    const vtype c0 = a[8] * a[13] - a[12] * a[9];
+                    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+                } else {
+                    std::array<vtype, n * n> lu;
+                    for (int i = 0; i < n * n; i++)
+                        lu[i] = a[i];
+                    std::array<int, n> perm;
+                    return luDecompose<n>(lu.data(), perm);
+                }
+            }
+
+        // r = a^-1, returns false and zeroes r if a is singular
+        template<int n, typename vtype>
+            bool invert(const vtype *a, vtype *r)
+            {
+                vtype det;
+                if constexpr (n == 1) {
+                    det = a[0];
+                    r[0] = vtype(1) / det;
+                } else if constexpr (n == 2) {
+                    det = a[0] * a[3] - a[1] * a[2];
+                    const vtype inv = vtype(1) / det;
+                    const vtype a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3];
+                    r[0] = a3 * inv;
+                    r[1] = -a1 * inv;
+                    r[2] = -a2 * inv;
+                    r[3] = a0 * inv;
+                } else if constexpr (n == 3) {
+                    // transposed cofactors
+                    const vtype c00 = a[4] * a[8] - a[5] * a[7];
+                    const vtype c01 = a[5] * a[6] - a[3] * a[8];
+                    const vtype c02 = a[3] * a[7] - a[4] * a[6];
+                    const vtype c10 = a[2] * a[7] - a[1] * a[8];
+                    const vtype c11 = a[0] * a[8] - a[2] * a[6];
+                    const vtype c12 = a[1] * a[6] - a[0] * a[7];
+                    const vtype c20 = a[1] * a[5] - a[2] * a[4];
+                    const vtype c21 = a[2] * a[3] - a[0] * a[5];
+                    const vtype c22 = a[0] * a[4] - a[1] * a[3];
+                    det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+                    const vtype inv = vtype(1) / det;
+                    r[0] = c00 * inv; r[1] = c10 * inv; r[2] = c20 * inv;
+                    r[3] = c01 * inv; r[4] = c11 * inv; r[5] = c21 * inv;
+                    r[6] = c02 * inv; r[7] = c12 * inv; r[8] = c22 * inv;
+                } else if constexpr (n == 4) {
+                    // 2x2 sub-determinants of the upper (s) and lower (c) two rows
+                    const vtype s0 = a[0] * a[5] - a[4] * a[1];
+                    const vtype s1 = a[0] * a[6] - a[4] * a[2];
+                    const vtype s2 = a[0] * a[7] - a[4] * a[3];
+                    const vtype s3 = a[1] * a[6] - a[5] * a[2];
+                    const vtype s4 = a[1] * a[7] - a[5] * a[3];
+                    const vtype s5 = a[2] * a[7] - a[6] * a[3];
+                    const vtype c5 = a[10] * a[15] - a[14] * a[11];
+                    const vtype c4 = a[9] * a[15] - a[13] * a[11];
+                    const vtype c3 = a[9] * a[14] - a[13] * a[10];
+                    const vtype c2 = a[8] * a[15] - a[12] * a[11];
+                    const vtype c1 = a[8] * a[14] - a[12] * a[10];
+                    const vtype c0 = a[8] * a[13] - a[12] * a[9];
+                    det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+                    const vtype inv = vtype(1) / det;
+
+                    std::array<vtype, 16> t;
+                    t[0] = (a[5] * c5 - a[6] * c4 + a[7] * c3) * inv;
+                    t[1] = (-a[1] * c5 + a[2] * c4 - a[3] * c3) * inv;
+                    t[2] = (a[13] * s5 - a[14] * s4 + a[15] * s3) * inv;
+                    t[3] = (-a[9] * s5 + a[10] * s4 - a[11] * s3) * inv;
+                    t[4] = (-a[4] * c5 + a[6] * c2 - a[7] * c1) * inv;
+                    t[5] = (a[0] * c5 - a[2] * c2 + a[3] * c1) * inv;
+                    t[6] = (-a[12] * s5 + a[14] * s2 - a[15] * s1) * inv;
+                    t[7] = (a[8] * s5 - a[10] * s2 + a[11] * s1) * inv;
+                    t[8] = (a[4] * c4 - a[5] * c2 + a[7] * c0) * inv;
+                    t[9] = (-a[0] * c4 + a[1] * c2 - a[3] * c0) * inv;
+                    t[10] = (a[12] * s4 - a[13] * s2 + a[15] * s0) * inv;
+                    t[11] = (-a[8] * s4 + a[9] * s2 - a[11] * s0) * inv;
+                    t[12] = (-a[4] * c3 + a[5] * c1 - a[6] * c0) * inv;
+                    t[13] = (a[0] * c3 - a[1] * c1 + a[2] * c0) * inv;
+                    t[14] = (-a[12] * s3 + a[13] * s1 - a[14] * s0) * inv;
+                    t[15] = (a[8] * s3 - a[9] * s1 + a[10] * s0) * inv;
+                    for (int i = 0; i < 16; i++)
+                        r[i] = t[i];
+                } else {
+                    std::array<vtype, n * n> lu;
+                    for (int i = 0; i < n * n; i++)
+                        lu[i] = a[i];
+                    std::array<int, n> perm;
+                    det = luDecompose<n>(lu.data(), perm);
+
+                    if (isInvertible(det)) {
+                        // solve l * u * x = p * e_col for every column of the identity
+                        for (int col = 0; col < n; col++) {
+                            std::array<vtype, n> x;
+                            for (int i = 0; i < n; i++) {
+                                vtype sum = (perm[i] == col) ? vtype(1) : vtype(0);
+                                for (int j = 0; j < i; j++)
+                                    sum -= lu[i * n + j] * x[j];
+                                x[i] = sum;
+                            }
+                            for (int i = n - 1; i >= 0; i--) {
+                                vtype sum = x[i];
+                                for (int j = i + 1; j < n; j++)
+                                    sum -= lu[i * n + j] * x[j];
+                                x[i] = sum / lu[i * n + i];
+                            }
+                            for (int i = 0; i < n; i++)
+                                r[i * n + col] = x[i];
+                        }
+                    }
+                }
+
+                if (!isInvertible(det)) {
+                    for (int i = 0; i < n * n; i++)
+                        r[i] = 0;
+                    return false;
+                }
+                return true;
+            }
+    }
+}
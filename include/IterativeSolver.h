@@ -0,0 +1,342 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+#include "Vector.h"
+#include "ThreadPool.h"
+#include "DenseVector.h"
+#include "SparseMatrix.h"
+#include "Instrumentation.h"
+
+namespace mathlib {
+    // krylov solvers for large sparse systems a * x = b, where a factorization would not fit:
+    // conjugate gradient for symmetric positive definite a, bicgstab for general square a
+    // x holds the initial guess on entry (resized to zeros if it does not match) and the solution on return
+
+    enum class Preconditioner {
+        None,
+        // scale by the inverse diagonal, cheap and effective for diagonally dominant systems
+        Jacobi
+    };
+
+    struct IterativeSolverOptions {
+        int maxIterations = 1000;
+        // stop once |b - a * x| <= tolerance * |b|; in float the attainable residual is roughly
+        // 1e-7 times the condition number of a
+        double tolerance = 1e-8;
+        Preconditioner preconditioner = Preconditioner::Jacobi;
+    };
+
+    struct IterativeSolverResult {
+        int iterations = 0;
+        // final relative residual |b - a * x| / |b|
+        double residual = 0;
+        bool converged = false;
+    };
+
+    namespace detail {
+        // vector operations run in blocks of this many elements, one block per pool task;
+        // dot products sum per-block partials in block order, so results do not depend on the thread count
+        constexpr std::size_t solverBlock = 1 << 14;
+
+        // reductions of float vectors accumulate in double, the recursive residual updates drift badly otherwise
+        template<typename vtype>
+            using SolverSum = std::conditional_t<std::is_same_v<vtype, float>, double, vtype>;
+
+        template<typename Body>
+            void forBlocks(std::size_t count, Body body)
+            {
+                if (count <= solverBlock || ThreadPool::global().size() == 1) {
+                    body(std::size_t(0), count);
+                    return;
+                }
+                ThreadPool::global().parallelFor(0, count, solverBlock, body);
+            }
+
+        template<typename vtype, typename Body>
+            vtype sumBlocks(std::size_t count, Body body)
+            {
+                const std::size_t blocks = (count + solverBlock - 1) / solverBlock;
+                std::vector<SolverSum<vtype>> partial(blocks);
+                auto run = [&](std::size_t first, std::size_t last) {
+                    for (std::size_t block = first; block < last; block++)
+                        partial[block] = body(block * solverBlock, std::min(count, (block + 1) * solverBlock));
+                };
+
+                if (blocks <= 1 || ThreadPool::global().size() == 1)
+                    run(0, blocks);
+                else
+                    ThreadPool::global().parallelFor(0, blocks, 1, run);
+
+                SolverSum<vtype> sum = 0;
+                for (SolverSum<vtype> p : partial)
+                    sum += p;
+                return static_cast<vtype>(sum);
+            }
+
+        template<typename vtype>
+            vtype dot(const DenseVector<vtype> &a, const DenseVector<vtype> &b)
+            {
+                const vtype *pa = a.data();
+                const vtype *pb = b.data();
+                return sumBlocks<vtype>(a.size(), [=](std::size_t first, std::size_t last) {
+                    SolverSum<vtype> sum = 0;
+                    for (std::size_t i = first; i < last; i++)
+                        sum += pa[i] * pb[i];
+                    return sum;
+                });
+            }
+
+        // out = inverse diagonal * in, or a copy without preconditioning
+        template<typename vtype>
+            void precondition(const DenseVector<vtype> &inverseDiagonal, const DenseVector<vtype> &in, DenseVector<vtype> &out)
+            {
+                const vtype *d = (inverseDiagonal.size() > 0) ? inverseDiagonal.data() : nullptr;
+                const vtype *pi = in.data();
+                vtype *po = out.data();
+                forBlocks(in.size(), [=](std::size_t first, std::size_t last) {
+                    for (std::size_t i = first; i < last; i++)
+                        po[i] = (d != nullptr) ? d[i] * pi[i] : pi[i];
+                });
+            }
+
+        // empty for Preconditioner::None, zero diagonal entries are treated as one
+        template<typename vtype>
+            DenseVector<vtype> inverseDiagonal(const CsrMatrix<vtype> &a, Preconditioner preconditioner)
+            {
+                if (preconditioner == Preconditioner::None)
+                    return DenseVector<vtype>();
+
+                DenseVector<vtype> result = a.getDiagonal();
+                for (int i = 0; i < result.size(); i++)
+                    result[i] = (result[i] != vtype(0)) ? vtype(1) / result[i] : vtype(1);
+                return result;
+            }
+
+        // r = b - a * x, returns |r|
+        template<typename vtype>
+            vtype residual(const CsrMatrix<vtype> &a, const DenseVector<vtype> &b, const DenseVector<vtype> &x, DenseVector<vtype> &r)
+            {
+                a.multiply(x, r);
+                const vtype *pb = b.data();
+                vtype *pr = r.data();
+                return std::sqrt(sumBlocks<vtype>(r.size(), [=](std::size_t first, std::size_t last) {
+                    SolverSum<vtype> sum = 0;
+                    for (std::size_t i = first; i < last; i++) {
+                        pr[i] = pb[i] - pr[i];
+                        sum += pr[i] * pr[i];
+                    }
+                    return sum;
+                }));
+            }
+
+        // common setup: size x, handle b = 0, returns |b| (zero if the solve is already done)
+        template<typename vtype>
+            vtype prepare(const CsrMatrix<vtype> &a, const DenseVector<vtype> &b, DenseVector<vtype> &x, IterativeSolverResult &result)
+            {
+                assert(a.rows() == a.cols() && b.size() == a.rows());
+                if (x.size() != a.cols())
+                    x.resize(a.cols());
+
+                const vtype normB = std::sqrt(dot(b, b));
+                if (normB == vtype(0)) {
+                    x.fill(vtype(0));
+                    result.converged = true;
+                }
+                return normB;
+            }
+    }
+
+    // preconditioned conjugate gradient, a must be symmetric positive definite
+    // convergence of the recursively updated residual is confirmed against b - a * x,
+    // on a mismatch the iteration restarts from the current x with the true residual
+    template<typename vtype>
+        IterativeSolverResult conjugateGradient(const CsrMatrix<vtype> &a, const DenseVector<vtype> &b, DenseVector<vtype> &x,
+                const IterativeSolverOptions &options = IterativeSolverOptions())
+        {
+            MATHLIB_TIME(IterativeSolve, a.rows());
+            IterativeSolverResult result;
+            const vtype normB = detail::prepare(a, b, x, result);
+            if (result.converged)
+                return result;
+
+            const int n = a.rows();
+            const DenseVector<vtype> inverseDiagonal = detail::inverseDiagonal(a, options.preconditioner);
+            DenseVector<vtype> r(n), z(n), p(n), ap(n);
+
+            const vtype target = static_cast<vtype>(options.tolerance) * normB;
+            vtype normR = detail::residual(a, b, x, r);
+            while (normR > target && result.iterations < options.maxIterations) {
+                // (re)start along the preconditioned true residual
+                detail::precondition(inverseDiagonal, r, z);
+                p = z;
+                vtype rz = detail::dot(r, z);
+                const int start = result.iterations;
+
+                while (result.iterations < options.maxIterations) {
+                    a.multiply(p, ap);
+                    const vtype pap = detail::dot(p, ap);
+                    if (pap <= vtype(0))
+                        break;
+                    const vtype alpha = rz / pap;
+
+                    vtype normRecursive;
+                    {
+                        vtype *px = x.data(), *pr = r.data();
+                        const vtype *pp = p.data(), *pAp = ap.data();
+                        normRecursive = std::sqrt(detail::sumBlocks<vtype>(n, [=](std::size_t first, std::size_t last) {
+                            detail::SolverSum<vtype> sum = 0;
+                            for (std::size_t i = first; i < last; i++) {
+                                px[i] += alpha * pp[i];
+                                pr[i] -= alpha * pAp[i];
+                                sum += pr[i] * pr[i];
+                            }
+                            return sum;
+                        }));
+                    }
+                    result.iterations++;
+                    if (normRecursive <= target)
+                        break;
+
+                    detail::precondition(inverseDiagonal, r, z);
+                    const vtype rzNext = detail::dot(r, z);
+                    const vtype beta = rzNext / rz;
+                    rz = rzNext;
+
+                    vtype *pp = p.data();
+                    const vtype *pz = z.data();
+                    detail::forBlocks(n, [=](std::size_t first, std::size_t last) {
+                        for (std::size_t i = first; i < last; i++)
+                            pp[i] = pz[i] + beta * pp[i];
+                    });
+                }
+
+                const vtype previous = normR;
+                normR = detail::residual(a, b, x, r);
+                // a breakdown right after a restart, or a restart that did not help, ends the solve
+                if (result.iterations == start || (normR > target && normR >= previous && result.iterations - start <= 1))
+                    break;
+            }
+
+            result.residual = normR / normB;
+            result.converged = normR <= target;
+            return result;
+        }
+
+    // preconditioned bicgstab (van der vorst) for general square a, preconditioned from the right
+    // the recursively updated residual drifts from b - a * x on hard problems, so convergence is
+    // confirmed against the true residual; on a mismatch or a breakdown (rho or omega vanishing)
+    // the iteration restarts from the current x
+    template<typename vtype>
+        IterativeSolverResult bicgstab(const CsrMatrix<vtype> &a, const DenseVector<vtype> &b, DenseVector<vtype> &x,
+                const IterativeSolverOptions &options = IterativeSolverOptions())
+        {
+            MATHLIB_TIME(IterativeSolve, a.rows());
+            IterativeSolverResult result;
+            const vtype normB = detail::prepare(a, b, x, result);
+            if (result.converged)
+                return result;
+
+            const int n = a.rows();
+            const DenseVector<vtype> inverseDiagonal = detail::inverseDiagonal(a, options.preconditioner);
+            DenseVector<vtype> r(n), rHat(n), p(n), v(n), y(n), s(n), z(n), t(n);
+
+            const vtype target = static_cast<vtype>(options.tolerance) * normB;
+            vtype normR = detail::residual(a, b, x, r);
+            while (normR > target && result.iterations < options.maxIterations) {
+                // (re)start from the true residual
+                rHat = r;
+                p.fill(vtype(0));
+                v.fill(vtype(0));
+                vtype rho = 1, alpha = 1, omega = 1;
+                const int start = result.iterations;
+
+                while (result.iterations < options.maxIterations) {
+                    const vtype rhoNext = detail::dot(rHat, r);
+                    if (rhoNext == vtype(0))
+                        break;
+                    const vtype beta = (rhoNext / rho) * (alpha / omega);
+                    rho = rhoNext;
+
+                    {
+                        vtype *pp = p.data();
+                        const vtype *pr = r.data(), *pv = v.data();
+                        detail::forBlocks(n, [=](std::size_t first, std::size_t last) {
+                            for (std::size_t i = first; i < last; i++)
+                                pp[i] = pr[i] + beta * (pp[i] - omega * pv[i]);
+                        });
+                    }
+
+                    detail::precondition(inverseDiagonal, p, y);
+                    a.multiply(y, v);
+                    const vtype rHatV = detail::dot(rHat, v);
+                    if (rHatV == vtype(0))
+                        break;
+                    alpha = rho / rHatV;
+
+                    vtype normS;
+                    {
+                        vtype *ps = s.data();
+                        const vtype *pr = r.data(), *pv = v.data();
+                        normS = std::sqrt(detail::sumBlocks<vtype>(n, [=](std::size_t first, std::size_t last) {
+                            detail::SolverSum<vtype> sum = 0;
+                            for (std::size_t i = first; i < last; i++) {
+                                ps[i] = pr[i] - alpha * pv[i];
+                                sum += ps[i] * ps[i];
+                            }
+                            return sum;
+                        }));
+                    }
+
+                    result.iterations++;
+                    if (normS <= target) {
+                        vtype *px = x.data();
+                        const vtype *py = y.data();
+                        detail::forBlocks(n, [=](std::size_t first, std::size_t last) {
+                            for (std::size_t i = first; i < last; i++)
+                                px[i] += alpha * py[i];
+                        });
+                        break;
+                    }
+
+                    detail::precondition(inverseDiagonal, s, z);
+                    a.multiply(z, t);
+                    const vtype tt = detail::dot(t, t);
+                    omega = (tt != vtype(0)) ? detail::dot(t, s) / tt : vtype(0);
+
+                    vtype normRecursive;
+                    {
+                        vtype *px = x.data(), *pr = r.data();
+                        const vtype *py = y.data(), *pz = z.data(), *ps = s.data(), *pt = t.data();
+                        normRecursive = std::sqrt(detail::sumBlocks<vtype>(n, [=](std::size_t first, std::size_t last) {
+                            detail::SolverSum<vtype> sum = 0;
+                            for (std::size_t i = first; i < last; i++) {
+                                px[i] += alpha * py[i] + omega * pz[i];
+                                pr[i] = ps[i] - omega * pt[i];
+                                sum += pr[i] * pr[i];
+                            }
+                            return sum;
+                        }));
+                    }
+
+                    if (normRecursive <= target || omega == vtype(0))
+                        break;
+                }
+
+                const vtype previous = normR;
+                normR = detail::residual(a, b, x, r);
+                // a breakdown right after a restart, or a restart that did not help, ends the solve
+                if (result.iterations == start || (normR > target && normR >= previous && result.iterations - start <= 1))
+                    break;
+            }
+
+            result.residual = normR / normB;
+            result.converged = normR <= target;
+            return result;
+        }
+}
@@ -0,0 +1,365 @@
+#pragma once
+
+#include <cmath>
+
+#include "Simd.h"
+
+namespace mathlib {
+    namespace detail {
+        // fixed-size kernels operating on contiguous row-major storage
+        // a specialization with simd = true replaces the generic loop in Matrix/Vector;
+        // every kernel accumulates in the same order as the generic loop, so results are bit-for-bit identical
+        // as long as the compiler does not contract a * b + c in the generic loops into fma instructions, which
+        // it may do whenever fma is enabled (-mfma, -march=native); the cmake target passes -ffp-contract=off
+        // to everything that links against it, other builds need the same flag. `mathlib_bench kernels` checks it
+
+        // true while the enclosing constexpr function is evaluated at compile time,
+        // the simd kernels are skipped there since intrinsics are not usable in constant expressions
+        constexpr bool isConstantEvaluated()
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_is_constant_evaluated();
+#else
+            return false;
+#endif
+        }
+
+        template<int rows, int cols, int ocols, typename vtype>
+            struct MultiplyKernel {
+                static constexpr bool simd = false;
+            };
+
+        template<int rows, int cols, typename vtype>
+            struct TransformKernel {
+                static constexpr bool simd = false;
+            };
+
+        template<int dim, typename vtype>
+            struct DotKernel {
+                static constexpr bool simd = false;
+            };
+
+        // product of two 3x4 affine transforms with an implicit [0 0 0 1] last row
+        template<typename vtype>
+            struct AffineMultiplyKernel {
+                static constexpr bool simd = false;
+            };
+
+        // in-place square root of an array; std::sqrt is not vectorized while it may set errno
+        template<typename vtype>
+            inline void sqrtArray(vtype *values, int count)
+            {
+                for (int i = 0; i < count; i++)
+                    values[i] = std::sqrt(values[i]);
+            }
+
+#if defined(MATHLIB_SSE2)
+        template<>
+            inline void sqrtArray<float>(float *values, int count)
+            {
+                int i = 0;
+                for (; i + 4 <= count; i += 4)
+                    _mm_storeu_ps(values + i, _mm_sqrt_ps(_mm_loadu_ps(values + i)));
+                for (; i < count; i++)
+                    values[i] = std::sqrt(values[i]);
+            }
+
+        template<>
+            inline void sqrtArray<double>(double *values, int count)
+            {
+                int i = 0;
+                for (; i + 2 <= count; i += 2)
+                    _mm_storeu_pd(values + i, _mm_sqrt_pd(_mm_loadu_pd(values + i)));
+                for (; i < count; i++)
+                    values[i] = std::sqrt(values[i]);
+            }
+
+        template<>
+            struct MultiplyKernel<4, 4, 4, float> {
+                static constexpr bool simd = true;
+
+                // r = a * b, row by row as a linear combination of the rows of b
+                static void run(const float *a, const float *b, float *r)
+                {
+                    const __m128 b0 = _mm_loadu_ps(b);
+                    const __m128 b1 = _mm_loadu_ps(b + 4);
+                    const __m128 b2 = _mm_loadu_ps(b + 8);
+                    const __m128 b3 = _mm_loadu_ps(b + 12);
+
+                    for (int row = 0; row < 4; row++) {
+                        const float *ar = a + row * 4;
+                        __m128 acc = _mm_setzero_ps();
+                        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(ar[0]), b0));
+                        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(ar[1]), b1));
+                        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(ar[2]), b2));
+                        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(ar[3]), b3));
+                        _mm_storeu_ps(r + row * 4, acc);
+                    }
+                }
+            };
+
+        template<>
+            struct TransformKernel<4, 4, float> {
+                static constexpr bool simd = true;
+
+                // r = a * v as a linear combination of the columns of a
+                static void run(const float *a, const float *v, float *r)
+                {
+                    __m128 c0 = _mm_loadu_ps(a);
+                    __m128 c1 = _mm_loadu_ps(a + 4);
+                    __m128 c2 = _mm_loadu_ps(a + 8);
+                    __m128 c3 = _mm_loadu_ps(a + 12);
+                    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+                    __m128 acc = _mm_setzero_ps();
+                    acc = _mm_add_ps(acc, _mm_mul_ps(c0, _mm_set1_ps(v[0])));
+                    acc = _mm_add_ps(acc, _mm_mul_ps(c1, _mm_set1_ps(v[1])));
+                    acc = _mm_add_ps(acc, _mm_mul_ps(c2, _mm_set1_ps(v[2])));
+                    acc = _mm_add_ps(acc, _mm_mul_ps(c3, _mm_set1_ps(v[3])));
+                    _mm_storeu_ps(r, acc);
+                }
+            };
+
+        template<>
+            struct AffineMultiplyKernel<float> {
+                static constexpr bool simd = true;
+
+                // r = a * b as for the 4x4 product, the implicit last row of b only adds the translation of a
+                static void run(const float *a, const float *b, float *r)
+                {
+                    const __m128 b0 = _mm_loadu_ps(b);
+                    const __m128 b1 = _mm_loadu_ps(b + 4);
+                    const __m128 b2 = _mm_loadu_ps(b + 8);
+
+                    for (int row = 0; row < 3; row++) {
+                        const float *ar = a + row * 4;
+                        __m128 acc = _mm_setzero_ps();
+                        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(ar[0]), b0));
+                        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(ar[1]), b1));
+                        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(ar[2]), b2));
+                        acc = _mm_add_ps(acc, _mm_set_ps(ar[3], 0.f, 0.f, 0.f));
+                        _mm_storeu_ps(r + row * 4, acc);
+                    }
+                }
+            };
+
+        template<>
+            struct DotKernel<4, float> {
+                static constexpr bool simd = true;
+
+                // products in parallel, summation in index order
+                static float run(const float *a, const float *b)
+                {
+                    alignas(16) float p[4];
+                    _mm_store_ps(p, _mm_mul_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)));
+
+                    float sum = 0;
+                    sum += p[0];
+                    sum += p[1];
+                    sum += p[2];
+                    sum += p[3];
+                    return sum;
+                }
+            };
+
+#if defined(MATHLIB_AVX)
+        template<>
+            struct MultiplyKernel<4, 4, 4, double> {
+                static constexpr bool simd = true;
+
+                static void run(const double *a, const double *b, double *r)
+                {
+                    const __m256d b0 = _mm256_loadu_pd(b);
+                    const __m256d b1 = _mm256_loadu_pd(b + 4);
+                    const __m256d b2 = _mm256_loadu_pd(b + 8);
+                    const __m256d b3 = _mm256_loadu_pd(b + 12);
+
+                    for (int row = 0; row < 4; row++) {
+                        const double *ar = a + row * 4;
+                        __m256d acc = _mm256_setzero_pd();
+                        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(ar[0]), b0));
+                        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(ar[1]), b1));
+                        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(ar[2]), b2));
+                        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(ar[3]), b3));
+                        _mm256_storeu_pd(r + row * 4, acc);
+                    }
+                }
+            };
+
+        template<>
+            struct TransformKernel<4, 4, double> {
+                static constexpr bool simd = true;
+
+                static void run(const double *a, const double *v, double *r)
+                {
+                    const __m256d r0 = _mm256_loadu_pd(a);
+                    const __m256d r1 = _mm256_loadu_pd(a + 4);
+                    const __m256d r2 = _mm256_loadu_pd(a + 8);
+                    const __m256d r3 = _mm256_loadu_pd(a + 12);
+
+                    // 4x4 transpose: rows to columns
+                    const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+                    const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+                    const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+                    const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+                    const __m256d c0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+                    const __m256d c1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+                    const __m256d c2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+                    const __m256d c3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+
+                    __m256d acc = _mm256_setzero_pd();
+                    acc = _mm256_add_pd(acc, _mm256_mul_pd(c0, _mm256_set1_pd(v[0])));
+                    acc = _mm256_add_pd(acc, _mm256_mul_pd(c1, _mm256_set1_pd(v[1])));
+                    acc = _mm256_add_pd(acc, _mm256_mul_pd(c2, _mm256_set1_pd(v[2])));
+                    acc = _mm256_add_pd(acc, _mm256_mul_pd(c3, _mm256_set1_pd(v[3])));
+                    _mm256_storeu_pd(r, acc);
+                }
+            };
+
+        template<>
+            struct AffineMultiplyKernel<double> {
+                static constexpr bool simd = true;
+
+                static void run(const double *a, const double *b, double *r)
+                {
+                    const __m256d b0 = _mm256_loadu_pd(b);
+                    const __m256d b1 = _mm256_loadu_pd(b + 4);
+                    const __m256d b2 = _mm256_loadu_pd(b + 8);
+
+                    for (int row = 0; row < 3; row++) {
+                        const double *ar = a + row * 4;
+                        __m256d acc = _mm256_setzero_pd();
+                        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(ar[0]), b0));
+                        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(ar[1]), b1));
+                        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(ar[2]), b2));
+                        acc = _mm256_add_pd(acc, _mm256_set_pd(ar[3], 0.0, 0.0, 0.0));
+                        _mm256_storeu_pd(r + row * 4, acc);
+                    }
+                }
+            };
+
+        template<>
+            struct DotKernel<4, double> {
+                static constexpr bool simd = true;
+
+                static double run(const double *a, const double *b)
+                {
+                    alignas(32) double p[4];
+                    _mm256_store_pd(p, _mm256_mul_pd(_mm256_loadu_pd(a), _mm256_loadu_pd(b)));
+
+                    double sum = 0;
+                    sum += p[0];
+                    sum += p[1];
+                    sum += p[2];
+                    sum += p[3];
+                    return sum;
+                }
+            };
+#else
+        // without avx a 4-wide double row is split into two sse2 halves
+        template<>
+            struct MultiplyKernel<4, 4, 4, double> {
+                static constexpr bool simd = true;
+
+                static void run(const double *a, const double *b, double *r)
+                {
+                    const __m128d b0l = _mm_loadu_pd(b),      b0h = _mm_loadu_pd(b + 2);
+                    const __m128d b1l = _mm_loadu_pd(b + 4),  b1h = _mm_loadu_pd(b + 6);
+                    const __m128d b2l = _mm_loadu_pd(b + 8),  b2h = _mm_loadu_pd(b + 10);
+                    const __m128d b3l = _mm_loadu_pd(b + 12), b3h = _mm_loadu_pd(b + 14);
+
+                    for (int row = 0; row < 4; row++) {
+                        const double *ar = a + row * 4;
+                        const __m128d s0 = _mm_set1_pd(ar[0]);
+                        const __m128d s1 = _mm_set1_pd(ar[1]);
+                        const __m128d s2 = _mm_set1_pd(ar[2]);
+                        const __m128d s3 = _mm_set1_pd(ar[3]);
+
+                        __m128d lo = _mm_setzero_pd();
+                        __m128d hi = _mm_setzero_pd();
+                        lo = _mm_add_pd(lo, _mm_mul_pd(s0, b0l)); hi = _mm_add_pd(hi, _mm_mul_pd(s0, b0h));
+                        lo = _mm_add_pd(lo, _mm_mul_pd(s1, b1l)); hi = _mm_add_pd(hi, _mm_mul_pd(s1, b1h));
+                        lo = _mm_add_pd(lo, _mm_mul_pd(s2, b2l)); hi = _mm_add_pd(hi, _mm_mul_pd(s2, b2h));
+                        lo = _mm_add_pd(lo, _mm_mul_pd(s3, b3l)); hi = _mm_add_pd(hi, _mm_mul_pd(s3, b3h));
+                        _mm_storeu_pd(r + row * 4, lo);
+                        _mm_storeu_pd(r + row * 4 + 2, hi);
+                    }
+                }
+            };
+
+        template<>
+            struct TransformKernel<4, 4, double> {
+                static constexpr bool simd = true;
+
+                static void run(const double *a, const double *v, double *r)
+                {
+                    __m128d lo = _mm_setzero_pd();
+                    __m128d hi = _mm_setzero_pd();
+                    for (int col = 0; col < 4; col += 2) {
+                        const __m128d r0 = _mm_loadu_pd(a + col);
+                        const __m128d r1 = _mm_loadu_pd(a + 4 + col);
+                        const __m128d r2 = _mm_loadu_pd(a + 8 + col);
+                        const __m128d r3 = _mm_loadu_pd(a + 12 + col);
+                        const __m128d v0 = _mm_set1_pd(v[col]);
+                        const __m128d v1 = _mm_set1_pd(v[col + 1]);
+
+                        lo = _mm_add_pd(lo, _mm_mul_pd(_mm_unpacklo_pd(r0, r1), v0));
+                        hi = _mm_add_pd(hi, _mm_mul_pd(_mm_unpacklo_pd(r2, r3), v0));
+                        lo = _mm_add_pd(lo, _mm_mul_pd(_mm_unpackhi_pd(r0, r1), v1));
+                        hi = _mm_add_pd(hi, _mm_mul_pd(_mm_unpackhi_pd(r2, r3), v1));
+                    }
+                    _mm_storeu_pd(r, lo);
+                    _mm_storeu_pd(r + 2, hi);
+                }
+            };
+
+        template<>
+            struct AffineMultiplyKernel<double> {
+                static constexpr bool simd = true;
+
+                static void run(const double *a, const double *b, double *r)
+                {
+                    const __m128d b0l = _mm_loadu_pd(b),     b0h = _mm_loadu_pd(b + 2);
+                    const __m128d b1l = _mm_loadu_pd(b + 4), b1h = _mm_loadu_pd(b + 6);
+                    const __m128d b2l = _mm_loadu_pd(b + 8), b2h = _mm_loadu_pd(b + 10);
+
+                    for (int row = 0; row < 3; row++) {
+                        const double *ar = a + row * 4;
+                        const __m128d s0 = _mm_set1_pd(ar[0]);
+                        const __m128d s1 = _mm_set1_pd(ar[1]);
+                        const __m128d s2 = _mm_set1_pd(ar[2]);
+
+                        __m128d lo = _mm_setzero_pd();
+                        __m128d hi = _mm_setzero_pd();
+                        lo = _mm_add_pd(lo, _mm_mul_pd(s0, b0l)); hi = _mm_add_pd(hi, _mm_mul_pd(s0, b0h));
+                        lo = _mm_add_pd(lo, _mm_mul_pd(s1, b1l)); hi = _mm_add_pd(hi, _mm_mul_pd(s1, b1h));
+                        lo = _mm_add_pd(lo, _mm_mul_pd(s2, b2l)); hi = _mm_add_pd(hi, _mm_mul_pd(s2, b2h));
+                        hi = _mm_add_pd(hi, _mm_set_pd(ar[3], 0.0));
+                        _mm_storeu_pd(r + row * 4, lo);
+                        _mm_storeu_pd(r + row * 4 + 2, hi);
+                    }
+                }
+            };
+
+        template<>
+            struct DotKernel<4, double> {
+                static constexpr bool simd = true;
+
+                static double run(const double *a, const double *b)
+                {
+                    alignas(16) double p[4];
+                    _mm_store_pd(p, _mm_mul_pd(_mm_loadu_pd(a), _mm_loadu_pd(b)));
+                    _mm_store_pd(p + 2, _mm_mul_pd(_mm_loadu_pd(a + 2), _mm_loadu_pd(b + 2)));
+
+                    double sum = 0;
+                    sum += p[0];
+                    sum += p[1];
+                    sum += p[2];
+                    sum += p[3];
+                    return sum;
+                }
+            };
+#endif
+#endif
+    }
+}
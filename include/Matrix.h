@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Vector.h"
+#include "Inverse.h"
+#include "Instrumentation.h"
 
 namespace mathlib {
     template<int rows, int cols, typename vtype, typename = void>
@@ -11,12 +13,117 @@ namespace mathlib {
 
     template<int rows, int cols, typename vtype>
         class MaybeIsQuadratic<rows, cols, vtype, std::enable_if_t<(rows == cols)>> {
+            private:
+                using MatrixType = Matrix<rows, rows, vtype>;
+
+                constexpr const MatrixType &self() const
+                {
+                    return *static_cast<const MatrixType*>(this);
+                }
+
+                constexpr MatrixType &self()
+                {
+                    return *static_cast<MatrixType*>(this);
+                }
+
             public:
-                Matrix<rows, rows, vtype> getInverse() {
+                // transpose in place by swapping across the diagonal
+                constexpr MatrixType &transpose()
+                {
+                    for (int row = 0; row < rows; row++) {
+                        for (int col = row + 1; col < rows; col++) {
+                            const vtype value = self()[row][col];
+                            self()[row][col] = self()[col][row];
+                            self()[col][row] = value;
+                        }
+                    }
+                    return self();
+                }
+
+                constexpr vtype getDeterminant() const
+                {
+                    // constant evaluation does not allow flat indexing across the nested row arrays
+                    if (detail::isConstantEvaluated()) {
+                        std::array<vtype, rows * rows> flat {};
+                        for (int row = 0; row < rows; row++)
+                            for (int col = 0; col < rows; col++)
+                                flat[row * rows + col] = self()[row][col];
+                        return detail::determinant<rows>(flat.data());
+                    }
+                    return detail::determinant<rows>(self().data());
+                }
 
+                // return true if the matrix is invertible and store the inverse in result,
+                // otherwise result is set to the zero matrix
+                bool getInverse(MatrixType &result) const
+                {
+                    static_assert(std::is_floating_point_v<vtype>, "inverse requires a floating point type");
+                    MATHLIB_COUNT(MatrixInverse, 1);
+                    return detail::invert<rows>(self().data(), result.data());
                 }
 
-                static Matrix<rows, rows, vtype> makeIdentity() {
+                // return the inverse or the zero matrix if the matrix is singular
+                MatrixType getInverse() const
+                {
+                    MatrixType result;
+                    getInverse(result);
+                    return result;
+                }
+
+                // inverse of an affine transform whose last row is [0 ... 0 1], e.g. a product of
+                // createTranslation, createRotation* and createScale: only the linear part is inverted
+                // return true if the linear part is invertible, otherwise result is set to the zero matrix
+                bool getAffineInverse(MatrixType &result) const
+                {
+                    static_assert(std::is_floating_point_v<vtype>, "inverse requires a floating point type");
+                    MATHLIB_COUNT(MatrixInverse, 1);
+                    constexpr int n = rows - 1;
+
+                    // copied before result is cleared, result may be this matrix
+                    Matrix<n, n, vtype> linear;
+                    vtype offset[n];
+                    for (int row = 0; row < n; row++) {
+                        for (int col = 0; col < n; col++)
+                            linear[row][col] = self()[row][col];
+                        offset[row] = self()[row][n];
+                    }
+
+                    result = MatrixType();
+                    if (!detail::invert<n>(linear.data(), linear.data()))
+                        return false;
+
+                    for (int row = 0; row < n; row++) {
+                        vtype translation = 0;
+                        for (int col = 0; col < n; col++) {
+                            result[row][col] = linear[row][col];
+                            translation -= linear[row][col] * offset[col];
+                        }
+                        result[row][n] = translation;
+                    }
+                    result[n][n] = 1;
+                    return true;
+                }
+
+                // inverse of a rigid transform (rotation and translation only, last row [0 ... 0 1]):
+                // the rotation part is orthonormal, so its inverse is its transpose
+                constexpr MatrixType getRigidInverse() const
+                {
+                    constexpr int n = rows - 1;
+
+                    MatrixType result;
+                    for (int row = 0; row < n; row++) {
+                        vtype translation = 0;
+                        for (int col = 0; col < n; col++) {
+                            result[row][col] = self()[col][row];
+                            translation -= self()[col][row] * self()[col][n];
+                        }
+                        result[row][n] = translation;
+                    }
+                    result[n][n] = 1;
+                    return result;
+                }
+
+                static constexpr Matrix<rows, rows, vtype> makeIdentity() {
                     Matrix<rows, rows, vtype> result;
                     for (int i = 0; i < rows; i++) {
                         result[i][i] = 1;
@@ -26,7 +133,7 @@ namespace mathlib {
         };
 
     // primary template
-    // column-major order
+    // row-major order
     template<int rows, int cols, typename vtype = float>
         class Matrix : public MaybeIsQuadratic<rows, cols, vtype> {
             private:
@@ -36,16 +143,16 @@ namespace mathlib {
 
             public:
                 // default constructor that zero-initializes the matrix
-                Matrix() = default;
+                constexpr Matrix() = default;
 
                 // constructor that takes elements from which to construct the matrix
                 template<typename... T>
-                Matrix(T... v)
+                constexpr Matrix(T... v)
                     : _val {v...} {}
 
                 // copy constructor that also allows conversion
                 template<typename T>
-                    Matrix(const Matrix<rows, cols, T> &other)
+                    constexpr Matrix(const Matrix<rows, cols, T> &other)
                     {
                         for (int row = 0; row < rows; row++)
                             for (int col = 0; col < cols; col++)
@@ -53,14 +160,14 @@ namespace mathlib {
                     }
 
                 // default copy constructor
-                Matrix(const Matrix &other) = default;
+                constexpr Matrix(const Matrix &other) = default;
 
                 // default copy assignment
-                Matrix &operator=(const Matrix &other) = default;
+                constexpr Matrix &operator=(const Matrix &other) = default;
 
                 // copy assignment that also allows conversion
                 template<typename T>
-                    Matrix &operator=(const Matrix<rows, cols, T> &other)
+                    constexpr Matrix &operator=(const Matrix<rows, cols, T> &other)
                     {
                         for (int row = 0; row < rows; row++)
                             for (int col = 0; col < cols; col++)
@@ -70,51 +177,114 @@ namespace mathlib {
                     }
 
                 // default move constructor
-                Matrix(ThisType &&other) noexcept = default;
+                constexpr Matrix(ThisType &&other) noexcept = default;
 
                 // default move assignment operator
-                ThisType &operator=(ThisType &&other) noexcept = default;
+                constexpr ThisType &operator=(ThisType &&other) noexcept = default;
 
                 // operations
-                ThisType operator+(const ThisType& other) const
+                constexpr ThisType operator+(const ThisType& other) const
                 {
                     ThisType result;
                     for (int row = 0; row < rows; row++) {
                         for (int col = 0; col < cols; col++) {
-                            result.at(row,col) = _val[row][col] + other.at(row,col);
+                            result[row][col] = _val[row][col] + other[row][col];
                         }
                     }
+                    return result;
                 }
 
-                ThisType operator-(const ThisType& other) const
+                constexpr ThisType operator-(const ThisType& other) const
                 {
                     ThisType result;
                     for (int row = 0; row < rows; row++) {
                         for (int col = 0; col < cols; col++) {
-                            result.at[row][col] = _val[row][col] - other[row][col];
+                            result[row][col] = _val[row][col] - other[row][col];
                         }
                     }
+                    return result;
                 }
 
                 template<int ocols>
-                    Matrix<rows, ocols, vtype> operator*(const Matrix<cols, ocols, vtype> &other) const
+                    constexpr Matrix<rows, ocols, vtype> operator*(const Matrix<cols, ocols, vtype> &other) const
                     {
+                        MATHLIB_COUNT(MatrixMultiply, rows * cols * ocols);
                         Matrix<rows, ocols, vtype> result;
+                        if constexpr (detail::MultiplyKernel<rows, cols, ocols, vtype>::simd) {
+                            if (!detail::isConstantEvaluated()) {
+                                detail::MultiplyKernel<rows, cols, ocols, vtype>::run(data(), other.data(), result.data());
+                                return result;
+                            }
+                        }
+
+                        // row of this times row of other into a row of the result, every inner loop is unit-stride;
+                        // each element still sums over n in ascending order
+                        for (int row = 0; row < rows; row++) {
+                            for (int n = 0; n < cols; n++) {
+                                const vtype value = _val[row][n];
+                                for (int col = 0; col < ocols; col++) {
+                                    result[row][col] += value * other[n][col];
+                                }
+                            }
+                        }
+
+                        return result;
+                    }
+
+                // this * other^T without forming the transpose: dot products of rows of both matrices
+                template<int orows>
+                    constexpr Matrix<rows, orows, vtype> multiplyByTransposed(const Matrix<orows, cols, vtype> &other) const
+                    {
+                        Matrix<rows, orows, vtype> result;
                         for (int row = 0; row < rows; row++) {
-                            for (int col = 0; col < ocols; col++) {
+                            for (int col = 0; col < orows; col++) {
+                                vtype sum = 0;
                                 for (int n = 0; n < cols; n++) {
-                                    result[row][col] += _val[row][n] * other[n][col];
+                                    sum += _val[row][n] * other[col][n];
                                 }
+                                result[row][col] = sum;
                             }
                         }
+                        return result;
+                    }
 
+                // this^T * other without forming the transpose: a sum of outer products of rows
+                template<int ocols>
+                    constexpr Matrix<cols, ocols, vtype> multiplyTransposed(const Matrix<rows, ocols, vtype> &other) const
+                    {
+                        Matrix<cols, ocols, vtype> result;
+                        for (int n = 0; n < rows; n++) {
+                            for (int row = 0; row < cols; row++) {
+                                const vtype value = _val[n][row];
+                                for (int col = 0; col < ocols; col++) {
+                                    result[row][col] += value * other[n][col];
+                                }
+                            }
+                        }
                         return result;
                     }
 
+                constexpr Matrix<cols, rows, vtype> getTransposed() const
+                {
+                    Matrix<cols, rows, vtype> result;
+                    for (int row = 0; row < rows; row++)
+                        for (int col = 0; col < cols; col++)
+                            result[col][row] = _val[row][col];
+                    return result;
+                }
+
                 // vector rows must be equal to matrix columns
-                Vector<rows, vtype> operator*(const Vector<cols, vtype>& v) const
+                constexpr Vector<rows, vtype> operator*(const Vector<cols, vtype>& v) const
                 {
+                    MATHLIB_COUNT(MatrixVectorMultiply, rows * cols);
                     Vector<rows, vtype> result;
+                    if constexpr (detail::TransformKernel<rows, cols, vtype>::simd) {
+                        if (!detail::isConstantEvaluated()) {
+                            detail::TransformKernel<rows, cols, vtype>::run(data(), v.data(), result.data());
+                            return result;
+                        }
+                    }
+
                     for (int row = 0; row < rows; row++) {
                         vtype sum = 0;
                         for (int col = 0; col < cols; col++) {
@@ -126,7 +296,7 @@ namespace mathlib {
                 }
 
 
-                bool operator==(const ThisType& other) const
+                constexpr bool operator==(const ThisType& other) const
                 {
                     for (int row = 0; row < rows; row++) {
                         for (int col = 0; col < cols; col++) {
@@ -137,48 +307,76 @@ namespace mathlib {
                     return true;
                 }
 
-                bool operator!=(const ThisType& other) const
+                constexpr bool operator!=(const ThisType& other) const
                 {
                     return !(this->operator==(other));
                 }
 
-                const std::array<vtype, cols>& operator[](int row) const
+                constexpr const std::array<vtype, cols>& operator[](int row) const
                 {
                     return _val[row];
                 }
 
-                std::array<vtype, cols>& operator[](int row)
+                constexpr std::array<vtype, cols>& operator[](int row)
                 {
                     return _val[row];
                 }
 
+                // pointer to the contiguous row-major element storage
+                constexpr const vtype *data() const
+                {
+                    return _val[0].data();
+                }
+
+                constexpr vtype *data()
+                {
+                    return _val[0].data();
+                }
+
+                // write the rows as "[ a b ... ]" separated by newlines into [first, last),
+                // returns the end of the text or nullptr if it does not fit
+                char *format(char *first, char *last, const FormatOptions &options = FormatOptions()) const
+                {
+                    for (int row = 0; row < rows && first != nullptr; row++) {
+                        if (row > 0)
+                            first = detail::formatText(first, last, "\n", 1);
+                        first = detail::formatValues(first, last, _val[row].data(), cols, options);
+                    }
+                    return first;
+                }
+
                 // print the matrix in a formatted way
                 void print() const
                 {
-                    // get longest row
+                    // format every row, the closing brackets are aligned to the longest one
+                    constexpr int rowCapacity = cols * (detail::maxScalarLength + 1) + 3;
+                    char rowText[rows][rowCapacity];
+                    int rowLength[rows];
                     int longest = 0;
-                    std::string rowStrings[rows];
-                    std::stringstream r;
                     for (int row = 0; row < rows; row++) {
-                        r.str(std::string());
-                        r << "[ ";
-                        for (int col = 0; col < cols; col++) {
-                            r << _val[row][col] << " ";
-                        }
-                        rowStrings[row] = r.str();
-                        if (rowStrings[row].size() > longest)
-                            longest = rowStrings[row].size();
+                        const char *end = detail::formatValues(rowText[row], rowText[row] + rowCapacity, _val[row].data(), cols, FormatOptions());
+                        // without the closing bracket
+                        rowLength[row] = static_cast<int>(end - rowText[row]) - 1;
+                        if (rowLength[row] > longest)
+                            longest = rowLength[row];
                     }
 
                     // fill with spaces and print
+                    char text[(rows + 1) * (rowCapacity + 1)];
+                    char *out = text;
                     for (int row = 0; row < rows; row++) {
-                        rowStrings[row].resize(longest, ' ');
-                        std::cout << rowStrings[row] << "]\n";
+                        std::memcpy(out, rowText[row], rowLength[row]);
+                        out += rowLength[row];
+                        for (int i = rowLength[row]; i < longest; i++)
+                            *out++ = ' ';
+                        *out++ = ']';
+                        *out++ = '\n';
                     }
 
                     for (int i = 0; i < longest + 1; i++)
-                        std::cout << "-";
-                    std::cout << std::endl;
+                        *out++ = '-';
+                    *out++ = '\n';
+                    std::fwrite(text, 1, out - text, stdout);
                 }
         };
 
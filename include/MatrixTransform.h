@@ -1,18 +1,78 @@
 #pragma once
 
+#include <cstddef>
+
 #include "Matrix.h"
 #include "Vector.h"
+#include "Quaternion.h"
 
 namespace mathlib {
     Matrix4 createPerspectiveProjection(float fov, float aspect, float clipNear, float clipFar);
-    Matrix4 createOrthographicProjection(float left, float right, float top, float bot, float clipNear, float clipFar);
-    Matrix4 createOrthographicProjection(float left, float right, float top, float bot);
+    // right-handed look-at: the camera at position looks along front with up roughly upwards,
+    // front and up need not be normalized but must not be parallel
     Matrix4 createViewMatrix(const Vector3 &position, const Vector3 &front, const Vector3 &up);
-    Matrix4 createTranslation(const Vector3 &position);
-    Matrix3 createTranslation(const Vector2 &position);
     Matrix4 createRotationX(float angle);
     Matrix4 createRotationY(float angle);
     Matrix4 createRotationZ(float angle);
     Matrix3 createRotation(float angle);
-    Matrix4 createScale(const Vector3 &scale);
+
+    // model matrix createTranslation(translation) * rotation * createScale(scale) built in one pass,
+    // without the intermediate matrix products
+    // the euler overload rotates about x first, then y, then z: rotation = createRotationZ * createRotationY * createRotationX
+    Matrix4 createTRS(const Vector3 &translation, const Quaternionf &rotation, const Vector3 &scale);
+    Matrix4 createTRS(const Vector3 &translation, const Vector3 &eulerAngles, const Vector3 &scale);
+
+    // out[i] = createTRS(translations[i], rotations[i], scales[i]), large batches are split across ThreadPool::global()
+    void createTRS(const Vector3 *translations, const Quaternionf *rotations, const Vector3 *scales, Matrix4 *out, std::size_t count);
+    void createTRS(const Vector3 *translations, const Vector3 *eulerAngles, const Vector3 *scales, Matrix4 *out, std::size_t count);
+
+    // builders without trigonometry are constexpr so that constant transforms can be baked at compile time
+    constexpr Matrix4 createOrthographicProjection(float left, float right, float top, float bot, float clipNear, float clipFar)
+    {
+        return Matrix4
+        {
+            2.f / (right - left), 0.f, 0.f, -(right + left) / (right - left),
+            0.f, 2.f / (top - bot), 0.f, -(top + bot) / (top - bot),
+            0.f, 0.f, -2.f / (clipFar - clipNear), -(clipFar + clipNear) / (clipFar - clipNear),
+            0.f, 0.f, 0.f, 1.f
+        };
+    }
+
+    constexpr Matrix4 createOrthographicProjection(float left, float right, float top, float bot)
+    {
+        return Matrix4
+        {
+            2.f / (right - left), 0.f, 0.f, -(right + left) / (right - left),
+            0.f, 2.f / (top - bot), 0.f, -(top + bot) / (top - bot),
+            0.f, 0.f, 1.f, 0.f,
+            0.f, 0.f, 0.f, 1.f
+        };
+    }
+
+    constexpr Matrix4 createTranslation(const Vector3 &position)
+    {
+        return Matrix4 {1.0f, 0.0f, 0.0f, position.x(),
+            0.0f, 1.0f, 0.0f, position.y(),
+            0.0f, 0.0f, 1.0f, position.z(),
+            0.0f, 0.0f, 0.0f, 1.0f
+        };
+    }
+
+    constexpr Matrix3 createTranslation(const Vector2 &position)
+    {
+        return Matrix3 {1.0f, 0.0f, position.x(),
+            0.0f, 1.0f, position.y(),
+            0.0f, 0.0f, 1.0f
+        };
+    }
+
+    constexpr Matrix4 createScale(const Vector3 &scale)
+    {
+        return Matrix4 {
+            scale.x(), 0.0f, 0.0f, 0.0f,
+            0.0f, scale.y(), 0.0f, 0.0f,
+            0.0f, 0.0f, scale.z(), 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f
+        };
+    }
 }
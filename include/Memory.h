@@ -0,0 +1,285 @@
+#pragma once
+
+#include <new>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "Matrix.h"
+#include "Vector.h"
+
+namespace mathlib {
+    // standard allocator returning storage aligned to the given boundary
+    // 64 bytes covers a cache line as well as every sse/avx load
+    template<typename T, std::size_t alignment = 64>
+        class AlignedAllocator {
+            static_assert((alignment & (alignment - 1)) == 0, "alignment must be a power of two");
+            static_assert(alignment >= alignof(T), "alignment must not be weaker than the natural one");
+
+            public:
+                using value_type = T;
+
+                template<typename U>
+                    struct rebind {
+                        using other = AlignedAllocator<U, alignment>;
+                    };
+
+                AlignedAllocator() noexcept = default;
+
+                template<typename U>
+                    AlignedAllocator(const AlignedAllocator<U, alignment> &) noexcept {}
+
+                T *allocate(std::size_t count)
+                {
+                    return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignment)));
+                }
+
+                void deallocate(T *ptr, std::size_t) noexcept
+                {
+                    ::operator delete(ptr, std::align_val_t(alignment));
+                }
+
+                template<typename U>
+                    bool operator==(const AlignedAllocator<U, alignment> &) const noexcept
+                    {
+                        return true;
+                    }
+
+                template<typename U>
+                    bool operator!=(const AlignedAllocator<U, alignment> &) const noexcept
+                    {
+                        return false;
+                    }
+        };
+
+    // contiguous growable array with aligned storage
+    template<typename T, std::size_t alignment = 64>
+        using AlignedBuffer = std::vector<T, AlignedAllocator<T, alignment>>;
+
+    // over-aligned variant of a math type, e.g. to keep every Matrix4 of an array on its own cache line
+    // or every Vector4 on a 16-byte boundary; arrays of Aligned types never split an element across
+    // cache lines, and std::vector honours the alignment through the aligned operator new
+    template<typename T, std::size_t alignment>
+        struct alignas(alignment) Aligned : public T {
+            static_assert((alignment & (alignment - 1)) == 0, "alignment must be a power of two");
+            static_assert(alignment >= alignof(T), "alignment must not be weaker than the natural one");
+
+            using T::T;
+
+            constexpr Aligned() = default;
+
+            constexpr Aligned(const T &other)
+                : T(other) {}
+
+            constexpr Aligned &operator=(const T &other)
+            {
+                T::operator=(other);
+                return *this;
+            }
+        };
+
+    // vectors padded to a full sse/avx register, matrices to whole cache lines
+    using AlignedVector3 = Aligned<Vector3, 16>;
+    using AlignedVector4 = Aligned<Vector4, 16>;
+    using AlignedMatrix3 = Aligned<Matrix3, 64>;
+    using AlignedMatrix4 = Aligned<Matrix4, 64>;
+
+    using AlignedVector3d = Aligned<Vector3d, 32>;
+    using AlignedVector4d = Aligned<Vector4d, 32>;
+    using AlignedMatrix4d = Aligned<Matrix4d, 64>;
+
+    // linear allocator for scratch memory, e.g. per-frame buffers of math objects:
+    // allocation bumps an offset into a preallocated block and reset() releases everything at once
+    // memory is only returned to the heap on destruction; when a frame overflows the current block,
+    // extra blocks are chained and the next reset() merges them into one block large enough for that frame,
+    // so a steady workload allocates from the heap only during the first frames
+    class Arena {
+        private:
+            struct Block {
+                unsigned char *data;
+                std::size_t size;
+            };
+
+            static constexpr std::size_t blockAlignment = 64;
+
+            std::vector<Block> _blocks;
+            std::size_t _offset = 0;
+            std::size_t _blockSize;
+            // bytes handed out from the blocks before the current one
+            std::size_t _previousUsed = 0;
+
+            static Block allocateBlock(std::size_t size)
+            {
+                return Block {static_cast<unsigned char*>(::operator new(size, std::align_val_t(blockAlignment))), size};
+            }
+
+            static void freeBlock(const Block &block)
+            {
+                ::operator delete(block.data, std::align_val_t(blockAlignment));
+            }
+
+            void release()
+            {
+                for (const Block &block : _blocks)
+                    freeBlock(block);
+                _blocks.clear();
+            }
+
+        public:
+            // the first block is allocated lazily
+            explicit Arena(std::size_t blockSize = std::size_t(1) << 20)
+                : _blockSize(blockSize) {}
+
+            ~Arena()
+            {
+                release();
+            }
+
+            Arena(const Arena &other) = delete;
+            Arena &operator=(const Arena &other) = delete;
+
+            Arena(Arena &&other) noexcept
+                : _blocks(std::move(other._blocks)), _offset(other._offset), _blockSize(other._blockSize), _previousUsed(other._previousUsed)
+            {
+                other._blocks.clear();
+                other._offset = 0;
+                other._previousUsed = 0;
+            }
+
+            Arena &operator=(Arena &&other) noexcept
+            {
+                if (this != &other) {
+                    release();
+                    _blocks = std::move(other._blocks);
+                    _offset = other._offset;
+                    _blockSize = other._blockSize;
+                    _previousUsed = other._previousUsed;
+                    other._blocks.clear();
+                    other._offset = 0;
+                    other._previousUsed = 0;
+                }
+                return *this;
+            }
+
+            // uninitialized memory of size bytes, alignment must be a power of two
+            void *allocate(std::size_t size, std::size_t alignment = blockAlignment)
+            {
+                if (!_blocks.empty()) {
+                    const Block &block = _blocks.back();
+                    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.data);
+                    const std::size_t aligned = ((base + _offset + alignment - 1) & ~(std::uintptr_t(alignment) - 1)) - base;
+                    if (aligned <= block.size && size <= block.size - aligned) {
+                        _offset = aligned + size;
+                        return block.data + aligned;
+                    }
+                    _previousUsed += _offset;
+                }
+
+                // start a new block, at least large enough for this request
+                const std::size_t padding = (alignment > blockAlignment) ? alignment : 0;
+                _blocks.push_back(allocateBlock(std::max(_blockSize, size + padding)));
+                _offset = 0;
+                return allocate(size, alignment);
+            }
+
+            // count default-constructed objects, by default starting on a cache line like AlignedBuffer;
+            // their destructors are never run, so T must be trivially destructible
+            template<typename T>
+                T *allocate(std::size_t count, std::size_t alignment = blockAlignment)
+                {
+                    static_assert(std::is_trivially_destructible_v<T>, "arena objects are released without running destructors");
+                    T *result = static_cast<T*>(allocate(count * sizeof(T), std::max(alignment, alignof(T))));
+                    for (std::size_t i = 0; i < count; i++)
+                        new (result + i) T();
+                    return result;
+                }
+
+            // release all allocations, O(1) unless the last use overflowed into extra blocks
+            void reset()
+            {
+                if (_blocks.size() > 1) {
+                    std::size_t total = 0;
+                    for (const Block &block : _blocks)
+                        total += block.size;
+                    release();
+                    _blocks.push_back(allocateBlock(total));
+                }
+                _offset = 0;
+                _previousUsed = 0;
+            }
+
+            // bytes handed out since the last reset, including alignment padding
+            std::size_t used() const
+            {
+                return _previousUsed + _offset;
+            }
+
+            // bytes held by the arena
+            std::size_t capacity() const
+            {
+                std::size_t total = 0;
+                for (const Block &block : _blocks)
+                    total += block.size;
+                return total;
+            }
+    };
+
+    // standard allocator drawing from an Arena, e.g. std::vector<Vector3, ArenaAllocator<Vector3>>
+    // as per-frame scratch; deallocation is a no-op, the memory comes back with Arena::reset()
+    template<typename T, std::size_t alignment = 64>
+        class ArenaAllocator {
+            static_assert((alignment & (alignment - 1)) == 0, "alignment must be a power of two");
+            static_assert(alignment >= alignof(T), "alignment must not be weaker than the natural one");
+
+            private:
+                Arena *_arena;
+
+                template<typename U, std::size_t a>
+                    friend class ArenaAllocator;
+
+            public:
+                using value_type = T;
+
+                template<typename U>
+                    struct rebind {
+                        using other = ArenaAllocator<U, (alignment > alignof(U)) ? alignment : alignof(U)>;
+                    };
+
+                explicit ArenaAllocator(Arena &arena) noexcept
+                    : _arena(&arena) {}
+
+                template<typename U, std::size_t a>
+                    ArenaAllocator(const ArenaAllocator<U, a> &other) noexcept
+                    : _arena(other._arena) {}
+
+                T *allocate(std::size_t count)
+                {
+                    return static_cast<T*>(_arena->allocate(count * sizeof(T), alignment));
+                }
+
+                void deallocate(T *, std::size_t) noexcept {}
+
+                Arena &arena() const noexcept
+                {
+                    return *_arena;
+                }
+
+                template<typename U, std::size_t a>
+                    bool operator==(const ArenaAllocator<U, a> &other) const noexcept
+                    {
+                        return _arena == other._arena;
+                    }
+
+                template<typename U, std::size_t a>
+                    bool operator!=(const ArenaAllocator<U, a> &other) const noexcept
+                    {
+                        return _arena != other._arena;
+                    }
+        };
+
+    template<typename T, std::size_t alignment = 64>
+        using ArenaVector = std::vector<T, ArenaAllocator<T, alignment>>;
+}
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "BatchTransform.h"
+
+namespace mathlib {
+    // unit quaternions represent rotations in 4 instead of 9 or 16 values,
+    // composition is a 16-multiply hamilton product instead of a matrix product
+    // stored as x, y, z (imaginary part) followed by w (real part)
+    template<typename vtype = float>
+        class Quaternion {
+            private:
+                std::array<vtype, 4> _val = {0, 0, 0, 1};
+
+                using ThisType = Quaternion<vtype>;
+
+            public:
+                // default constructor that creates the identity rotation
+                constexpr Quaternion() = default;
+
+                constexpr Quaternion(vtype x, vtype y, vtype z, vtype w)
+                    : _val {x, y, z, w} {}
+
+                // rotation by angle (radians) around a normalized axis
+                static ThisType fromAxisAngle(const Vector<3, vtype> &axis, vtype angle)
+                {
+                    const vtype s = std::sin(angle / 2);
+                    return ThisType {axis.x() * s, axis.y() * s, axis.z() * s, std::cos(angle / 2)};
+                }
+
+                // rotation part of an orthonormal matrix
+                static ThisType fromMatrix(const Matrix<3, 3, vtype> &m)
+                {
+                    // pick the largest of w, x, y, z to divide by so that the square root stays well-conditioned
+                    const vtype trace = m[0][0] + m[1][1] + m[2][2];
+                    if (trace > 0) {
+                        const vtype s = std::sqrt(trace + 1) * 2;
+                        return ThisType {(m[2][1] - m[1][2]) / s, (m[0][2] - m[2][0]) / s, (m[1][0] - m[0][1]) / s, s / 4};
+                    } else if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+                        const vtype s = std::sqrt(1 + m[0][0] - m[1][1] - m[2][2]) * 2;
+                        return ThisType {s / 4, (m[0][1] + m[1][0]) / s, (m[0][2] + m[2][0]) / s, (m[2][1] - m[1][2]) / s};
+                    } else if (m[1][1] > m[2][2]) {
+                        const vtype s = std::sqrt(1 + m[1][1] - m[0][0] - m[2][2]) * 2;
+                        return ThisType {(m[0][1] + m[1][0]) / s, s / 4, (m[1][2] + m[2][1]) / s, (m[0][2] - m[2][0]) / s};
+                    } else {
+                        const vtype s = std::sqrt(1 + m[2][2] - m[0][0] - m[1][1]) * 2;
+                        return ThisType {(m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s, s / 4, (m[1][0] - m[0][1]) / s};
+                    }
+                }
+
+                // rotation part (upper-left 3x3) of a transform
+                static ThisType fromMatrix(const Matrix<4, 4, vtype> &m)
+                {
+                    Matrix<3, 3, vtype> rotation;
+                    for (int row = 0; row < 3; row++)
+                        for (int col = 0; col < 3; col++)
+                            rotation[row][col] = m[row][col];
+                    return fromMatrix(rotation);
+                }
+
+                constexpr vtype &x() { return _val[0]; }
+                constexpr vtype x() const { return _val[0]; }
+                constexpr vtype &y() { return _val[1]; }
+                constexpr vtype y() const { return _val[1]; }
+                constexpr vtype &z() { return _val[2]; }
+                constexpr vtype z() const { return _val[2]; }
+                constexpr vtype &w() { return _val[3]; }
+                constexpr vtype w() const { return _val[3]; }
+
+                constexpr const vtype *data() const { return _val.data(); }
+                constexpr vtype *data() { return _val.data(); }
+
+                // hamilton product, (a * b) rotates by b first and then by a
+                constexpr ThisType operator*(const ThisType &other) const
+                {
+                    const vtype ax = _val[0], ay = _val[1], az = _val[2], aw = _val[3];
+                    const vtype bx = other._val[0], by = other._val[1], bz = other._val[2], bw = other._val[3];
+                    return ThisType {
+                        aw * bx + ax * bw + ay * bz - az * by,
+                        aw * by - ax * bz + ay * bw + az * bx,
+                        aw * bz + ax * by - ay * bx + az * bw,
+                        aw * bw - ax * bx - ay * by - az * bz
+                    };
+                }
+
+                constexpr ThisType &operator*=(const ThisType &other)
+                {
+                    return (*this) = (*this) * other;
+                }
+
+                // component-wise operations as needed for interpolation
+                constexpr ThisType operator+(const ThisType &other) const
+                {
+                    return ThisType {_val[0] + other._val[0], _val[1] + other._val[1], _val[2] + other._val[2], _val[3] + other._val[3]};
+                }
+
+                constexpr ThisType operator-(const ThisType &other) const
+                {
+                    return ThisType {_val[0] - other._val[0], _val[1] - other._val[1], _val[2] - other._val[2], _val[3] - other._val[3]};
+                }
+
+                constexpr ThisType operator*(vtype scale) const
+                {
+                    return ThisType {_val[0] * scale, _val[1] * scale, _val[2] * scale, _val[3] * scale};
+                }
+
+                constexpr ThisType operator-() const
+                {
+                    return ThisType {-_val[0], -_val[1], -_val[2], -_val[3]};
+                }
+
+                constexpr bool operator==(const ThisType &other) const
+                {
+                    return _val[0] == other._val[0] && _val[1] == other._val[1] && _val[2] == other._val[2] && _val[3] == other._val[3];
+                }
+
+                constexpr bool operator!=(const ThisType &other) const
+                {
+                    return !((*this) == other);
+                }
+
+                constexpr vtype dot(const ThisType &other) const
+                {
+                    return _val[0] * other._val[0] + _val[1] * other._val[1] + _val[2] * other._val[2] + _val[3] * other._val[3];
+                }
+
+                constexpr vtype getLengthSquared() const
+                {
+                    return dot(*this);
+                }
+
+                vtype getLength() const
+                {
+                    return std::sqrt(getLengthSquared());
+                }
+
+                ThisType getNormalized() const
+                {
+                    return (*this) * (vtype(1) / getLength());
+                }
+
+                void normalize()
+                {
+                    (*this) = getNormalized();
+                }
+
+                // inverse rotation of a unit quaternion
+                constexpr ThisType getConjugate() const
+                {
+                    return ThisType {-_val[0], -_val[1], -_val[2], _val[3]};
+                }
+
+                // inverse of an arbitrary non-zero quaternion
+                constexpr ThisType getInverse() const
+                {
+                    return getConjugate() * (vtype(1) / getLengthSquared());
+                }
+
+                // rotate v by this unit quaternion: v + 2w (u x v) + 2u x (u x v) with u = (x, y, z),
+                // 15 multiplies instead of two hamilton products
+                constexpr Vector<3, vtype> rotate(const Vector<3, vtype> &v) const
+                {
+                    const Vector<3, vtype> u {_val[0], _val[1], _val[2]};
+                    const Vector<3, vtype> t = u.cross(v) * vtype(2);
+                    return v + t * _val[3] + u.cross(t);
+                }
+
+                // rotation matrix of this unit quaternion
+                constexpr Matrix<3, 3, vtype> toMatrix3() const
+                {
+                    const vtype x = _val[0], y = _val[1], z = _val[2], w = _val[3];
+                    const vtype xx = x * x, yy = y * y, zz = z * z;
+                    const vtype xy = x * y, xz = x * z, yz = y * z;
+                    const vtype wx = w * x, wy = w * y, wz = w * z;
+                    return Matrix<3, 3, vtype> {
+                        1 - 2 * (yy + zz), 2 * (xy - wz), 2 * (xz + wy),
+                        2 * (xy + wz), 1 - 2 * (xx + zz), 2 * (yz - wx),
+                        2 * (xz - wy), 2 * (yz + wx), 1 - 2 * (xx + yy)
+                    };
+                }
+
+                constexpr Matrix<4, 4, vtype> toMatrix4() const
+                {
+                    const Matrix<3, 3, vtype> r = toMatrix3();
+                    return Matrix<4, 4, vtype> {
+                        r[0][0], r[0][1], r[0][2], vtype(0),
+                        r[1][0], r[1][1], r[1][2], vtype(0),
+                        r[2][0], r[2][1], r[2][2], vtype(0),
+                        vtype(0), vtype(0), vtype(0), vtype(1)
+                    };
+                }
+        };
+
+    template<typename vtype>
+        constexpr Quaternion<vtype> operator*(vtype scale, const Quaternion<vtype> &q)
+        {
+            return q * scale;
+        }
+
+    // normalized linear interpolation along the shorter arc; constant-time and commutative,
+    // but the angular velocity is not constant
+    template<typename vtype>
+        Quaternion<vtype> nlerp(const Quaternion<vtype> &a, const Quaternion<vtype> &b, vtype t)
+        {
+            const Quaternion<vtype> target = (a.dot(b) < 0) ? -b : b;
+            return (a + (target - a) * t).getNormalized();
+        }
+
+    // spherical linear interpolation along the shorter arc with constant angular velocity,
+    // falls back to nlerp for nearly identical rotations where sin(theta) vanishes
+    template<typename vtype>
+        Quaternion<vtype> slerp(const Quaternion<vtype> &a, const Quaternion<vtype> &b, vtype t)
+        {
+            vtype cosTheta = a.dot(b);
+            Quaternion<vtype> target = b;
+            if (cosTheta < 0) {
+                cosTheta = -cosTheta;
+                target = -b;
+            }
+
+            if (cosTheta > vtype(0.9995))
+                return nlerp(a, target, t);
+
+            const vtype theta = std::acos(cosTheta);
+            const vtype invSin = vtype(1) / std::sin(theta);
+            return a * (std::sin((1 - t) * theta) * invSin) + target * (std::sin(t * theta) * invSin);
+        }
+
+    // rotate count vectors by one quaternion; converted to a matrix once and run through the
+    // simd/parallel direction transform, in and out may alias
+    template<typename vtype>
+        void rotate(const Quaternion<vtype> &q, const Vector<3, vtype> *in, Vector<3, vtype> *out, std::size_t count)
+        {
+            transformDirections(q.toMatrix4(), in, out, count);
+        }
+
+    // rotate in[n] by rotations[n], e.g. bone-local vectors by their bone rotation
+    template<typename vtype>
+        void rotate(const Quaternion<vtype> *rotations, const Vector<3, vtype> *in, Vector<3, vtype> *out, std::size_t count)
+        {
+            for (std::size_t n = 0; n < count; n++)
+                out[n] = rotations[n].rotate(in[n]);
+        }
+
+    using Quaternionf = Quaternion<float>;
+    using Quaterniond = Quaternion<double>;
+}
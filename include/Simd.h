@@ -0,0 +1,21 @@
+#pragma once
+
+// compile-time detection of the instruction sets the kernels may use
+// define MATHLIB_NO_SIMD before including any header to force the generic code paths
+#if !defined(MATHLIB_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATHLIB_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define MATHLIB_AVX 1
+#include <immintrin.h>
+#endif
+
+// half-float conversion instructions, a separate extension that not every avx cpu has
+#if defined(__F16C__)
+#define MATHLIB_F16C 1
+#include <immintrin.h>
+#endif
+#endif
@@ -0,0 +1,380 @@
+#pragma once
+
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+
+#include "Vector.h"
+#include "ThreadPool.h"
+#include "DenseVector.h"
+#include "Instrumentation.h"
+
+namespace mathlib {
+    // sparse matrices for problems with few nonzeros per row: a SparseBuilder collects (row, col, value)
+    // triplets in any order, CsrMatrix and CscMatrix are the compressed row/column formats built from it
+    // indices are int like the sizes of DenseMatrix and DenseVector, offsets std::size_t so that
+    // the number of nonzeros is not limited to 2^31
+
+    template<typename vtype>
+        class CsrMatrix;
+
+    template<typename vtype>
+        class CscMatrix;
+
+    namespace detail {
+        // products with fewer nonzeros than this run on the calling thread only
+        constexpr std::size_t sparseParallelThreshold = 1 << 15;
+
+        // compress triplets into offsets/indices/values sorted by major, then minor index,
+        // duplicates are summed; a counting sort over the major index keeps this O(nnz + majors)
+        template<typename vtype>
+            void compress(int majors, const std::vector<int> &major, const std::vector<int> &minor, const std::vector<vtype> &value,
+                    std::vector<std::size_t> &offsets, std::vector<int> &indices, std::vector<vtype> &values)
+            {
+                const std::size_t count = major.size();
+                offsets.assign(static_cast<std::size_t>(majors) + 1, 0);
+                for (std::size_t i = 0; i < count; i++)
+                    offsets[major[i] + 1]++;
+                for (int m = 0; m < majors; m++)
+                    offsets[m + 1] += offsets[m];
+
+                std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+                std::vector<int> sortedMinor(count);
+                std::vector<vtype> sortedValue(count);
+                for (std::size_t i = 0; i < count; i++) {
+                    const std::size_t slot = next[major[i]]++;
+                    sortedMinor[slot] = minor[i];
+                    sortedValue[slot] = value[i];
+                }
+
+                // sort every major slice by minor index and merge duplicates
+                std::vector<std::pair<int, vtype>> slice;
+                indices.clear();
+                values.clear();
+                indices.reserve(count);
+                values.reserve(count);
+                std::size_t begin = 0;
+                for (int m = 0; m < majors; m++) {
+                    const std::size_t end = offsets[m + 1];
+                    slice.clear();
+                    for (std::size_t i = begin; i < end; i++)
+                        slice.emplace_back(sortedMinor[i], sortedValue[i]);
+                    std::sort(slice.begin(), slice.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+                    offsets[m] = indices.size();
+                    for (std::size_t i = 0; i < slice.size(); i++) {
+                        if (i > 0 && slice[i].first == slice[i - 1].first) {
+                            values.back() += slice[i].second;
+                        } else {
+                            indices.push_back(slice[i].first);
+                            values.push_back(slice[i].second);
+                        }
+                    }
+                    begin = end;
+                }
+                offsets[majors] = indices.size();
+            }
+
+        // transpose a compressed matrix: the majors of the result are the minors of the input
+        template<typename vtype>
+            void transposeCompressed(int majors, int minors, const std::vector<std::size_t> &offsets, const std::vector<int> &indices,
+                    const std::vector<vtype> &values, std::vector<std::size_t> &outOffsets, std::vector<int> &outIndices, std::vector<vtype> &outValues)
+            {
+                outOffsets.assign(static_cast<std::size_t>(minors) + 1, 0);
+                for (int index : indices)
+                    outOffsets[index + 1]++;
+                for (int m = 0; m < minors; m++)
+                    outOffsets[m + 1] += outOffsets[m];
+
+                // walking the input in major order keeps every output slice sorted
+                std::vector<std::size_t> next(outOffsets.begin(), outOffsets.end() - 1);
+                outIndices.resize(indices.size());
+                outValues.resize(values.size());
+                for (int m = 0; m < majors; m++) {
+                    for (std::size_t i = offsets[m]; i < offsets[m + 1]; i++) {
+                        const std::size_t slot = next[indices[i]]++;
+                        outIndices[slot] = m;
+                        outValues[slot] = values[i];
+                    }
+                }
+            }
+
+        // y[m] = sum over the slice m of values * x[indices], split by major index across the global pool
+        template<typename vtype>
+            void gatherProduct(int majors, const std::vector<std::size_t> &offsets, const std::vector<int> &indices,
+                    const std::vector<vtype> &values, const vtype *x, vtype *y)
+            {
+                auto body = [&](std::size_t first, std::size_t last) {
+                    for (std::size_t m = first; m < last; m++) {
+                        vtype sum = 0;
+                        for (std::size_t i = offsets[m]; i < offsets[m + 1]; i++)
+                            sum += values[i] * x[indices[i]];
+                        y[m] = sum;
+                    }
+                };
+
+                const std::size_t nonZeros = values.size();
+                if (nonZeros < sparseParallelThreshold || ThreadPool::global().size() == 1) {
+                    body(0, majors);
+                    return;
+                }
+
+                // grain in rows such that a chunk holds about sparseParallelThreshold / 4 nonzeros
+                const std::size_t grain = std::max<std::size_t>(1, static_cast<std::size_t>(majors) * (sparseParallelThreshold / 4) / nonZeros);
+                ThreadPool::global().parallelFor(0, majors, grain, body);
+            }
+
+        // y = 0, then y[indices] += values * x[m] for every slice m; serial since slices scatter into shared entries
+        template<typename vtype>
+            void scatterProduct(int majors, int minors, const std::vector<std::size_t> &offsets, const std::vector<int> &indices,
+                    const std::vector<vtype> &values, const vtype *x, vtype *y)
+            {
+                std::fill(y, y + minors, vtype(0));
+                for (int m = 0; m < majors; m++) {
+                    const vtype xm = x[m];
+                    for (std::size_t i = offsets[m]; i < offsets[m + 1]; i++)
+                        y[indices[i]] += values[i] * xm;
+                }
+            }
+    }
+
+    // coordinate-format builder, entries may be added in any order and duplicates are summed
+    template<typename vtype = float>
+        class SparseBuilder {
+            private:
+                int _rows = 0;
+                int _cols = 0;
+                std::vector<int> _rowIndices;
+                std::vector<int> _colIndices;
+                std::vector<vtype> _values;
+
+                friend class CsrMatrix<vtype>;
+                friend class CscMatrix<vtype>;
+
+            public:
+                SparseBuilder() = default;
+
+                SparseBuilder(int rows, int cols)
+                    : _rows(rows), _cols(cols) {}
+
+                int rows() const { return _rows; }
+                int cols() const { return _cols; }
+
+                // number of added entries, before duplicates are merged
+                std::size_t size() const { return _values.size(); }
+
+                void reserve(std::size_t count)
+                {
+                    _rowIndices.reserve(count);
+                    _colIndices.reserve(count);
+                    _values.reserve(count);
+                }
+
+                void add(int row, int col, vtype value)
+                {
+                    assert(row >= 0 && row < _rows && col >= 0 && col < _cols);
+                    _rowIndices.push_back(row);
+                    _colIndices.push_back(col);
+                    _values.push_back(value);
+                }
+
+                void clear()
+                {
+                    _rowIndices.clear();
+                    _colIndices.clear();
+                    _values.clear();
+                }
+        };
+
+    // compressed sparse row storage: the nonzeros of row r are values[offsets[r] .. offsets[r + 1])
+    // in ascending column order; the format for matrix-vector products and the iterative solvers
+    template<typename vtype = float>
+        class CsrMatrix {
+            private:
+                int _rows = 0;
+                int _cols = 0;
+                std::vector<std::size_t> _offsets = {0};
+                std::vector<int> _indices;
+                std::vector<vtype> _values;
+
+                friend class CscMatrix<vtype>;
+
+            public:
+                // default constructor that creates an empty 0 x 0 matrix
+                CsrMatrix() = default;
+
+                explicit CsrMatrix(const SparseBuilder<vtype> &builder)
+                    : _rows(builder._rows), _cols(builder._cols)
+                {
+                    detail::compress(_rows, builder._rowIndices, builder._colIndices, builder._values, _offsets, _indices, _values);
+                }
+
+                explicit CsrMatrix(const CscMatrix<vtype> &other)
+                    : _rows(other._rows), _cols(other._cols)
+                {
+                    detail::transposeCompressed(_cols, _rows, other._offsets, other._indices, other._values, _offsets, _indices, _values);
+                }
+
+                int rows() const { return _rows; }
+                int cols() const { return _cols; }
+                std::size_t nonZeros() const { return _values.size(); }
+
+                const std::vector<std::size_t> &offsets() const { return _offsets; }
+                const std::vector<int> &indices() const { return _indices; }
+                const std::vector<vtype> &values() const { return _values; }
+                std::vector<vtype> &values() { return _values; }
+
+                // element at (row, col), zero if not stored; binary search within the row
+                vtype operator()(int row, int col) const
+                {
+                    const auto first = _indices.begin() + _offsets[row];
+                    const auto last = _indices.begin() + _offsets[row + 1];
+                    const auto it = std::lower_bound(first, last, col);
+                    return (it != last && *it == col) ? _values[it - _indices.begin()] : vtype(0);
+                }
+
+                // y = A * x, rows are distributed over the global thread pool for large matrices
+                // x must hold cols() and y rows() elements, they must not alias
+                void multiply(const vtype *x, vtype *y) const
+                {
+                    MATHLIB_TIME(SparseMultiply, _values.size());
+                    detail::gatherProduct(_rows, _offsets, _indices, _values, x, y);
+                }
+
+                void multiply(const DenseVector<vtype> &x, DenseVector<vtype> &y) const
+                {
+                    assert(x.size() == _cols);
+                    if (y.size() != _rows)
+                        y.resize(_rows);
+                    multiply(x.data(), y.data());
+                }
+
+                DenseVector<vtype> operator*(const DenseVector<vtype> &x) const
+                {
+                    DenseVector<vtype> y(_rows);
+                    multiply(x, y);
+                    return y;
+                }
+
+                // product with a fixed-size vector, the matrix must be dim x dim
+                template<int dim>
+                    Vector<dim, vtype> operator*(const Vector<dim, vtype> &x) const
+                    {
+                        assert(_rows == dim && _cols == dim);
+                        Vector<dim, vtype> y;
+                        multiply(x.data(), y.data());
+                        return y;
+                    }
+
+                // y = A^T * x, serial scatter over the rows; convert to CscMatrix for repeated use
+                void multiplyTransposed(const vtype *x, vtype *y) const
+                {
+                    detail::scatterProduct(_rows, _cols, _offsets, _indices, _values, x, y);
+                }
+
+                // diagonal entries, zero where not stored
+                DenseVector<vtype> getDiagonal() const
+                {
+                    const int n = std::min(_rows, _cols);
+                    DenseVector<vtype> result(n);
+                    for (int row = 0; row < n; row++)
+                        result[row] = (*this)(row, row);
+                    return result;
+                }
+
+                CsrMatrix getTransposed() const
+                {
+                    CsrMatrix result;
+                    result._rows = _cols;
+                    result._cols = _rows;
+                    detail::transposeCompressed(_rows, _cols, _offsets, _indices, _values, result._offsets, result._indices, result._values);
+                    return result;
+                }
+        };
+
+    // compressed sparse column storage: the nonzeros of column c are values[offsets[c] .. offsets[c + 1])
+    // in ascending row order; A^T * x is the parallel gather here while A * x scatters
+    template<typename vtype = float>
+        class CscMatrix {
+            private:
+                int _rows = 0;
+                int _cols = 0;
+                std::vector<std::size_t> _offsets = {0};
+                std::vector<int> _indices;
+                std::vector<vtype> _values;
+
+                friend class CsrMatrix<vtype>;
+
+            public:
+                // default constructor that creates an empty 0 x 0 matrix
+                CscMatrix() = default;
+
+                explicit CscMatrix(const SparseBuilder<vtype> &builder)
+                    : _rows(builder._rows), _cols(builder._cols)
+                {
+                    detail::compress(_cols, builder._colIndices, builder._rowIndices, builder._values, _offsets, _indices, _values);
+                }
+
+                explicit CscMatrix(const CsrMatrix<vtype> &other)
+                    : _rows(other._rows), _cols(other._cols)
+                {
+                    detail::transposeCompressed(_rows, _cols, other._offsets, other._indices, other._values, _offsets, _indices, _values);
+                }
+
+                int rows() const { return _rows; }
+                int cols() const { return _cols; }
+                std::size_t nonZeros() const { return _values.size(); }
+
+                const std::vector<std::size_t> &offsets() const { return _offsets; }
+                const std::vector<int> &indices() const { return _indices; }
+                const std::vector<vtype> &values() const { return _values; }
+                std::vector<vtype> &values() { return _values; }
+
+                // element at (row, col), zero if not stored; binary search within the column
+                vtype operator()(int row, int col) const
+                {
+                    const auto first = _indices.begin() + _offsets[col];
+                    const auto last = _indices.begin() + _offsets[col + 1];
+                    const auto it = std::lower_bound(first, last, row);
+                    return (it != last && *it == row) ? _values[it - _indices.begin()] : vtype(0);
+                }
+
+                // y = A * x, serial scatter over the columns
+                void multiply(const vtype *x, vtype *y) const
+                {
+                    MATHLIB_TIME(SparseMultiply, _values.size());
+                    detail::scatterProduct(_cols, _rows, _offsets, _indices, _values, x, y);
+                }
+
+                void multiply(const DenseVector<vtype> &x, DenseVector<vtype> &y) const
+                {
+                    assert(x.size() == _cols);
+                    if (y.size() != _rows)
+                        y.resize(_rows);
+                    multiply(x.data(), y.data());
+                }
+
+                DenseVector<vtype> operator*(const DenseVector<vtype> &x) const
+                {
+                    DenseVector<vtype> y(_rows);
+                    multiply(x, y);
+                    return y;
+                }
+
+                // y = A^T * x, columns are distributed over the global thread pool for large matrices
+                // x must hold rows() and y cols() elements, they must not alias
+                void multiplyTransposed(const vtype *x, vtype *y) const
+                {
+                    detail::gatherProduct(_cols, _offsets, _indices, _values, x, y);
+                }
+        };
+
+    using SparseBuilderf = SparseBuilder<float>;
+    using SparseBuilderd = SparseBuilder<double>;
+    using CsrMatrixf = CsrMatrix<float>;
+    using CsrMatrixd = CsrMatrix<double>;
+    using CscMatrixf = CscMatrix<float>;
+    using CscMatrixd = CscMatrix<double>;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <condition_variable>
+
+namespace mathlib {
+    // work-stealing thread pool shared by the parallel kernels of the library
+    // every worker owns a task queue, pops from its back and steals from the front of the others;
+    // a thread waiting for a parallelFor runs queued tasks itself, so nested calls cannot deadlock
+    class ThreadPool {
+        private:
+            struct Queue {
+                std::mutex mutex;
+                std::deque<std::function<void()>> tasks;
+            };
+
+            std::vector<std::unique_ptr<Queue>> _queues;
+            std::vector<std::thread> _workers;
+            std::atomic<std::size_t> _pending {0};
+            std::atomic<std::size_t> _nextQueue {0};
+            std::mutex _sleepMutex;
+            std::condition_variable _wake;
+            bool _stop = false;
+
+            void push(std::function<void()> task);
+            bool tryRun(int self);
+            void workerLoop(int index);
+            int currentWorker() const;
+
+        public:
+            // threadCount is the total concurrency including the calling thread,
+            // so ThreadPool(1) starts no workers and runs everything serially
+            explicit ThreadPool(int threadCount = defaultThreadCount());
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool &other) = delete;
+            ThreadPool &operator=(const ThreadPool &other) = delete;
+
+            int size() const
+            {
+                return static_cast<int>(_workers.size()) + 1;
+            }
+
+            // call body(first, last) on disjoint subranges covering [begin, end)
+            // ranges of at most grain elements are not split further and run on the calling thread
+            // if body throws, the first exception is rethrown once every subrange has finished
+            void parallelFor(std::size_t begin, std::size_t end, std::size_t grain,
+                    const std::function<void(std::size_t, std::size_t)> &body);
+
+            static int defaultThreadCount();
+
+            // pool used by gemm, gemv and the batch transforms
+            static ThreadPool &global();
+
+            // replace the global pool, must not be called while it is in use
+            static void setGlobalThreadCount(int threadCount);
+    };
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace mathlib {
+    // sine and cosine of the same angle with a single argument reduction
+    inline void sincos(float angle, float &s, float &c)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_sincosf(angle, &s, &c);
+#else
+        s = std::sin(angle);
+        c = std::cos(angle);
+#endif
+    }
+
+    inline void sincos(double angle, double &s, double &c)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_sincos(angle, &s, &c);
+#else
+        s = std::sin(angle);
+        c = std::cos(angle);
+#endif
+    }
+
+    // opt-in polynomial approximations for float, trading the last bits of accuracy for throughput
+    // of whole arrays; a single angle is not faster than the sincosf of a current libm
+    //
+    // the argument is reduced to [-pi/4, pi/4] by a three-part cody-waite split of pi/2 and evaluated
+    // with the cephes minimax polynomials; maximum error against the correctly rounded result,
+    // measured over every float in range:
+    //   |angle| <= pi/4: 1 ulp for sin and cos, 3 ulp for tan
+    //   |angle| <= 2pi: 2 ulp for sin, 14 ulp for cos and 11 ulp for tan (both next to the zeros of cos)
+    //   |angle| <= 8192: absolute error below 1e-7 for sin and cos
+    // beyond 8192 the reduction loses accuracy; nan and inf are not handled
+    //
+    // the array versions run 4 (sse2) or 8 (avx) angles per instruction with the same sequence of
+    // operations as the scalar versions
+    namespace approx {
+        namespace detail {
+            // pi/2 = piOver2Hi + piOver2Mid + piOver2Lo, the high parts have few mantissa bits so that
+            // q * piOver2Hi and q * piOver2Mid are exact
+            constexpr float twoOverPi = 0.636619772367581343f;
+            constexpr float piOver2Hi = 1.5703125f;
+            constexpr float piOver2Mid = 4.837512969970703125e-4f;
+            constexpr float piOver2Lo = 7.54978995489188216e-8f;
+
+            // sin and cos on [-pi/4, pi/4], z = x * x
+            constexpr float sinSmall(float x, float z)
+            {
+                return x + x * z * (-1.6666654611e-1f + z * (8.3321608736e-3f + z * -1.9515295891e-4f));
+            }
+
+            constexpr float cosSmall(float z)
+            {
+                return 1.f - 0.5f * z + z * z * (4.166664568298827e-2f + z * (-1.388731625493765e-3f + z * 2.443315711809948e-5f));
+            }
+        }
+
+        inline void sincos(float angle, float &s, float &c)
+        {
+            const float a = std::abs(angle);
+            // quadrant of a = round(a * 2/pi)
+            const int quadrant = static_cast<int>(a * detail::twoOverPi + 0.5f);
+            const float q = static_cast<float>(quadrant);
+            const bool odd = quadrant & 1;
+            const bool high = quadrant & 2;
+
+            const float x = ((a - q * detail::piOver2Hi) - q * detail::piOver2Mid) - q * detail::piOver2Lo;
+            const float z = x * x;
+            const float sinX = detail::sinSmall(x, z);
+            const float cosX = detail::cosSmall(z);
+
+            // sin(a) cycles through sin x, cos x, -sin x, -cos x and cos(a) through cos x, -sin x, -cos x, sin x
+            const float sinA = odd ? cosX : sinX;
+            const float cosA = odd ? sinX : cosX;
+            s = std::copysign(1.f, angle) * (high ? -sinA : sinA);
+            c = (odd != high) ? -cosA : cosA;
+        }
+
+        inline float sin(float angle)
+        {
+            float s, c;
+            sincos(angle, s, c);
+            return s;
+        }
+
+        inline float cos(float angle)
+        {
+            float s, c;
+            sincos(angle, s, c);
+            return c;
+        }
+
+        inline float tan(float angle)
+        {
+            float s, c;
+            sincos(angle, s, c);
+            return s / c;
+        }
+
+        // element-wise over count angles; outputs must not alias each other but may alias the input
+        void sincos(const float *angles, float *s, float *c, std::size_t count);
+        void sin(const float *angles, float *out, std::size_t count);
+        void cos(const float *angles, float *out, std::size_t count);
+        void tan(const float *angles, float *out, std::size_t count);
+    }
+}
@@ -4,10 +4,13 @@
 #include <cmath>
 #include <string>
 #include <limits>
-#include <sstream>
-#include <iostream>
+#include <cstdio>
 #include <type_traits>
 
+#include "Format.h"
+#include "Kernels.h"
+#include "Instrumentation.h"
+
 namespace mathlib {
     template<int dim, typename vtype>
         class Vector;
@@ -18,8 +21,8 @@ namespace mathlib {
     template<int dim, typename vtype>
         class MaybeHasX<dim, vtype, std::enable_if_t<(dim > 0)>> {
             public:
-                vtype &x() { return (static_cast<Vector<dim, vtype>*>(this))->operator[](0); }
-                vtype x() const { return (static_cast<const Vector<dim, vtype>*>(this))->operator[](0); }
+                constexpr vtype &x() { return (static_cast<Vector<dim, vtype>*>(this))->operator[](0); }
+                constexpr vtype x() const { return (static_cast<const Vector<dim, vtype>*>(this))->operator[](0); }
         };
 
     template<int dim, typename vtype, typename = void>
@@ -28,8 +31,8 @@ namespace mathlib {
     template<int dim, typename vtype>
         class MaybeHasY<dim, vtype, std::enable_if_t<(dim > 1)>> {
             public:
-                vtype &y() { return (static_cast<Vector<dim, vtype>*>(this))->operator[](1); }
-                vtype y() const { return (static_cast<const Vector<dim, vtype>*>(this))->operator[](1); }
+                constexpr vtype &y() { return (static_cast<Vector<dim, vtype>*>(this))->operator[](1); }
+                constexpr vtype y() const { return (static_cast<const Vector<dim, vtype>*>(this))->operator[](1); }
         };
 
     template<int dim, typename vtype, typename = void>
@@ -38,11 +41,11 @@ namespace mathlib {
     template<int dim, typename vtype>
         class MaybeHasZ<dim, vtype, std::enable_if_t<(dim > 2)>> {
             public:
-                vtype &z() { return (static_cast<Vector<dim, vtype>*>(this))->operator[](2); }
-                vtype z() const { return (static_cast<const Vector<dim, vtype>*>(this))->operator[](2); }
+                constexpr vtype &z() { return (static_cast<Vector<dim, vtype>*>(this))->operator[](2); }
+                constexpr vtype z() const { return (static_cast<const Vector<dim, vtype>*>(this))->operator[](2); }
 
                 // todo maybe learn some math and implement this for n-dimensional vector spaces
-                Vector<dim, vtype> cross(const Vector<dim, vtype> &other) const
+                constexpr Vector<dim, vtype> cross(const Vector<dim, vtype> &other) const
                 {
                     const Vector<dim, vtype>* pThis = static_cast<const Vector<dim, vtype>*>(this);
                     return Vector<dim, vtype> {
@@ -59,8 +62,8 @@ namespace mathlib {
     template<int dim, typename vtype>
         class MaybeHasW<dim, vtype, std::enable_if_t<(dim > 3)>> {
             public:
-                vtype &w() { return (static_cast<Vector<dim, vtype>*>(this))->operator[](3); }
-                vtype w() const { return (static_cast<const Vector<dim, vtype>*>(this))->operator[](3); }
+                constexpr vtype &w() { return (static_cast<Vector<dim, vtype>*>(this))->operator[](3); }
+                constexpr vtype w() const { return (static_cast<const Vector<dim, vtype>*>(this))->operator[](3); }
         };
 
     template<int dim, typename vtype = float>
@@ -72,31 +75,31 @@ namespace mathlib {
 
             public:
                 // default constructor that zero-initializes the vector
-                Vector() = default;
+                constexpr Vector() = default;
 
                 // constructor that takes elements from which to construct the vector
                 template<typename... T>
-                    Vector(T... v)
+                    constexpr Vector(T... v)
                     : _val {v...}
                 {}
 
                 // copy constructor that also allows conversion and size difference
                 template<int odim, typename T>
-                    Vector(const Vector<odim, T> &other)
+                    constexpr Vector(const Vector<odim, T> &other)
                     {
                         for (int i = 0; i < std::min(dim, odim); i++)
                             _val[i] = static_cast<vtype>(other[i]);
                     }
 
                 // default copy constructor
-                Vector(const ThisType &other) = default;
+                constexpr Vector(const ThisType &other) = default;
 
                 // default copy assignment
-                Vector &operator=(const ThisType &other) = default;
+                constexpr Vector &operator=(const ThisType &other) = default;
 
                 // copy assignment that also allows conversion
                 template<int odim, typename T>
-                    Vector &operator=(const Vector<odim, T> &other)
+                    constexpr Vector &operator=(const Vector<odim, T> &other)
                     {
                         for (int i = 0; i < std::min(dim, odim); i++)
                             _val[i] = static_cast<vtype>(other[i]);
@@ -105,13 +108,13 @@ namespace mathlib {
                     }
 
                 // default move constructor
-                Vector(ThisType &&other) noexcept = default;
+                constexpr Vector(ThisType &&other) noexcept = default;
 
                 // default move assignment operator
-                ThisType &operator=(ThisType &&other) noexcept = default;
+                constexpr ThisType &operator=(ThisType &&other) noexcept = default;
 
                 // element-wise operations
-                ThisType operator+(const ThisType& other) const
+                constexpr ThisType operator+(const ThisType& other) const
                 {
                     ThisType result;
                     for (int n = 0; n < dim; n++) {
@@ -120,7 +123,7 @@ namespace mathlib {
                     return result;
                 }
 
-                ThisType operator-(const ThisType& other) const
+                constexpr ThisType operator-(const ThisType& other) const
                 {
                     ThisType result;
                     for (int n = 0; n < dim; n++) {
@@ -129,7 +132,7 @@ namespace mathlib {
                     return result;
                 }
 
-                ThisType operator*(const ThisType& other) const
+                constexpr ThisType operator*(const ThisType& other) const
                 {
                     ThisType result;
                     for (int n = 0; n < dim; n++) {
@@ -138,7 +141,7 @@ namespace mathlib {
                     return result;
                 }
 
-                ThisType operator/(const ThisType& other) const
+                constexpr ThisType operator/(const ThisType& other) const
                 {
                     ThisType result;
                     for (int n = 0; n < dim; n++) {
@@ -147,7 +150,7 @@ namespace mathlib {
                     return result;
                 }
 
-                ThisType &operator+=(const ThisType& other)
+                constexpr ThisType &operator+=(const ThisType& other)
                 {
                     for (int n = 0; n < dim; n++) {
                         _val[n] += other._val[n];
@@ -155,7 +158,7 @@ namespace mathlib {
                     return *this;
                 }
 
-                ThisType &operator-=(const ThisType& other)
+                constexpr ThisType &operator-=(const ThisType& other)
                 {
                     for (int n = 0; n < dim; n++) {
                         _val[n] -= other._val[n];
@@ -163,14 +166,14 @@ namespace mathlib {
                     return *this;
                 }
 
-                ThisType &operator*=(const ThisType& other)
+                constexpr ThisType &operator*=(const ThisType& other)
                 {
                     for (int n = 0; n < dim; n++) {
                         _val[n] *= other._val[n];
                     }
                     return *this;
                 }
-                ThisType &operator/=(const ThisType& other)
+                constexpr ThisType &operator/=(const ThisType& other)
                 {
                     for (int n = 0; n < dim; n++) {
                         _val[n] /= other._val[n];
@@ -180,7 +183,7 @@ namespace mathlib {
 
                 // scalar operations
                 template<typename T>
-                    ThisType operator*(T scale) const
+                    constexpr ThisType operator*(T scale) const
                     {
                         ThisType result;
                         for (int n = 0; n < dim; n++) {
@@ -190,7 +193,7 @@ namespace mathlib {
                     }
 
                 template<typename T>
-                    ThisType operator/(T scale) const
+                    constexpr ThisType operator/(T scale) const
                     {
                         ThisType result;
                         for (int n = 0; n < dim; n++) {
@@ -199,7 +202,7 @@ namespace mathlib {
                         return result;
                     }
 
-                ThisType operator-() const
+                constexpr ThisType operator-() const
                 {
                     ThisType result;
                     for (int n = 0; n < dim; n++) {
@@ -208,7 +211,7 @@ namespace mathlib {
                     return result;
                 }
 
-                bool operator==(const Vector& other) const
+                constexpr bool operator==(const Vector& other) const
                 {
                     for (int n = 0; n < dim; n++) {
                         if (_val[n] != other._val[n])
@@ -217,20 +220,31 @@ namespace mathlib {
                     return true;
                 }
 
-                bool operator!=(const Vector& other){
+                constexpr bool operator!=(const Vector& other) const {
                     return !((*this) == other);
                 }
 
-                const vtype operator[](int row) const
+                constexpr const vtype operator[](int row) const
                 {
                     return _val[row];
                 }
 
-                vtype& operator[](int row)
+                constexpr vtype& operator[](int row)
                 {
                     return _val[row];
                 }
 
+                // pointer to the contiguous element storage
+                constexpr const vtype *data() const
+                {
+                    return _val.data();
+                }
+
+                constexpr vtype *data()
+                {
+                    return _val.data();
+                }
+
                 // calculate the length of the vector
                 vtype getLength() const
                 {
@@ -238,7 +252,7 @@ namespace mathlib {
                 }
 
                 // calculate the length squared of the vector (self-dot)
-                vtype getLengthSquared() const
+                constexpr vtype getLengthSquared() const
                 {
                     return dot(*this);
                 }
@@ -246,6 +260,7 @@ namespace mathlib {
                 // return the normalized vector as a new one
                 Vector getNormalized() const
                 {
+                    MATHLIB_COUNT(VectorNormalize, 1);
                     return (*this) / this->getLength();
                 }
 
@@ -255,39 +270,51 @@ namespace mathlib {
                     (*this) = getNormalized();
                 }
 
-                vtype dot(const ThisType& other) const
+                constexpr vtype dot(const ThisType& other) const
                 {
+                    if constexpr (detail::DotKernel<dim, vtype>::simd)
+                        if (!detail::isConstantEvaluated())
+                            return detail::DotKernel<dim, vtype>::run(_val.data(), other._val.data());
+
                     vtype sum = 0;
                     for (int n = 0; n < dim; n++)
                         sum += _val[n] * other._val[n];
                     return sum;
                 }
 
+                // write "[ x y ... ]" into [first, last), returns the end of the text or nullptr if it does not fit
+                char *format(char *first, char *last, const FormatOptions &options = FormatOptions()) const
+                {
+                    return detail::formatValues(first, last, _val.data(), dim, options);
+                }
+
                 // print the vector in a formatted way
                 void print(bool useBetterPrecision = false) const
                 {
-                    std::stringstream ss;
+                    FormatOptions options;
                     if (useBetterPrecision)
-                        ss.precision(std::numeric_limits<vtype>::max_digits10);
-                    ss << "[ ";
-                    for (int n = 0; n < dim; n++)
-                        ss << _val[n] << " ";
-                    ss << "]\n";
-                    std::string res = ss.str();
-                    std::cout << res;
-                    for (int i = 0; i < res.size() - 1; i++)
-                        std::cout << "-";
-                    std::cout << std::endl;
+                        options.style = FloatStyle::Shortest;
+
+                    // the text, then a line of dashes of the same length
+                    constexpr int capacity = dim * (detail::maxScalarLength + 1) + 3;
+                    char text[2 * capacity + 2];
+                    char *end = format(text, text + capacity, options);
+                    const int length = static_cast<int>(end - text);
+                    *end++ = '\n';
+                    for (int i = 0; i < length; i++)
+                        *end++ = '-';
+                    *end++ = '\n';
+                    std::fwrite(text, 1, end - text, stdout);
                 }
         };
 
     template<int dim, typename vtype>
-        Vector<dim, vtype> operator*(const vtype &scale, const Vector<dim, vtype> &vec)
+        constexpr Vector<dim, vtype> operator*(const vtype &scale, const Vector<dim, vtype> &vec)
         {
             return vec * scale;
         }
     template<int dim, typename vtype>
-        Vector<dim, vtype> operator/(const vtype &scale, const Vector<dim, vtype> &vec)
+        constexpr Vector<dim, vtype> operator/(const vtype &scale, const Vector<dim, vtype> &vec)
         {
             return vec * scale;
         }
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "Memory.h"
+#include "Vector.h"
+#include "Kernels.h"
+
+namespace mathlib {
+    namespace detail {
+        // bulk operations run over fixed-size blocks so that the inner loops have a known trip count
+        // and are vectorized by the compiler; the remainder is handled by a scalar tail
+        constexpr int soaBlock = 16;
+    }
+
+    // structure-of-arrays container of vectors
+    // every component is stored in its own 64-byte aligned array, so bulk operations
+    // stream through memory with aligned, unit-stride loads
+    template<int dim, typename vtype = float>
+        class VectorSoA {
+            private:
+                std::array<AlignedBuffer<vtype>, dim> _components;
+
+                using ThisType = VectorSoA<dim, vtype>;
+                using VectorType = Vector<dim, vtype>;
+
+            public:
+                // default constructor that creates an empty container
+                VectorSoA() = default;
+
+                // constructor that creates size zero-initialized vectors
+                explicit VectorSoA(std::size_t size)
+                {
+                    resize(size);
+                }
+
+                // constructor that converts from the array-of-structs layout
+                VectorSoA(const VectorType *vectors, std::size_t count)
+                {
+                    resize(count);
+                    for (std::size_t i = 0; i < count; i++)
+                        set(i, vectors[i]);
+                }
+
+                // convert back into the array-of-structs layout, out must hold size() vectors
+                void toAoS(VectorType *out) const
+                {
+                    for (std::size_t i = 0; i < size(); i++)
+                        out[i] = get(i);
+                }
+
+                std::size_t size() const
+                {
+                    return _components[0].size();
+                }
+
+                void resize(std::size_t size)
+                {
+                    for (int n = 0; n < dim; n++)
+                        _components[n].resize(size);
+                }
+
+                void reserve(std::size_t size)
+                {
+                    for (int n = 0; n < dim; n++)
+                        _components[n].reserve(size);
+                }
+
+                void clear()
+                {
+                    for (int n = 0; n < dim; n++)
+                        _components[n].clear();
+                }
+
+                void push_back(const VectorType &vec)
+                {
+                    for (int n = 0; n < dim; n++)
+                        _components[n].push_back(vec[n]);
+                }
+
+                VectorType get(std::size_t i) const
+                {
+                    VectorType result;
+                    for (int n = 0; n < dim; n++)
+                        result[n] = _components[n][i];
+                    return result;
+                }
+
+                void set(std::size_t i, const VectorType &vec)
+                {
+                    for (int n = 0; n < dim; n++)
+                        _components[n][i] = vec[n];
+                }
+
+                // aligned array holding the n-th component of every vector
+                const vtype *component(int n) const
+                {
+                    return _components[n].data();
+                }
+
+                vtype *component(int n)
+                {
+                    return _components[n].data();
+                }
+
+                // element-wise operations, other must have the same size
+                ThisType &operator+=(const ThisType &other)
+                {
+                    for (int n = 0; n < dim; n++) {
+                        vtype *a = component(n);
+                        const vtype *b = other.component(n);
+                        forEachBlock([&](std::size_t i, int count) {
+                            vtype r[detail::soaBlock];
+                            for (int k = 0; k < count; k++)
+                                r[k] = a[i + k] + b[i + k];
+                            for (int k = 0; k < count; k++)
+                                a[i + k] = r[k];
+                        });
+                    }
+                    return *this;
+                }
+
+                ThisType &operator-=(const ThisType &other)
+                {
+                    for (int n = 0; n < dim; n++) {
+                        vtype *a = component(n);
+                        const vtype *b = other.component(n);
+                        forEachBlock([&](std::size_t i, int count) {
+                            vtype r[detail::soaBlock];
+                            for (int k = 0; k < count; k++)
+                                r[k] = a[i + k] - b[i + k];
+                            for (int k = 0; k < count; k++)
+                                a[i + k] = r[k];
+                        });
+                    }
+                    return *this;
+                }
+
+                ThisType &operator*=(vtype scale)
+                {
+                    for (int n = 0; n < dim; n++) {
+                        vtype *a = component(n);
+                        forEachBlock([&](std::size_t i, int count) {
+                            for (int k = 0; k < count; k++)
+                                a[i + k] *= scale;
+                        });
+                    }
+                    return *this;
+                }
+
+                // this += other * scale
+                ThisType &fma(const ThisType &other, vtype scale)
+                {
+                    for (int n = 0; n < dim; n++) {
+                        vtype *a = component(n);
+                        const vtype *b = other.component(n);
+                        forEachBlock([&](std::size_t i, int count) {
+                            vtype r[detail::soaBlock];
+                            for (int k = 0; k < count; k++)
+                                r[k] = a[i + k] + b[i + k] * scale;
+                            for (int k = 0; k < count; k++)
+                                a[i + k] = r[k];
+                        });
+                    }
+                    return *this;
+                }
+
+                // out[i] = dot(this[i], other[i]), out must hold size() values
+                void dot(const ThisType &other, vtype *out) const
+                {
+                    forEachBlock([&](std::size_t i, int count) {
+                        vtype r[detail::soaBlock] = {0};
+                        for (int n = 0; n < dim; n++) {
+                            const vtype *a = component(n);
+                            const vtype *b = other.component(n);
+                            for (int k = 0; k < count; k++)
+                                r[k] += a[i + k] * b[i + k];
+                        }
+                        for (int k = 0; k < count; k++)
+                            out[i + k] = r[k];
+                    });
+                }
+
+                // out[i] = this[i].getLengthSquared()
+                void getLengthSquared(vtype *out) const
+                {
+                    dot(*this, out);
+                }
+
+                // out[i] = this[i].getLength()
+                void getLength(vtype *out) const
+                {
+                    forEachBlock([&](std::size_t i, int count) {
+                        vtype r[detail::soaBlock] = {0};
+                        for (int n = 0; n < dim; n++) {
+                            const vtype *a = component(n);
+                            for (int k = 0; k < count; k++)
+                                r[k] += a[i + k] * a[i + k];
+                        }
+                        detail::sqrtArray(r, count);
+                        for (int k = 0; k < count; k++)
+                            out[i + k] = r[k];
+                    });
+                }
+
+                // normalizes every vector, zero vectors become nan as with Vector::normalize
+                void normalize()
+                {
+                    forEachBlock([&](std::size_t i, int count) {
+                        vtype r[detail::soaBlock] = {0};
+                        for (int n = 0; n < dim; n++) {
+                            const vtype *a = component(n);
+                            for (int k = 0; k < count; k++)
+                                r[k] += a[i + k] * a[i + k];
+                        }
+                        detail::sqrtArray(r, count);
+                        for (int n = 0; n < dim; n++) {
+                            vtype *a = component(n);
+                            for (int k = 0; k < count; k++)
+                                a[i + k] /= r[k];
+                        }
+                    });
+                }
+
+                // out[i] = this[i].cross(other[i]), out may be this or other
+                template<int d = dim, typename = std::enable_if_t<(d == 3)>>
+                    void cross(const ThisType &other, ThisType &out) const
+                    {
+                        out.resize(size());
+                        const vtype *ax = component(0), *ay = component(1), *az = component(2);
+                        const vtype *bx = other.component(0), *by = other.component(1), *bz = other.component(2);
+                        vtype *ox = out.component(0), *oy = out.component(1), *oz = out.component(2);
+                        forEachBlock([&](std::size_t i, int count) {
+                            vtype rx[detail::soaBlock], ry[detail::soaBlock], rz[detail::soaBlock];
+                            for (int k = 0; k < count; k++) {
+                                rx[k] = ay[i + k] * bz[i + k] - az[i + k] * by[i + k];
+                                ry[k] = az[i + k] * bx[i + k] - ax[i + k] * bz[i + k];
+                                rz[k] = ax[i + k] * by[i + k] - ay[i + k] * bx[i + k];
+                            }
+                            for (int k = 0; k < count; k++) {
+                                ox[i + k] = rx[k];
+                                oy[i + k] = ry[k];
+                                oz[i + k] = rz[k];
+                            }
+                        });
+                    }
+
+            private:
+                // call op(first, count) for every full block and once for the remaining tail
+                template<typename Op>
+                    void forEachBlock(Op op) const
+                    {
+                        const std::size_t total = size();
+                        std::size_t i = 0;
+                        for (; i + detail::soaBlock <= total; i += detail::soaBlock)
+                            op(i, detail::soaBlock);
+                        if (i < total)
+                            op(i, static_cast<int>(total - i));
+                    }
+        };
+
+    typedef VectorSoA<2> Vector2SoA;
+    typedef VectorSoA<3> Vector3SoA;
+    typedef VectorSoA<4> Vector4SoA;
+
+    typedef VectorSoA<2, double> Vector2dSoA;
+    typedef VectorSoA<3, double> Vector3dSoA;
+    typedef VectorSoA<4, double> Vector4dSoA;
+}
@@ -0,0 +1,335 @@
+#include "../include/BinaryFormat.h"
+
+#include <new>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MATHLIB_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace mathlib {
+    namespace {
+        constexpr char magic[8] = {'M', 'A', 'T', 'H', 'L', 'I', 'B', '\0'};
+        // readers accept every file up to this version
+        constexpr std::uint32_t version = 1;
+        constexpr std::uint32_t endianTag = 0x01020304;
+        constexpr std::uint64_t payloadAlignment = 64;
+
+        struct FileHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t endianTag;
+            std::uint64_t entryCount;
+            std::uint64_t tableOffset;
+            unsigned char reserved[32];
+        };
+
+        struct FileEntry {
+            char name[BinaryEntry::maxNameLength + 1];
+            std::uint32_t kind;
+            std::uint32_t scalar;
+            std::uint32_t elementRows;
+            std::uint32_t elementCols;
+            std::int32_t rows;
+            std::int32_t cols;
+            std::uint32_t order;
+            std::uint32_t reserved0;
+            std::uint64_t count;
+            std::uint64_t offset;
+            std::uint64_t bytes;
+            unsigned char reserved1[8];
+        };
+
+        static_assert(sizeof(FileHeader) == 64, "the header is 64 bytes");
+        static_assert(sizeof(FileEntry) == 128, "an entry table record is 128 bytes");
+
+        std::size_t scalarSize(ScalarType scalar)
+        {
+            switch (scalar) {
+                case ScalarType::Float32: return sizeof(float);
+                case ScalarType::Float64: return sizeof(double);
+                case ScalarType::Int32: return sizeof(std::int32_t);
+            }
+            return 0;
+        }
+
+        // a * b, false if the product does not fit into 64 bits
+        bool multiplyChecked(std::uint64_t a, std::uint64_t b, std::uint64_t &product)
+        {
+            if (a != 0 && b > ~std::uint64_t(0) / a)
+                return false;
+            product = a * b;
+            return true;
+        }
+
+        // true if the shape of an entry is consistent and its payload is entry.bytes long and fits into available
+        // bytes; every size from the file is checked against overflow before it is multiplied
+        bool shapeValid(const BinaryEntry &entry, std::uint64_t available)
+        {
+            const std::uint64_t size = scalarSize(entry.scalar);
+            if (size == 0 || entry.elementRows <= 0 || entry.elementCols <= 0 || entry.rows < 0 || entry.cols < 0)
+                return false;
+
+            std::uint64_t elementBytes = size;
+            switch (entry.kind) {
+                case ArrayKind::Vectors:
+                case ArrayKind::Matrices:
+                    if (!multiplyChecked(static_cast<std::uint64_t>(entry.elementRows) * static_cast<std::uint64_t>(entry.elementCols), size, elementBytes))
+                        return false;
+                    break;
+                case ArrayKind::DenseVector:
+                    break;
+                case ArrayKind::DenseMatrix: {
+                    const std::uint64_t rows = static_cast<std::uint64_t>(entry.rows);
+                    const std::uint64_t cols = static_cast<std::uint64_t>(entry.cols);
+                    const bool shapeMatches = (cols == 0) ? entry.count == 0 : (entry.count % cols == 0 && entry.count / cols == rows);
+                    if (!shapeMatches)
+                        return false;
+                    break;
+                }
+                default:
+                    return false;
+            }
+
+            return entry.count <= available / elementBytes && entry.bytes == entry.count * elementBytes;
+        }
+    }
+
+    BinaryWriter::BinaryWriter(const std::string &path)
+    {
+        open(path);
+    }
+
+    BinaryWriter::~BinaryWriter()
+    {
+        if (_file != nullptr)
+            close();
+    }
+
+    bool BinaryWriter::open(const std::string &path)
+    {
+        if (_file != nullptr)
+            close();
+
+        _entries.clear();
+        _failed = false;
+        _file = std::fopen(path.c_str(), "wb");
+        if (_file == nullptr)
+            return false;
+
+        // placeholder, the real header is written by close()
+        const FileHeader header {};
+        _failed = std::fwrite(&header, sizeof(header), 1, _file) != 1;
+        _position = sizeof(header);
+        return !_failed;
+    }
+
+    bool BinaryWriter::writeArray(BinaryEntry entry, const void *data)
+    {
+        if (_file == nullptr || _failed)
+            return false;
+        if (entry.name.empty() || entry.name.size() > BinaryEntry::maxNameLength)
+            return false;
+        for (const BinaryEntry &other : _entries)
+            if (other.name == entry.name)
+                return false;
+
+        static const unsigned char zeros[payloadAlignment] = {};
+        const std::uint64_t padding = (payloadAlignment - _position % payloadAlignment) % payloadAlignment;
+        if (padding > 0 && std::fwrite(zeros, 1, padding, _file) != padding) {
+            _failed = true;
+            return false;
+        }
+        _position += padding;
+
+        entry.offset = _position;
+        if (entry.bytes > 0 && std::fwrite(data, 1, entry.bytes, _file) != entry.bytes) {
+            _failed = true;
+            return false;
+        }
+        _position += entry.bytes;
+
+        _entries.push_back(std::move(entry));
+        return true;
+    }
+
+    bool BinaryWriter::close()
+    {
+        if (_file == nullptr)
+            return false;
+
+        bool ok = !_failed;
+        if (ok) {
+            static const unsigned char zeros[payloadAlignment] = {};
+            const std::uint64_t padding = (payloadAlignment - _position % payloadAlignment) % payloadAlignment;
+            ok = padding == 0 || std::fwrite(zeros, 1, padding, _file) == padding;
+
+            FileHeader header {};
+            std::memcpy(header.magic, magic, sizeof(magic));
+            header.version = version;
+            header.endianTag = endianTag;
+            header.entryCount = _entries.size();
+            header.tableOffset = _position + padding;
+
+            for (std::size_t i = 0; ok && i < _entries.size(); i++) {
+                const BinaryEntry &entry = _entries[i];
+                FileEntry record {};
+                std::memcpy(record.name, entry.name.data(), entry.name.size());
+                record.kind = static_cast<std::uint32_t>(entry.kind);
+                record.scalar = static_cast<std::uint32_t>(entry.scalar);
+                record.elementRows = static_cast<std::uint32_t>(entry.elementRows);
+                record.elementCols = static_cast<std::uint32_t>(entry.elementCols);
+                record.rows = entry.rows;
+                record.cols = entry.cols;
+                record.order = static_cast<std::uint32_t>(entry.order);
+                record.count = entry.count;
+                record.offset = entry.offset;
+                record.bytes = entry.bytes;
+                ok = std::fwrite(&record, sizeof(record), 1, _file) == 1;
+            }
+
+            ok = ok && std::fseek(_file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, _file) == 1;
+        }
+
+        ok = (std::fclose(_file) == 0) && ok;
+        _file = nullptr;
+        _entries.clear();
+        return ok;
+    }
+
+    BinaryReader::BinaryReader(const std::string &path)
+    {
+        open(path);
+    }
+
+    BinaryReader::~BinaryReader()
+    {
+        close();
+    }
+
+    bool BinaryReader::open(const std::string &path)
+    {
+        close();
+
+#if defined(MATHLIB_MMAP)
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+            ::close(fd);
+            return false;
+        }
+
+        void *mapping = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+            return false;
+
+        _mapping = static_cast<const unsigned char*>(mapping);
+        _mappingSize = static_cast<std::size_t>(info.st_size);
+        _mapped = true;
+#else
+        // no mapping available, read the whole file into 64-byte aligned memory
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+            return false;
+
+        long size = -1;
+        if (std::fseek(file, 0, SEEK_END) == 0)
+            size = std::ftell(file);
+        if (size < static_cast<long>(sizeof(FileHeader)) || std::fseek(file, 0, SEEK_SET) != 0) {
+            std::fclose(file);
+            return false;
+        }
+
+        unsigned char *buffer = static_cast<unsigned char*>(::operator new(static_cast<std::size_t>(size), std::align_val_t(payloadAlignment)));
+        const bool ok = std::fread(buffer, 1, static_cast<std::size_t>(size), file) == static_cast<std::size_t>(size);
+        std::fclose(file);
+        if (!ok) {
+            ::operator delete(buffer, std::align_val_t(payloadAlignment));
+            return false;
+        }
+
+        _mapping = buffer;
+        _mappingSize = static_cast<std::size_t>(size);
+        _mapped = false;
+#endif
+
+        FileHeader header;
+        std::memcpy(&header, _mapping, sizeof(header));
+        const bool headerValid = std::memcmp(header.magic, magic, sizeof(magic)) == 0
+            && header.version >= 1 && header.version <= version
+            && header.endianTag == endianTag
+            && header.tableOffset <= _mappingSize
+            && header.entryCount <= (_mappingSize - header.tableOffset) / sizeof(FileEntry);
+        if (!headerValid) {
+            close();
+            return false;
+        }
+
+        _entries.reserve(header.entryCount);
+        for (std::uint64_t i = 0; i < header.entryCount; i++) {
+            FileEntry record;
+            std::memcpy(&record, _mapping + header.tableOffset + i * sizeof(FileEntry), sizeof(record));
+            record.name[BinaryEntry::maxNameLength] = '\0';
+
+            BinaryEntry entry {record.name, static_cast<ArrayKind>(record.kind), static_cast<ScalarType>(record.scalar),
+                static_cast<int>(record.elementRows), static_cast<int>(record.elementCols), record.rows, record.cols,
+                static_cast<StorageOrder>(record.order), record.count, record.offset, record.bytes};
+
+            const bool entryValid = entry.offset % payloadAlignment == 0
+                && entry.offset <= _mappingSize && shapeValid(entry, _mappingSize - entry.offset)
+                && (entry.order == StorageOrder::RowMajor || entry.order == StorageOrder::ColumnMajor);
+            if (!entryValid) {
+                close();
+                return false;
+            }
+            _entries.push_back(std::move(entry));
+        }
+        return true;
+    }
+
+    void BinaryReader::close()
+    {
+        if (_mapping != nullptr) {
+#if defined(MATHLIB_MMAP)
+            if (_mapped)
+                ::munmap(const_cast<unsigned char*>(_mapping), _mappingSize);
+#endif
+            if (!_mapped)
+                ::operator delete(const_cast<unsigned char*>(_mapping), std::align_val_t(payloadAlignment));
+        }
+
+        _mapping = nullptr;
+        _mappingSize = 0;
+        _mapped = false;
+        _entries.clear();
+    }
+
+    const BinaryEntry *BinaryReader::find(const std::string &name) const
+    {
+        for (const BinaryEntry &entry : _entries)
+            if (entry.name == name)
+                return &entry;
+        return nullptr;
+    }
+
+    const void *BinaryReader::payload(const std::string &name, ArrayKind kind, ScalarType scalar, int elementRows, int elementCols,
+            const BinaryEntry **entry) const
+    {
+        const BinaryEntry *found = find(name);
+        if (found == nullptr || found->kind != kind || found->scalar != scalar
+                || found->elementRows != elementRows || found->elementCols != elementCols || found->count == 0)
+            return nullptr;
+
+        if (entry != nullptr)
+            *entry = found;
+        return _mapping + found->offset;
+    }
+}
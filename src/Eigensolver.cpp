@@ -0,0 +1,47 @@
+#include "../include/Eigensolver.h"
+
+#include "../include/ThreadPool.h"
+
+namespace mathlib {
+    namespace {
+        // batches below this many matrices are solved on the calling thread only
+        constexpr std::size_t eigenParallelThreshold = 1 << 12;
+
+        template<typename T>
+            void eigenBatch(const Matrix<3, 3, T> *a, Vector<3, T> *values, Matrix<3, 3, T> *vectors, std::size_t count)
+            {
+                MATHLIB_TIME(EigenSymmetric3, count);
+                auto kernel = [&](std::size_t first, std::size_t last) {
+                    for (std::size_t n = first; n < last; n++) {
+                        T in[3][3], lambda[3], v[3][3];
+                        for (int i = 0; i < 3; i++)
+                            for (int j = 0; j <= i; j++)
+                                in[i][j] = a[n][i][j];
+                        detail::symmetricEigen3(in, lambda, vectors ? v : nullptr);
+                        for (int i = 0; i < 3; i++)
+                            values[n][i] = lambda[i];
+                        if (vectors)
+                            for (int i = 0; i < 3; i++)
+                                for (int j = 0; j < 3; j++)
+                                    vectors[n][i][j] = v[i][j];
+                    }
+                };
+
+                if (count < eigenParallelThreshold || ThreadPool::global().size() == 1) {
+                    kernel(0, count);
+                    return;
+                }
+                ThreadPool::global().parallelFor(0, count, eigenParallelThreshold / 4, kernel);
+            }
+    }
+
+    void eigenSymmetric(const Matrix3f *a, Vector<3, float> *values, Matrix3f *vectors, std::size_t count)
+    {
+        eigenBatch(a, values, vectors, count);
+    }
+
+    void eigenSymmetric(const Matrix3d *a, Vector<3, double> *values, Matrix3d *vectors, std::size_t count)
+    {
+        eigenBatch(a, values, vectors, count);
+    }
+}
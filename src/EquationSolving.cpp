@@ -1,18 +1,22 @@
 #include "../include/EquationSolving.h"
 
+#include "SimdOps.h"
+#include "../include/Instrumentation.h"
+
 #include <cmath>
 #include <algorithm>
 
 namespace mathlib {
     bool solveQuadratic(double a, double b, double c, double &x0, double &x1)
     {
-        float discr = b * b - 4 * a * c;
+        MATHLIB_COUNT(SolveQuadratic, 1);
+        double discr = b * b - 4 * a * c;
         if (discr < 0) {
             return false;
         } else if (discr == 0) {
             x0 = x1 = -0.5 * b / a;
         } else {
-            float q = (b > 0)?
+            double q = (b > 0)?
                 -0.5 * (b + std::sqrt(discr)) :
                 -0.5 * (b - std::sqrt(discr));
             x0 = q / a;
@@ -25,4 +29,83 @@ namespace mathlib {
 
         return true;
     }
+
+    namespace {
+        // the batch kernels avoid branching on the discriminant: the square root is taken of max(discr, 0),
+        // q = -(b + sign(b) * sqrt(discr)) / 2 and the roots are sorted with min/max, a double root
+        // (discr == 0) is computed once as in the scalar version
+        template<typename T>
+            bool solveOne(T a, T b, T c, T &x0, T &x1)
+            {
+                const T discr = b * b - 4 * a * c;
+                const T q = T(-0.5) * (b + std::copysign(std::sqrt(std::max(discr, T(0))), b));
+                const T r0 = q / a;
+                const T r1 = (discr > 0) ? c / q : r0;
+                x0 = std::min(r0, r1);
+                x1 = std::max(r0, r1);
+                return discr >= 0;
+            }
+
+        template<typename T>
+            std::size_t solveQuadraticBatch(const T *a, const T *b, const T *c,
+                    T *x0, T *x1, unsigned char *valid, std::size_t count)
+            {
+                MATHLIB_TIME(SolveQuadraticBatch, count);
+                std::size_t solved = 0;
+                std::size_t n = 0;
+
+#if defined(MATHLIB_SSE2)
+                using Ops = typename detail::OpsFor<T>::type;
+                using Reg = typename Ops::Reg;
+                constexpr int width = Ops::width;
+
+                const Reg zero = Ops::broadcast(T(0));
+                const Reg four = Ops::broadcast(T(4));
+                const Reg minusHalf = Ops::broadcast(T(-0.5));
+                const Reg signMask = Ops::broadcast(T(-0.0));
+
+                for (; n + width <= count; n += width) {
+                    const Reg va = Ops::loadu(a + n);
+                    const Reg vb = Ops::loadu(b + n);
+                    const Reg vc = Ops::loadu(c + n);
+
+                    const Reg discr = Ops::sub(Ops::mul(vb, vb), Ops::mul(four, Ops::mul(va, vc)));
+                    // sqrt(max(discr, 0)) is never negative, so or-ing in the sign of b is copysign
+                    const Reg root = Ops::bitOr(Ops::sqrt(Ops::max(discr, zero)), Ops::bitAnd(vb, signMask));
+                    const Reg q = Ops::mul(minusHalf, Ops::add(vb, root));
+                    const Reg r0 = Ops::div(q, va);
+                    const Reg r1 = Ops::select(Ops::greater(discr, zero), Ops::div(vc, q), r0);
+
+                    Ops::storeu(x0 + n, Ops::min(r0, r1));
+                    Ops::storeu(x1 + n, Ops::max(r0, r1));
+
+                    const int mask = Ops::moveMask(Ops::greaterEqual(discr, zero));
+                    for (int lane = 0; lane < width; lane++) {
+                        const unsigned char bit = (mask >> lane) & 1;
+                        valid[n + lane] = bit;
+                        solved += bit;
+                    }
+                }
+#endif
+
+                for (; n < count; n++) {
+                    const bool bit = solveOne(a[n], b[n], c[n], x0[n], x1[n]);
+                    valid[n] = bit;
+                    solved += bit;
+                }
+                return solved;
+            }
+    }
+
+    std::size_t solveQuadratic(const float *a, const float *b, const float *c,
+            float *x0, float *x1, unsigned char *valid, std::size_t count)
+    {
+        return solveQuadraticBatch(a, b, c, x0, x1, valid, count);
+    }
+
+    std::size_t solveQuadratic(const double *a, const double *b, const double *c,
+            double *x0, double *x1, unsigned char *valid, std::size_t count)
+    {
+        return solveQuadraticBatch(a, b, c, x0, x1, valid, count);
+    }
 }
@@ -0,0 +1,259 @@
+#include "../include/Frustum.h"
+
+#include "SimdOps.h"
+#include "../include/ThreadPool.h"
+#include "../include/Instrumentation.h"
+
+#include <cmath>
+#include <atomic>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+namespace mathlib {
+    namespace {
+        // batches below this many volumes are culled on the calling thread only
+        constexpr std::size_t cullParallelThreshold = 1 << 15;
+        // unit of work of the parallel index compaction
+        constexpr std::size_t cullBlock = 1 << 13;
+
+        // the planes split into components, abs* hold |normal| for the box extent term
+        struct PlaneSet {
+            float nx[6], ny[6], nz[6], d[6];
+            float absX[6], absY[6], absZ[6];
+
+            explicit PlaneSet(const Frustum &frustum)
+            {
+                for (int p = 0; p < 6; p++) {
+                    const Planef &plane = frustum.planes[p];
+                    nx[p] = plane.normal[0];
+                    ny[p] = plane.normal[1];
+                    nz[p] = plane.normal[2];
+                    d[p] = plane.distance;
+                    absX[p] = std::abs(nx[p]);
+                    absY[p] = std::abs(ny[p]);
+                    absZ[p] = std::abs(nz[p]);
+                }
+            }
+        };
+
+        struct SphereBounds {
+            const float *x, *y, *z, *radius;
+
+            // a sphere is outside if its center lies further than radius behind any plane
+            bool visible(const PlaneSet &planes, std::size_t i) const
+            {
+                for (int p = 0; p < 6; p++)
+                    if (planes.nx[p] * x[i] + planes.ny[p] * y[i] + planes.nz[p] * z[i] + planes.d[p] < -radius[i])
+                        return false;
+                return true;
+            }
+
+#if defined(MATHLIB_SSE2)
+            template<typename Ops>
+                int visibleMask(const PlaneSet &planes, std::size_t i) const
+                {
+                    using Reg = typename Ops::Reg;
+                    const Reg cx = Ops::loadu(x + i), cy = Ops::loadu(y + i), cz = Ops::loadu(z + i);
+                    const Reg negRadius = Ops::sub(Ops::broadcast(0.0f), Ops::loadu(radius + i));
+
+                    Reg inside = Ops::equal(negRadius, negRadius);
+                    for (int p = 0; p < 6; p++) {
+                        const Reg distance = Ops::add(Ops::add(Ops::mul(Ops::broadcast(planes.nx[p]), cx), Ops::mul(Ops::broadcast(planes.ny[p]), cy)),
+                                Ops::add(Ops::mul(Ops::broadcast(planes.nz[p]), cz), Ops::broadcast(planes.d[p])));
+                        inside = Ops::bitAnd(inside, Ops::greaterEqual(distance, negRadius));
+                    }
+                    return Ops::moveMask(inside);
+                }
+#endif
+        };
+
+        struct BoxBounds {
+            const float *minX, *minY, *minZ, *maxX, *maxY, *maxZ;
+
+            // a box is outside if its corner furthest along the normal lies behind any plane
+            bool visible(const PlaneSet &planes, std::size_t i) const
+            {
+                const float cx = (minX[i] + maxX[i]) * 0.5f, cy = (minY[i] + maxY[i]) * 0.5f, cz = (minZ[i] + maxZ[i]) * 0.5f;
+                const float ex = (maxX[i] - minX[i]) * 0.5f, ey = (maxY[i] - minY[i]) * 0.5f, ez = (maxZ[i] - minZ[i]) * 0.5f;
+                for (int p = 0; p < 6; p++) {
+                    const float distance = planes.nx[p] * cx + planes.ny[p] * cy + planes.nz[p] * cz + planes.d[p];
+                    const float extent = planes.absX[p] * ex + planes.absY[p] * ey + planes.absZ[p] * ez;
+                    if (distance + extent < 0)
+                        return false;
+                }
+                return true;
+            }
+
+#if defined(MATHLIB_SSE2)
+            template<typename Ops>
+                int visibleMask(const PlaneSet &planes, std::size_t i) const
+                {
+                    using Reg = typename Ops::Reg;
+                    const Reg half = Ops::broadcast(0.5f);
+                    const Reg lx = Ops::loadu(minX + i), ly = Ops::loadu(minY + i), lz = Ops::loadu(minZ + i);
+                    const Reg ux = Ops::loadu(maxX + i), uy = Ops::loadu(maxY + i), uz = Ops::loadu(maxZ + i);
+                    const Reg cx = Ops::mul(Ops::add(lx, ux), half), cy = Ops::mul(Ops::add(ly, uy), half), cz = Ops::mul(Ops::add(lz, uz), half);
+                    const Reg ex = Ops::mul(Ops::sub(ux, lx), half), ey = Ops::mul(Ops::sub(uy, ly), half), ez = Ops::mul(Ops::sub(uz, lz), half);
+                    const Reg zero = Ops::broadcast(0.0f);
+
+                    Reg inside = Ops::equal(zero, zero);
+                    for (int p = 0; p < 6; p++) {
+                        const Reg distance = Ops::add(Ops::add(Ops::mul(Ops::broadcast(planes.nx[p]), cx), Ops::mul(Ops::broadcast(planes.ny[p]), cy)),
+                                Ops::add(Ops::mul(Ops::broadcast(planes.nz[p]), cz), Ops::broadcast(planes.d[p])));
+                        const Reg extent = Ops::add(Ops::add(Ops::mul(Ops::broadcast(planes.absX[p]), ex), Ops::mul(Ops::broadcast(planes.absY[p]), ey)),
+                                Ops::mul(Ops::broadcast(planes.absZ[p]), ez));
+                        inside = Ops::bitAnd(inside, Ops::greaterEqual(Ops::add(distance, extent), zero));
+                    }
+                    return Ops::moveMask(inside);
+                }
+#endif
+        };
+
+        // call emit(i, visible) for every volume in [first, last) in ascending order
+        template<typename Bounds, typename Emit>
+            void testRange(const PlaneSet &planes, const Bounds &bounds, std::size_t first, std::size_t last, Emit emit)
+            {
+                std::size_t i = first;
+#if defined(MATHLIB_SSE2)
+                using Ops = detail::FloatOps;
+                for (; i + Ops::width <= last; i += Ops::width) {
+                    const int mask = bounds.template visibleMask<Ops>(planes, i);
+                    for (int lane = 0; lane < Ops::width; lane++)
+                        emit(i + lane, (mask >> lane) & 1);
+                }
+#endif
+                for (; i < last; i++)
+                    emit(i, bounds.visible(planes, i));
+            }
+
+        template<typename Bounds>
+            std::size_t cullToMask(const Frustum &frustum, const Bounds &bounds, std::size_t count, unsigned char *visible)
+            {
+                MATHLIB_TIME(FrustumCull, count);
+                const PlaneSet planes(frustum);
+                auto kernel = [&](std::size_t first, std::size_t last) {
+                    std::size_t found = 0;
+                    testRange(planes, bounds, first, last, [&](std::size_t i, int bit) {
+                        visible[i] = static_cast<unsigned char>(bit);
+                        found += bit;
+                    });
+                    return found;
+                };
+
+                if (count < cullParallelThreshold || ThreadPool::global().size() == 1)
+                    return kernel(0, count);
+
+                std::atomic<std::size_t> found {0};
+                ThreadPool::global().parallelFor(0, count, cullParallelThreshold / 4, [&](std::size_t first, std::size_t last) {
+                    found += kernel(first, last);
+                });
+                return found;
+            }
+
+        // every block writes its indices to the start of its own range of indices,
+        // the blocks are then moved together in order; indices has room for count entries anyway
+        template<typename Bounds>
+            std::size_t cullToIndices(const Frustum &frustum, const Bounds &bounds, std::size_t count, std::uint32_t *indices)
+            {
+                MATHLIB_TIME(FrustumCull, count);
+                const PlaneSet planes(frustum);
+                auto kernel = [&](std::size_t first, std::size_t last) {
+                    std::uint32_t *out = indices + first;
+                    testRange(planes, bounds, first, last, [&](std::size_t i, int bit) {
+                        // written unconditionally and advanced by the bit, which keeps the loop branch-free
+                        *out = static_cast<std::uint32_t>(i);
+                        out += bit;
+                    });
+                    return static_cast<std::size_t>(out - (indices + first));
+                };
+
+                if (count < cullParallelThreshold || ThreadPool::global().size() == 1)
+                    return kernel(0, count);
+
+                const std::size_t blocks = (count + cullBlock - 1) / cullBlock;
+                std::vector<std::size_t> found(blocks);
+                ThreadPool::global().parallelFor(0, blocks, 1, [&](std::size_t first, std::size_t last) {
+                    for (std::size_t b = first; b < last; b++)
+                        found[b] = kernel(b * cullBlock, std::min(count, (b + 1) * cullBlock));
+                });
+
+                std::size_t total = found[0];
+                for (std::size_t b = 1; b < blocks; b++) {
+                    std::memmove(indices + total, indices + b * cullBlock, found[b] * sizeof(std::uint32_t));
+                    total += found[b];
+                }
+                return total;
+            }
+
+        SphereBounds sphereBounds(const VectorSoA<3, float> &centers, const float *radii)
+        {
+            return SphereBounds {centers.component(0), centers.component(1), centers.component(2), radii};
+        }
+
+        BoxBounds boxBounds(const VectorSoA<3, float> &mins, const VectorSoA<3, float> &maxs)
+        {
+            return BoxBounds {mins.component(0), mins.component(1), mins.component(2), maxs.component(0), maxs.component(1), maxs.component(2)};
+        }
+    }
+
+    Frustum::Frustum(const Matrix4 &clip)
+    {
+        // gribb/hartmann: -w <= x is (row3 + row0) . v >= 0, x <= w is (row3 - row0) . v >= 0 and so on
+        for (int p = 0; p < 6; p++) {
+            const int row = p / 2;
+            const float sign = (p % 2 == 0) ? 1.0f : -1.0f;
+            planes[p] = Planef(Vector3(clip[3][0] + sign * clip[row][0], clip[3][1] + sign * clip[row][1], clip[3][2] + sign * clip[row][2]),
+                    clip[3][3] + sign * clip[row][3]);
+            planes[p].normalize();
+        }
+    }
+
+    bool Frustum::contains(const Vector3 &point) const
+    {
+        for (const Planef &plane : planes)
+            if (plane.getSignedDistance(point) < 0)
+                return false;
+        return true;
+    }
+
+    bool Frustum::intersects(const Spheref &sphere) const
+    {
+        for (const Planef &plane : planes)
+            if (plane.getSignedDistance(sphere.center) < -sphere.radius)
+                return false;
+        return true;
+    }
+
+    bool Frustum::intersects(const AABBf &box) const
+    {
+        const Vector3 center = box.getCenter();
+        const Vector3 extent = box.getSize() * 0.5f;
+        for (const Planef &plane : planes) {
+            const float reach = std::abs(plane.normal[0]) * extent[0] + std::abs(plane.normal[1]) * extent[1] + std::abs(plane.normal[2]) * extent[2];
+            if (plane.getSignedDistance(center) + reach < 0)
+                return false;
+        }
+        return true;
+    }
+
+    std::size_t cullSpheres(const Frustum &frustum, const VectorSoA<3, float> &centers, const float *radii, unsigned char *visible)
+    {
+        return cullToMask(frustum, sphereBounds(centers, radii), centers.size(), visible);
+    }
+
+    std::size_t cullSpheres(const Frustum &frustum, const VectorSoA<3, float> &centers, const float *radii, std::uint32_t *indices)
+    {
+        return cullToIndices(frustum, sphereBounds(centers, radii), centers.size(), indices);
+    }
+
+    std::size_t cullBoxes(const Frustum &frustum, const VectorSoA<3, float> &mins, const VectorSoA<3, float> &maxs, unsigned char *visible)
+    {
+        return cullToMask(frustum, boxBounds(mins, maxs), mins.size(), visible);
+    }
+
+    std::size_t cullBoxes(const Frustum &frustum, const VectorSoA<3, float> &mins, const VectorSoA<3, float> &maxs, std::uint32_t *indices)
+    {
+        return cullToIndices(frustum, boxBounds(mins, maxs), mins.size(), indices);
+    }
+}
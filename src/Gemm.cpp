@@ -0,0 +1,447 @@
+#include "../include/Gemm.h"
+
+#include "../include/Memory.h"
+#include "../include/Simd.h"
+#include "../include/Instrumentation.h"
+#include "../include/ThreadPool.h"
+
+#include <algorithm>
+
+namespace mathlib {
+    namespace {
+        // thin wrappers over the widest available registers
+#if defined(MATHLIB_AVX)
+        struct FloatPack {
+            using Reg = __m256;
+            static constexpr int width = 8;
+            static Reg zero() { return _mm256_setzero_ps(); }
+            static Reg broadcast(float v) { return _mm256_set1_ps(v); }
+            static Reg load(const float *p) { return _mm256_load_ps(p); }
+            static Reg loadu(const float *p) { return _mm256_loadu_ps(p); }
+            static Reg add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+            static void store(float *p, Reg r) { _mm256_store_ps(p, r); }
+#if defined(__FMA__)
+            static Reg madd(Reg a, Reg b, Reg c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+            static Reg madd(Reg a, Reg b, Reg c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+        };
+
+        struct DoublePack {
+            using Reg = __m256d;
+            static constexpr int width = 4;
+            static Reg zero() { return _mm256_setzero_pd(); }
+            static Reg broadcast(double v) { return _mm256_set1_pd(v); }
+            static Reg load(const double *p) { return _mm256_load_pd(p); }
+            static Reg loadu(const double *p) { return _mm256_loadu_pd(p); }
+            static Reg add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+            static void store(double *p, Reg r) { _mm256_store_pd(p, r); }
+#if defined(__FMA__)
+            static Reg madd(Reg a, Reg b, Reg c) { return _mm256_fmadd_pd(a, b, c); }
+#else
+            static Reg madd(Reg a, Reg b, Reg c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+#endif
+        };
+#elif defined(MATHLIB_SSE2)
+        struct FloatPack {
+            using Reg = __m128;
+            static constexpr int width = 4;
+            static Reg zero() { return _mm_setzero_ps(); }
+            static Reg broadcast(float v) { return _mm_set1_ps(v); }
+            static Reg load(const float *p) { return _mm_load_ps(p); }
+            static Reg loadu(const float *p) { return _mm_loadu_ps(p); }
+            static Reg add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+            static void store(float *p, Reg r) { _mm_store_ps(p, r); }
+            static Reg madd(Reg a, Reg b, Reg c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        };
+
+        struct DoublePack {
+            using Reg = __m128d;
+            static constexpr int width = 2;
+            static Reg zero() { return _mm_setzero_pd(); }
+            static Reg broadcast(double v) { return _mm_set1_pd(v); }
+            static Reg load(const double *p) { return _mm_load_pd(p); }
+            static Reg loadu(const double *p) { return _mm_loadu_pd(p); }
+            static Reg add(Reg a, Reg b) { return _mm_add_pd(a, b); }
+            static void store(double *p, Reg r) { _mm_store_pd(p, r); }
+            static Reg madd(Reg a, Reg b, Reg c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+        };
+#else
+        template<typename T>
+            struct ScalarPack {
+                using Reg = T;
+                static constexpr int width = 1;
+                static Reg zero() { return 0; }
+                static Reg broadcast(T v) { return v; }
+                static Reg load(const T *p) { return *p; }
+                static Reg loadu(const T *p) { return *p; }
+                static Reg add(Reg a, Reg b) { return a + b; }
+                static void store(T *p, Reg r) { *p = r; }
+                static Reg madd(Reg a, Reg b, Reg c) { return a * b + c; }
+            };
+
+        using FloatPack = ScalarPack<float>;
+        using DoublePack = ScalarPack<double>;
+#endif
+
+        template<typename T>
+            struct PackFor;
+
+        template<>
+            struct PackFor<float> {
+                using type = FloatPack;
+            };
+
+        template<>
+            struct PackFor<double> {
+                using type = DoublePack;
+            };
+
+        // block sizes: a kc x nr panel of b stays in l1, an mc x kc block of a in l2
+        // and a kc x nc block of b in l3; mr x nr is the register tile of the micro kernel
+        template<typename T>
+            struct Blocking {
+                using Pack = typename PackFor<T>::type;
+                static constexpr int mr = 4;
+                static constexpr int nr = 2 * Pack::width;
+                static constexpr int kc = 256;
+                static constexpr int mc = 128 * 4 / sizeof(T);
+                static constexpr int nc = 4096;
+            };
+
+        // pack rows [0, mc) x cols [0, kc) of a into panels of mr rows, zero-padding the last panel
+        template<typename T>
+            void packA(int mc, int kc, const T *a, std::ptrdiff_t rsa, std::ptrdiff_t csa, T *packed)
+            {
+                constexpr int mr = Blocking<T>::mr;
+                for (int ir = 0; ir < mc; ir += mr) {
+                    const int rows = std::min(mr, mc - ir);
+                    for (int p = 0; p < kc; p++) {
+                        for (int i = 0; i < rows; i++)
+                            packed[i] = a[(ir + i) * rsa + p * csa];
+                        for (int i = rows; i < mr; i++)
+                            packed[i] = 0;
+                        packed += mr;
+                    }
+                }
+            }
+
+        // pack rows [0, kc) x cols [0, nc) of b into panels of nr columns, zero-padding the last panel
+        template<typename T>
+            void packB(int kc, int nc, const T *b, std::ptrdiff_t rsb, std::ptrdiff_t csb, T *packed)
+            {
+                constexpr int nr = Blocking<T>::nr;
+                for (int jr = 0; jr < nc; jr += nr) {
+                    const int cols = std::min(nr, nc - jr);
+                    for (int p = 0; p < kc; p++) {
+                        for (int j = 0; j < cols; j++)
+                            packed[j] = b[p * rsb + (jr + j) * csb];
+                        for (int j = cols; j < nr; j++)
+                            packed[j] = 0;
+                        packed += nr;
+                    }
+                }
+            }
+
+        // ab = pa * pb for one mr x nr tile, accumulated entirely in registers
+        template<typename T>
+            void microKernel(int kc, const T *pa, const T *pb, T *ab)
+            {
+                using P = typename Blocking<T>::Pack;
+                constexpr int w = P::width;
+
+                typename P::Reg c00 = P::zero(), c01 = P::zero();
+                typename P::Reg c10 = P::zero(), c11 = P::zero();
+                typename P::Reg c20 = P::zero(), c21 = P::zero();
+                typename P::Reg c30 = P::zero(), c31 = P::zero();
+
+                for (int p = 0; p < kc; p++) {
+                    const typename P::Reg b0 = P::load(pb);
+                    const typename P::Reg b1 = P::load(pb + w);
+
+                    typename P::Reg a = P::broadcast(pa[0]);
+                    c00 = P::madd(a, b0, c00);
+                    c01 = P::madd(a, b1, c01);
+                    a = P::broadcast(pa[1]);
+                    c10 = P::madd(a, b0, c10);
+                    c11 = P::madd(a, b1, c11);
+                    a = P::broadcast(pa[2]);
+                    c20 = P::madd(a, b0, c20);
+                    c21 = P::madd(a, b1, c21);
+                    a = P::broadcast(pa[3]);
+                    c30 = P::madd(a, b0, c30);
+                    c31 = P::madd(a, b1, c31);
+
+                    pa += 4;
+                    pb += 2 * w;
+                }
+
+                P::store(ab, c00);
+                P::store(ab + w, c01);
+                P::store(ab + 2 * w, c10);
+                P::store(ab + 3 * w, c11);
+                P::store(ab + 4 * w, c20);
+                P::store(ab + 5 * w, c21);
+                P::store(ab + 6 * w, c30);
+                P::store(ab + 7 * w, c31);
+            }
+
+        // c = alpha * packedA * packedB + beta * c for one mc x nc block
+        template<typename T>
+            void macroKernel(int mc, int nc, int kc, T alpha, const T *packedA, const T *packedB,
+                    T beta, T *c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+            {
+                constexpr int mr = Blocking<T>::mr;
+                constexpr int nr = Blocking<T>::nr;
+                static_assert(mr == 4, "the micro kernel is written for four rows");
+
+                alignas(64) T ab[mr * nr];
+                for (int jr = 0; jr < nc; jr += nr) {
+                    const int cols = std::min(nr, nc - jr);
+                    for (int ir = 0; ir < mc; ir += mr) {
+                        const int rows = std::min(mr, mc - ir);
+                        microKernel(kc, packedA + ir * kc, packedB + jr * kc, ab);
+
+                        T *tile = c + ir * rsc + jr * csc;
+                        for (int i = 0; i < rows; i++) {
+                            for (int j = 0; j < cols; j++) {
+                                T &dst = tile[i * rsc + j * csc];
+                                dst = (beta == T(0)) ? alpha * ab[i * nr + j] : alpha * ab[i * nr + j] + beta * dst;
+                            }
+                        }
+                    }
+                }
+            }
+
+        // products with fewer multiply-adds run on the calling thread only
+        constexpr double gemmParallelThreshold = 64.0 * 64.0 * 64.0;
+        constexpr double gemvParallelThreshold = 256.0 * 256.0;
+
+        int ceilDiv(int a, int b)
+        {
+            return (a + b - 1) / b;
+        }
+
+        // per-thread buffer for the packed block of a, reused across calls
+        template<typename T>
+            T *packBufferA(std::size_t size)
+            {
+                thread_local AlignedBuffer<T> buffer;
+                if (buffer.size() < size)
+                    buffer.resize(size);
+                return buffer.data();
+            }
+
+        template<typename T>
+            void blockedGemm(int m, int n, int k,
+                    T alpha, const T *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                    const T *b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+                    T beta, T *c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+            {
+                MATHLIB_TIME(Gemm, static_cast<std::uint64_t>(m) * n * k);
+                using B = Blocking<T>;
+                if (m <= 0 || n <= 0)
+                    return;
+
+                if (k <= 0 || alpha == T(0)) {
+                    for (int i = 0; i < m; i++)
+                        for (int j = 0; j < n; j++)
+                            c[i * rsc + j * csc] = (beta == T(0)) ? T(0) : beta * c[i * rsc + j * csc];
+                    return;
+                }
+
+                // small products never touch the pool, the first of them must not start its workers
+                const int threads = (static_cast<double>(m) * n * k >= gemmParallelThreshold) ? ThreadPool::global().size() : 1;
+                const bool parallel = threads > 1;
+
+                // with several threads the blocks of a shrink so that every thread gets one
+                const int mcBlock = std::min(B::mc, ceilDiv(ceilDiv(m, threads), B::mr) * B::mr);
+                const int ncMax = std::min(B::nc, ceilDiv(n, B::nr) * B::nr);
+                const int kcMax = std::min(B::kc, k);
+                AlignedBuffer<T> packedB(static_cast<std::size_t>(ncMax) * kcMax);
+
+                for (int jc = 0; jc < n; jc += B::nc) {
+                    const int nc = std::min(B::nc, n - jc);
+                    const int panels = ceilDiv(nc, B::nr);
+                    for (int pc = 0; pc < k; pc += B::kc) {
+                        const int kc = std::min(B::kc, k - pc);
+                        const T *bBlock = b + pc * rsb + jc * csb;
+
+                        // the first slice of k applies beta, the following ones accumulate
+                        const T blockBeta = (pc == 0) ? beta : T(1);
+
+                        if (!parallel) {
+                            packB(kc, nc, bBlock, rsb, csb, packedB.data());
+                            T *packedA = packBufferA<T>(static_cast<std::size_t>(mcBlock) * kc);
+                            for (int ic = 0; ic < m; ic += mcBlock) {
+                                const int mc = std::min(mcBlock, m - ic);
+                                packA(mc, kc, a + ic * rsa + pc * csa, rsa, csa, packedA);
+                                macroKernel(mc, nc, kc, alpha, packedA, packedB.data(),
+                                        blockBeta, c + ic * rsc + jc * csc, rsc, csc);
+                            }
+                            continue;
+                        }
+
+                        // pack the panels of b in parallel
+                        ThreadPool::global().parallelFor(0, panels, 1, [&](std::size_t first, std::size_t last) {
+                            const int j0 = static_cast<int>(first) * B::nr;
+                            const int j1 = std::min(nc, static_cast<int>(last) * B::nr);
+                            packB(kc, j1 - j0, bBlock + j0 * csb, rsb, csb, packedB.data() + j0 * kc);
+                        });
+
+                        // one task per block of a and group of b panels; the groups only
+                        // split further when there are fewer blocks of a than threads
+                        const int mBlocks = ceilDiv(m, mcBlock);
+                        const int groups = std::max(1, std::min(ceilDiv(2 * threads, mBlocks), ceilDiv(panels, 4)));
+                        const int panelsPerGroup = ceilDiv(panels, groups);
+                        ThreadPool::global().parallelFor(0, static_cast<std::size_t>(mBlocks) * groups, 1, [&](std::size_t first, std::size_t last) {
+                            T *packedA = packBufferA<T>(static_cast<std::size_t>(mcBlock) * kc);
+                            int packedBlock = -1;
+                            for (std::size_t task = first; task < last; task++) {
+                                const int block = static_cast<int>(task) / groups;
+                                const int group = static_cast<int>(task) % groups;
+                                const int ic = block * mcBlock;
+                                const int mc = std::min(mcBlock, m - ic);
+                                const int j0 = group * panelsPerGroup * B::nr;
+                                const int j1 = std::min(nc, (group + 1) * panelsPerGroup * B::nr);
+                                if (j0 >= j1)
+                                    continue;
+
+                                if (packedBlock != block) {
+                                    packA(mc, kc, a + ic * rsa + pc * csa, rsa, csa, packedA);
+                                    packedBlock = block;
+                                }
+                                macroKernel(mc, j1 - j0, kc, alpha, packedA, packedB.data() + j0 * kc,
+                                        blockBeta, c + ic * rsc + (jc + j0) * csc, rsc, csc);
+                            }
+                        });
+                    }
+                }
+            }
+
+        // y[first, last) for a matrix with contiguous rows: one dot product per row
+        template<typename T>
+            void gemvRows(int first, int last, int n, T alpha, const T *a, std::ptrdiff_t rsa,
+                    const T *x, T beta, T *y)
+            {
+                using P = typename PackFor<T>::type;
+                constexpr int w = P::width;
+
+                for (int i = first; i < last; i++) {
+                    const T *row = a + i * rsa;
+                    typename P::Reg acc0 = P::zero(), acc1 = P::zero();
+                    int j = 0;
+                    for (; j + 2 * w <= n; j += 2 * w) {
+                        acc0 = P::madd(P::loadu(row + j), P::loadu(x + j), acc0);
+                        acc1 = P::madd(P::loadu(row + j + w), P::loadu(x + j + w), acc1);
+                    }
+
+                    alignas(64) T lanes[w];
+                    P::store(lanes, P::add(acc0, acc1));
+                    T sum = 0;
+                    for (int l = 0; l < w; l++)
+                        sum += lanes[l];
+                    for (; j < n; j++)
+                        sum += row[j] * x[j];
+
+                    y[i] = (beta == T(0)) ? alpha * sum : alpha * sum + beta * y[i];
+                }
+            }
+
+        // y[first, last) for a matrix with contiguous columns: y accumulates scaled columns
+        template<typename T>
+            void gemvColumns(int first, int last, int n, T alpha, const T *a, std::ptrdiff_t csa,
+                    const T *x, T beta, T *y)
+            {
+                using P = typename PackFor<T>::type;
+                constexpr int w = P::width;
+                constexpr int rowBlock = 256;
+
+                alignas(64) T acc[rowBlock];
+                for (int i0 = first; i0 < last; i0 += rowBlock) {
+                    const int rows = std::min(rowBlock, last - i0);
+                    std::fill(acc, acc + rows, T(0));
+
+                    for (int j = 0; j < n; j++) {
+                        const T *col = a + j * csa + i0;
+                        const typename P::Reg xj = P::broadcast(x[j]);
+                        int i = 0;
+                        for (; i + w <= rows; i += w)
+                            P::store(acc + i, P::madd(P::loadu(col + i), xj, P::load(acc + i)));
+                        for (; i < rows; i++)
+                            acc[i] += col[i] * x[j];
+                    }
+
+                    for (int i = 0; i < rows; i++)
+                        y[i0 + i] = (beta == T(0)) ? alpha * acc[i] : alpha * acc[i] + beta * y[i0 + i];
+                }
+            }
+
+        template<typename T>
+            void gemvStrided(int first, int last, int n, T alpha, const T *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                    const T *x, T beta, T *y)
+            {
+                for (int i = first; i < last; i++) {
+                    T sum = 0;
+                    for (int j = 0; j < n; j++)
+                        sum += a[i * rsa + j * csa] * x[j];
+                    y[i] = (beta == T(0)) ? alpha * sum : alpha * sum + beta * y[i];
+                }
+            }
+
+        template<typename T>
+            void parallelGemv(int m, int n, T alpha, const T *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                    const T *x, T beta, T *y)
+            {
+                MATHLIB_TIME(Gemv, static_cast<std::uint64_t>(m) * n);
+                const auto rows = [&](std::size_t first, std::size_t last) {
+                    const int i0 = static_cast<int>(first), i1 = static_cast<int>(last);
+                    if (csa == 1)
+                        gemvRows(i0, i1, n, alpha, a, rsa, x, beta, y);
+                    else if (rsa == 1)
+                        gemvColumns(i0, i1, n, alpha, a, csa, x, beta, y);
+                    else
+                        gemvStrided(i0, i1, n, alpha, a, rsa, csa, x, beta, y);
+                };
+
+                if (static_cast<double>(m) * n < gemvParallelThreshold || ThreadPool::global().size() == 1) {
+                    rows(0, m);
+                    return;
+                }
+
+                // rows per chunk keep each task at no less than a few thousand multiply-adds
+                const std::size_t grain = std::max(16, ceilDiv(4096, std::max(n, 1)));
+                ThreadPool::global().parallelFor(0, m, grain, rows);
+            }
+    }
+
+    void gemm(int m, int n, int k,
+            float alpha, const float *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+            const float *b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+            float beta, float *c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+    {
+        blockedGemm(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, rsc, csc);
+    }
+
+    void gemm(int m, int n, int k,
+            double alpha, const double *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+            const double *b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+            double beta, double *c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+    {
+        blockedGemm(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, rsc, csc);
+    }
+
+    void gemv(int m, int n,
+            float alpha, const float *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+            const float *x, float beta, float *y)
+    {
+        parallelGemv(m, n, alpha, a, rsa, csa, x, beta, y);
+    }
+
+    void gemv(int m, int n,
+            double alpha, const double *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+            const double *x, double beta, double *y)
+    {
+        parallelGemv(m, n, alpha, a, rsa, csa, x, beta, y);
+    }
+}
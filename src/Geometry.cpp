@@ -0,0 +1,226 @@
+#include "../include/Geometry.h"
+
+#include "SimdOps.h"
+#include "../include/Instrumentation.h"
+
+#include <type_traits>
+
+namespace mathlib {
+    namespace {
+        // the packet kernels evaluate every test branch-free over a chunk of lanes and turn the compare
+        // results into a lane mask; the new distances are stored once and copied only into the lanes that hit
+#if defined(MATHLIB_SSE2)
+        // chunks of the widest register that divides the packet width, 4-ray packets stay on sse with avx
+        template<int width>
+            using PacketOps = std::conditional_t<width % detail::FloatOps::width == 0, detail::FloatOps, detail::FloatOps128>;
+#endif
+
+        template<int width>
+            void updateDistances(RayPacket<width> &packet, const float *t, std::uint32_t hits)
+            {
+                for (int lane = 0; lane < width; lane++)
+                    if ((hits >> lane) & 1)
+                        packet.tMax[lane] = t[lane];
+            }
+
+        template<int width>
+            std::uint32_t intersectBox(const RayPacket<width> &packet, const AABBf &box, std::uint32_t active)
+            {
+                MATHLIB_COUNT(RayPacketIntersect, width);
+                std::uint32_t hits = 0;
+
+#if defined(MATHLIB_SSE2)
+                using Ops = PacketOps<width>;
+                using Reg = typename Ops::Reg;
+
+                const Reg zero = Ops::broadcast(0.0f);
+                const Reg minX = Ops::broadcast(box.min[0]), minY = Ops::broadcast(box.min[1]), minZ = Ops::broadcast(box.min[2]);
+                const Reg maxX = Ops::broadcast(box.max[0]), maxY = Ops::broadcast(box.max[1]), maxZ = Ops::broadcast(box.max[2]);
+
+                for (int i = 0; i < width; i += Ops::width) {
+                    const Reg ox = Ops::loadu(packet.originX + i), oy = Ops::loadu(packet.originY + i), oz = Ops::loadu(packet.originZ + i);
+                    const Reg ix = Ops::loadu(packet.inverseX + i), iy = Ops::loadu(packet.inverseY + i), iz = Ops::loadu(packet.inverseZ + i);
+
+                    const Reg x0 = Ops::mul(Ops::sub(minX, ox), ix), x1 = Ops::mul(Ops::sub(maxX, ox), ix);
+                    const Reg y0 = Ops::mul(Ops::sub(minY, oy), iy), y1 = Ops::mul(Ops::sub(maxY, oy), iy);
+                    const Reg z0 = Ops::mul(Ops::sub(minZ, oz), iz), z1 = Ops::mul(Ops::sub(maxZ, oz), iz);
+
+                    const Reg tNear = Ops::max(Ops::max(zero, Ops::min(x0, x1)), Ops::max(Ops::min(y0, y1), Ops::min(z0, z1)));
+                    const Reg tFar = Ops::min(Ops::min(Ops::loadu(packet.tMax + i), Ops::max(x0, x1)), Ops::min(Ops::max(y0, y1), Ops::max(z0, z1)));
+
+                    hits |= static_cast<std::uint32_t>(Ops::moveMask(Ops::greaterEqual(tFar, tNear))) << i;
+                }
+#else
+                for (int lane = 0; lane < width; lane++) {
+                    float t;
+                    if (intersect(packet.get(lane), box, t) && t <= packet.tMax[lane])
+                        hits |= std::uint32_t(1) << lane;
+                }
+#endif
+
+                return hits & active;
+            }
+
+        template<int width>
+            std::uint32_t intersectSphere(RayPacket<width> &packet, const Spheref &sphere, std::uint32_t active)
+            {
+                MATHLIB_COUNT(RayPacketIntersect, width);
+                std::uint32_t hits = 0;
+                alignas(64) float t[width];
+
+#if defined(MATHLIB_SSE2)
+                using Ops = PacketOps<width>;
+                using Reg = typename Ops::Reg;
+
+                const Reg zero = Ops::broadcast(0.0f);
+                const Reg four = Ops::broadcast(4.0f);
+                const Reg minusHalf = Ops::broadcast(-0.5f);
+                const Reg signMask = Ops::broadcast(-0.0f);
+                const Reg cx = Ops::broadcast(sphere.center[0]), cy = Ops::broadcast(sphere.center[1]), cz = Ops::broadcast(sphere.center[2]);
+                const Reg radius2 = Ops::broadcast(sphere.radius * sphere.radius);
+
+                for (int i = 0; i < width; i += Ops::width) {
+                    const Reg dx = Ops::loadu(packet.directionX + i), dy = Ops::loadu(packet.directionY + i), dz = Ops::loadu(packet.directionZ + i);
+                    const Reg ocx = Ops::sub(Ops::loadu(packet.originX + i), cx);
+                    const Reg ocy = Ops::sub(Ops::loadu(packet.originY + i), cy);
+                    const Reg ocz = Ops::sub(Ops::loadu(packet.originZ + i), cz);
+
+                    const Reg a = Ops::add(Ops::add(Ops::mul(dx, dx), Ops::mul(dy, dy)), Ops::mul(dz, dz));
+                    const Reg halfB = Ops::add(Ops::add(Ops::mul(dx, ocx), Ops::mul(dy, ocy)), Ops::mul(dz, ocz));
+                    const Reg b = Ops::add(halfB, halfB);
+                    const Reg c = Ops::sub(Ops::add(Ops::add(Ops::mul(ocx, ocx), Ops::mul(ocy, ocy)), Ops::mul(ocz, ocz)), radius2);
+
+                    // the stable root pair of solveQuadratic
+                    const Reg discr = Ops::sub(Ops::mul(b, b), Ops::mul(four, Ops::mul(a, c)));
+                    const Reg root = Ops::bitOr(Ops::sqrt(Ops::max(discr, zero)), Ops::bitAnd(b, signMask));
+                    const Reg q = Ops::mul(minusHalf, Ops::add(b, root));
+                    const Reg r0 = Ops::div(q, a);
+                    const Reg r1 = Ops::select(Ops::greater(discr, zero), Ops::div(c, q), r0);
+                    const Reg near = Ops::min(r0, r1);
+                    const Reg far = Ops::max(r0, r1);
+
+                    // inside the sphere only the far root lies in front of the origin
+                    const Reg hit = Ops::select(Ops::greaterEqual(near, zero), near, far);
+                    Ops::storeu(t + i, hit);
+
+                    const Reg mask = Ops::bitAnd(Ops::bitAnd(Ops::greaterEqual(discr, zero), Ops::greaterEqual(hit, zero)),
+                            Ops::greater(Ops::loadu(packet.tMax + i), hit));
+                    hits |= static_cast<std::uint32_t>(Ops::moveMask(mask)) << i;
+                }
+#else
+                for (int lane = 0; lane < width; lane++)
+                    if (intersect(packet.get(lane), sphere, t[lane]) && t[lane] < packet.tMax[lane])
+                        hits |= std::uint32_t(1) << lane;
+#endif
+
+                hits &= active;
+                updateDistances(packet, t, hits);
+                return hits;
+            }
+
+        template<int width>
+            std::uint32_t intersectTriangle(RayPacket<width> &packet, const Trianglef &triangle, std::uint32_t active)
+            {
+                MATHLIB_COUNT(RayPacketIntersect, width);
+                std::uint32_t hits = 0;
+                alignas(64) float t[width];
+
+#if defined(MATHLIB_SSE2)
+                using Ops = PacketOps<width>;
+                using Reg = typename Ops::Reg;
+
+                const Vector3 edge1 = triangle.b - triangle.a;
+                const Vector3 edge2 = triangle.c - triangle.a;
+
+                const Reg zero = Ops::broadcast(0.0f);
+                const Reg one = Ops::broadcast(1.0f);
+                const Reg ax = Ops::broadcast(triangle.a[0]), ay = Ops::broadcast(triangle.a[1]), az = Ops::broadcast(triangle.a[2]);
+                const Reg e1x = Ops::broadcast(edge1[0]), e1y = Ops::broadcast(edge1[1]), e1z = Ops::broadcast(edge1[2]);
+                const Reg e2x = Ops::broadcast(edge2[0]), e2y = Ops::broadcast(edge2[1]), e2z = Ops::broadcast(edge2[2]);
+
+                for (int i = 0; i < width; i += Ops::width) {
+                    const Reg dx = Ops::loadu(packet.directionX + i), dy = Ops::loadu(packet.directionY + i), dz = Ops::loadu(packet.directionZ + i);
+
+                    // p = direction x edge2
+                    const Reg px = Ops::sub(Ops::mul(dy, e2z), Ops::mul(dz, e2y));
+                    const Reg py = Ops::sub(Ops::mul(dz, e2x), Ops::mul(dx, e2z));
+                    const Reg pz = Ops::sub(Ops::mul(dx, e2y), Ops::mul(dy, e2x));
+                    // a zero determinant (ray parallel to the triangle) makes u, v infinite or nan, failing the tests below
+                    const Reg determinant = Ops::add(Ops::add(Ops::mul(e1x, px), Ops::mul(e1y, py)), Ops::mul(e1z, pz));
+                    const Reg inverse = Ops::div(one, determinant);
+
+                    const Reg sx = Ops::sub(Ops::loadu(packet.originX + i), ax);
+                    const Reg sy = Ops::sub(Ops::loadu(packet.originY + i), ay);
+                    const Reg sz = Ops::sub(Ops::loadu(packet.originZ + i), az);
+                    const Reg u = Ops::mul(Ops::add(Ops::add(Ops::mul(sx, px), Ops::mul(sy, py)), Ops::mul(sz, pz)), inverse);
+
+                    // q = s x edge1
+                    const Reg qx = Ops::sub(Ops::mul(sy, e1z), Ops::mul(sz, e1y));
+                    const Reg qy = Ops::sub(Ops::mul(sz, e1x), Ops::mul(sx, e1z));
+                    const Reg qz = Ops::sub(Ops::mul(sx, e1y), Ops::mul(sy, e1x));
+                    const Reg v = Ops::mul(Ops::add(Ops::add(Ops::mul(dx, qx), Ops::mul(dy, qy)), Ops::mul(dz, qz)), inverse);
+                    const Reg hit = Ops::mul(Ops::add(Ops::add(Ops::mul(e2x, qx), Ops::mul(e2y, qy)), Ops::mul(e2z, qz)), inverse);
+                    Ops::storeu(t + i, hit);
+
+                    const Reg inside = Ops::bitAnd(Ops::bitAnd(Ops::greaterEqual(u, zero), Ops::greaterEqual(v, zero)),
+                            Ops::greaterEqual(one, Ops::add(u, v)));
+                    const Reg mask = Ops::bitAnd(inside, Ops::bitAnd(Ops::greaterEqual(hit, zero), Ops::greater(Ops::loadu(packet.tMax + i), hit)));
+                    hits |= static_cast<std::uint32_t>(Ops::moveMask(mask)) << i;
+                }
+#else
+                for (int lane = 0; lane < width; lane++)
+                    if (intersect(packet.get(lane), triangle, t[lane]) && t[lane] < packet.tMax[lane])
+                        hits |= std::uint32_t(1) << lane;
+#endif
+
+                hits &= active;
+                updateDistances(packet, t, hits);
+                return hits;
+            }
+    }
+
+    std::uint32_t intersect(const RayPacket4 &packet, const AABBf &box, std::uint32_t active)
+    {
+        return intersectBox(packet, box, active);
+    }
+
+    std::uint32_t intersect(const RayPacket8 &packet, const AABBf &box, std::uint32_t active)
+    {
+        return intersectBox(packet, box, active);
+    }
+
+    std::uint32_t intersect(const RayPacket16 &packet, const AABBf &box, std::uint32_t active)
+    {
+        return intersectBox(packet, box, active);
+    }
+
+    std::uint32_t intersect(RayPacket4 &packet, const Spheref &sphere, std::uint32_t active)
+    {
+        return intersectSphere(packet, sphere, active);
+    }
+
+    std::uint32_t intersect(RayPacket8 &packet, const Spheref &sphere, std::uint32_t active)
+    {
+        return intersectSphere(packet, sphere, active);
+    }
+
+    std::uint32_t intersect(RayPacket16 &packet, const Spheref &sphere, std::uint32_t active)
+    {
+        return intersectSphere(packet, sphere, active);
+    }
+
+    std::uint32_t intersect(RayPacket4 &packet, const Trianglef &triangle, std::uint32_t active)
+    {
+        return intersectTriangle(packet, triangle, active);
+    }
+
+    std::uint32_t intersect(RayPacket8 &packet, const Trianglef &triangle, std::uint32_t active)
+    {
+        return intersectTriangle(packet, triangle, active);
+    }
+
+    std::uint32_t intersect(RayPacket16 &packet, const Trianglef &triangle, std::uint32_t active)
+    {
+        return intersectTriangle(packet, triangle, active);
+    }
+}
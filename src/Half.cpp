@@ -0,0 +1,167 @@
+#include "../include/Half.h"
+
+#include "../include/Instrumentation.h"
+
+namespace mathlib {
+    // the simd loops round with the default mxcsr mode, round to nearest even, like std::lrint in the scalar
+    // conversions; they clamp with min/max and divide by the scale, so every element matches the scalar result
+
+#if defined(MATHLIB_SSE2) && !defined(MATHLIB_F16C)
+    namespace {
+        // detail::floatToHalf on four lanes, the halves end up sign-extended in the 32-bit lanes
+        // so that _mm_packs_epi32 narrows them without saturating
+        __m128i floatToHalfSse(__m128 value)
+        {
+            const __m128i bits = _mm_castps_si128(value);
+            const __m128i sign = _mm_and_si128(bits, _mm_set1_epi32(static_cast<int>(0x80000000u)));
+            const __m128i magnitude = _mm_xor_si128(bits, sign);
+
+            // too large for a half, infinity or nan
+            const __m128i isNan = _mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x7f800000));
+            const __m128i payload = _mm_or_si128(_mm_set1_epi32(0x200), _mm_and_si128(_mm_srli_epi32(magnitude, 13), _mm_set1_epi32(0x3ff)));
+            const __m128i special = _mm_or_si128(_mm_set1_epi32(0x7c00), _mm_and_si128(isNan, payload));
+
+            // subnormal half or zero, rounded by adding 0.5f
+            const __m128i magic = _mm_set1_epi32(0x3f000000);
+            const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(magnitude), _mm_castsi128_ps(magic))), magic);
+
+            // rebiased exponent, the 13 dropped mantissa bits rounded to nearest even
+            const __m128i odd = _mm_and_si128(_mm_srli_epi32(magnitude, 13), _mm_set1_epi32(1));
+            const __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(magnitude, _mm_set1_epi32(static_cast<int>(0xc8000fffu))), odd), 13);
+
+            const __m128i isSubnormal = _mm_cmpgt_epi32(_mm_set1_epi32(0x38800000), magnitude);
+            const __m128i isRegular = _mm_cmpgt_epi32(_mm_set1_epi32(0x47800000), magnitude);
+            const __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+            const __m128i result = _mm_or_si128(_mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, special)),
+                    _mm_srli_epi32(sign, 16));
+            return _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+        }
+
+        // detail::halfToFloat on four halves zero-extended to 32-bit lanes; multiplying by 2^112 rebiases
+        // the exponent and renormalizes subnormals in one step, infinity and nan get the full exponent
+        __m128 halfToFloatSse(__m128i half)
+        {
+            const __m128i magnitude = _mm_and_si128(half, _mm_set1_epi32(0x7fff));
+            const __m128i sign = _mm_slli_epi32(_mm_xor_si128(half, magnitude), 16);
+            const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(magnitude, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+            const __m128i isInfNan = _mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x7bff));
+            const __m128i exponent = _mm_and_si128(isInfNan, _mm_set1_epi32(255 << 23));
+            return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, exponent)));
+        }
+    }
+#endif
+
+    void pack(const float *in, Half *out, std::size_t count)
+    {
+        MATHLIB_TIME(StorageConversion, count);
+        std::size_t i = 0;
+#if defined(MATHLIB_F16C)
+        for (; i + 8 <= count; i += 8)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(MATHLIB_SSE2)
+        for (; i + 8 <= count; i += 8) {
+            const __m128i low = floatToHalfSse(_mm_loadu_ps(in + i));
+            const __m128i high = floatToHalfSse(_mm_loadu_ps(in + i + 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(low, high));
+        }
+#endif
+        for (; i < count; i++)
+            out[i] = Half(in[i]);
+    }
+
+    void unpack(const Half *in, float *out, std::size_t count)
+    {
+        MATHLIB_TIME(StorageConversion, count);
+        std::size_t i = 0;
+#if defined(MATHLIB_F16C)
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+#elif defined(MATHLIB_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= count; i += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            _mm_storeu_ps(out + i, halfToFloatSse(_mm_unpacklo_epi16(v, zero)));
+            _mm_storeu_ps(out + i + 4, halfToFloatSse(_mm_unpackhi_epi16(v, zero)));
+        }
+#endif
+        for (; i < count; i++)
+            out[i] = float(in[i]);
+    }
+
+    void pack(const float *in, Snorm16 *out, std::size_t count)
+    {
+        MATHLIB_TIME(StorageConversion, count);
+        std::size_t i = 0;
+#if defined(MATHLIB_SSE2)
+        const __m128 lower = _mm_set1_ps(-1.0f);
+        const __m128 upper = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_set1_ps(Snorm16::scale);
+        for (; i + 8 <= count; i += 8) {
+            const __m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lower), upper), scale);
+            const __m128 b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), lower), upper), scale);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+        }
+#endif
+        for (; i < count; i++)
+            out[i] = Snorm16(in[i]);
+    }
+
+    void unpack(const Snorm16 *in, float *out, std::size_t count)
+    {
+        MATHLIB_TIME(StorageConversion, count);
+        std::size_t i = 0;
+#if defined(MATHLIB_SSE2)
+        const __m128 scale = _mm_set1_ps(Snorm16::scale);
+        for (; i + 8 <= count; i += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            // sign-extend by moving every value into the upper half and shifting it back down
+            const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(out + i, _mm_div_ps(_mm_cvtepi32_ps(low), scale));
+            _mm_storeu_ps(out + i + 4, _mm_div_ps(_mm_cvtepi32_ps(high), scale));
+        }
+#endif
+        for (; i < count; i++)
+            out[i] = float(in[i]);
+    }
+
+    void pack(const float *in, Unorm8 *out, std::size_t count)
+    {
+        MATHLIB_TIME(StorageConversion, count);
+        std::size_t i = 0;
+#if defined(MATHLIB_SSE2)
+        const __m128 lower = _mm_set1_ps(0.0f);
+        const __m128 upper = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_set1_ps(Unorm8::scale);
+        for (; i + 16 <= count; i += 16) {
+            __m128i v[4];
+            for (int k = 0; k < 4; k++)
+                v[k] = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4 * k), lower), upper), scale));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3])));
+        }
+#endif
+        for (; i < count; i++)
+            out[i] = Unorm8(in[i]);
+    }
+
+    void unpack(const Unorm8 *in, float *out, std::size_t count)
+    {
+        MATHLIB_TIME(StorageConversion, count);
+        std::size_t i = 0;
+#if defined(MATHLIB_SSE2)
+        const __m128 scale = _mm_set1_ps(Unorm8::scale);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= count; i += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            const __m128i low = _mm_unpacklo_epi8(v, zero);
+            const __m128i high = _mm_unpackhi_epi8(v, zero);
+            const __m128i words[4] = {_mm_unpacklo_epi16(low, zero), _mm_unpackhi_epi16(low, zero),
+                _mm_unpacklo_epi16(high, zero), _mm_unpackhi_epi16(high, zero)};
+            for (int k = 0; k < 4; k++)
+                _mm_storeu_ps(out + i + 4 * k, _mm_div_ps(_mm_cvtepi32_ps(words[k]), scale));
+        }
+#endif
+        for (; i < count; i++)
+            out[i] = float(in[i]);
+    }
+}
@@ -0,0 +1,157 @@
+#include "../include/Instrumentation.h"
+
+#include <mutex>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+namespace mathlib {
+    namespace instrumentation {
+        namespace {
+            const char *const operationNames[operationCount] = {
+                "matrix_multiply",
+                "matrix_vector_multiply",
+                "matrix_inverse",
+                "vector_normalize",
+                "solve_quadratic",
+                "solve_quadratic_batch",
+                "gemm",
+                "gemv",
+                "strassen",
+                "batch_transform",
+                "create_trs",
+                "frustum_cull",
+                "ray_packet_intersect",
+                "storage_conversion",
+                "sparse_multiply",
+                "iterative_solve",
+                "factorization",
+                "eigen_symmetric_3",
+                "symmetric_eigen",
+                "singular_value_decomposition",
+            };
+
+            // live threads register their counters here; a finishing thread folds its totals into retired
+            struct Registry {
+                std::mutex mutex;
+                std::vector<const detail::ThreadCounters*> threads;
+                Snapshot retired;
+                Snapshot baseline;
+            };
+
+            // never destroyed: threads of a pool with static storage duration (the global pool) finish
+            // after the statics of this file are gone and still unregister their counters here
+            Registry &registry()
+            {
+                static Registry *instance = new Registry;
+                return *instance;
+            }
+
+            void accumulate(Snapshot &totals, const detail::ThreadCounters &counters)
+            {
+                for (std::size_t i = 0; i < operationCount; i++) {
+                    OperationStats &stats = totals[static_cast<Operation>(i)];
+                    stats.calls += counters.calls[i].load(std::memory_order_relaxed);
+                    stats.items += counters.items[i].load(std::memory_order_relaxed);
+                    stats.nanoseconds += counters.nanoseconds[i].load(std::memory_order_relaxed);
+                }
+            }
+
+            // totals since the start of the program, registry.mutex must be held
+            Snapshot totalsLocked(const Registry &registry)
+            {
+                Snapshot totals = registry.retired;
+                for (const detail::ThreadCounters *counters : registry.threads)
+                    accumulate(totals, *counters);
+                return totals;
+            }
+        }
+
+        const char *getName(Operation operation)
+        {
+            return operationNames[static_cast<std::size_t>(operation)];
+        }
+
+        bool Snapshot::writeText(FormatWriter &writer) const
+        {
+            bool ok = true;
+            for (std::size_t i = 0; i < operationCount; i++) {
+                const OperationStats &stats = _stats[i];
+                if (stats.calls == 0)
+                    continue;
+
+                const char *name = operationNames[i];
+                const std::size_t length = std::strlen(name);
+                ok = writer.writeText(name, length) && ok;
+                for (std::size_t pad = length; pad < 30; pad++)
+                    ok = writer.writeText(" ", 1) && ok;
+                ok = writer.writeText(" calls ") && writer.write(stats.calls) && ok;
+                ok = writer.writeText(" items ") && writer.write(stats.items) && ok;
+                if (stats.nanoseconds != 0) {
+                    // milliseconds with microsecond resolution, integer arithmetic keeps the writer's float options out
+                    ok = writer.writeText(" ms ") && writer.write(stats.nanoseconds / 1000000) && ok;
+                    const std::uint64_t micros = stats.nanoseconds / 1000 % 1000;
+                    const char fraction[4] = {'.', static_cast<char>('0' + micros / 100),
+                        static_cast<char>('0' + micros / 10 % 10), static_cast<char>('0' + micros % 10)};
+                    ok = writer.writeText(fraction, 4) && ok;
+                }
+                ok = writer.writeText("\n", 1) && ok;
+            }
+            return ok;
+        }
+
+        bool Snapshot::writeJson(FormatWriter &writer) const
+        {
+            bool ok = writer.writeText("{\"enabled\": ");
+            ok = writer.writeText(isEnabled() ? "true" : "false") && ok;
+            ok = writer.writeText(", \"operations\": {") && ok;
+            for (std::size_t i = 0; i < operationCount; i++) {
+                const OperationStats &stats = _stats[i];
+                ok = writer.writeText(i == 0 ? "\n  \"" : ",\n  \"") && ok;
+                ok = writer.writeText(operationNames[i]) && ok;
+                ok = writer.writeText("\": {\"calls\": ") && writer.write(stats.calls) && ok;
+                ok = writer.writeText(", \"items\": ") && writer.write(stats.items) && ok;
+                ok = writer.writeText(", \"nanoseconds\": ") && writer.write(stats.nanoseconds) && ok;
+                ok = writer.writeText("}") && ok;
+            }
+            return writer.writeText("\n}}\n") && ok;
+        }
+
+        Snapshot takeSnapshot()
+        {
+            Registry &instance = registry();
+            std::lock_guard<std::mutex> lock(instance.mutex);
+            return totalsLocked(instance) - instance.baseline;
+        }
+
+        void reset()
+        {
+            Registry &instance = registry();
+            std::lock_guard<std::mutex> lock(instance.mutex);
+            instance.baseline = totalsLocked(instance);
+        }
+
+        namespace detail {
+            ThreadCounters::ThreadCounters()
+            {
+                Registry &instance = registry();
+                std::lock_guard<std::mutex> lock(instance.mutex);
+                instance.threads.push_back(this);
+            }
+
+            ThreadCounters::~ThreadCounters()
+            {
+                Registry &instance = registry();
+                std::lock_guard<std::mutex> lock(instance.mutex);
+                accumulate(instance.retired, *this);
+                instance.threads.erase(std::find(instance.threads.begin(), instance.threads.end(), this));
+            }
+
+            ThreadCounters &threadCounters()
+            {
+                thread_local ThreadCounters counters;
+                return counters;
+            }
+        }
+    }
+}
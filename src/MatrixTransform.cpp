@@ -1,8 +1,52 @@
 #include "../include/MatrixTransform.h"
 
 #include "../include/Convert.h"
+#include "../include/ThreadPool.h"
+#include "../include/Instrumentation.h"
+#include "../include/Trigonometry.h"
 
 namespace mathlib {
+    namespace {
+        // batches below this many matrices are built on the calling thread only
+        constexpr std::size_t trsParallelThreshold = 1 << 12;
+
+        // the columns of the rotation scaled by scale, translation in the last column
+        Matrix4 composeTRS(const Vector3 &translation, const Matrix3 &rotation, const Vector3 &scale)
+        {
+            return Matrix4 {
+                rotation[0][0] * scale.x(), rotation[0][1] * scale.y(), rotation[0][2] * scale.z(), translation.x(),
+                rotation[1][0] * scale.x(), rotation[1][1] * scale.y(), rotation[1][2] * scale.z(), translation.y(),
+                rotation[2][0] * scale.x(), rotation[2][1] * scale.y(), rotation[2][2] * scale.z(), translation.z(),
+                0.0f, 0.0f, 0.0f, 1.0f
+            };
+        }
+
+        // createRotationZ(z) * createRotationY(y) * createRotationX(x) in closed form
+        Matrix3 eulerRotation(const Vector3 &angles)
+        {
+            float sx, cx, sy, cy, sz, cz;
+            sincos(angles.x(), sx, cx);
+            sincos(angles.y(), sy, cy);
+            sincos(angles.z(), sz, cz);
+            return Matrix3 {
+                cz * cy, cz * sy * sx - sz * cx, cz * sy * cx + sz * sx,
+                sz * cy, sz * sy * sx + cz * cx, sz * sy * cx - cz * sx,
+                -sy, cy * sx, cy * cx
+            };
+        }
+
+        template<typename Kernel>
+            void forEachRange(std::size_t count, Kernel kernel)
+            {
+                if (count < trsParallelThreshold || ThreadPool::global().size() == 1) {
+                    kernel(0, count);
+                    return;
+                }
+
+                ThreadPool::global().parallelFor(0, count, trsParallelThreshold / 4, kernel);
+            }
+    }
+
     Matrix4 createPerspectiveProjection(float fov, float aspect, float clipNear, float clipFar)
     {
         // x' = x / -z
@@ -27,72 +71,49 @@ namespace mathlib {
         };
     }
 
-    Matrix4 createOrthographicProjection(float left, float right, float top, float bot, float clipNear, float clipFar)
-    {
-        return Matrix4
-        {
-            2.f / (right - left), 0.f, 0.f, -(right + left) / (right - left),
-            0.f, 2.f / (top - bot), 0.f, -(top + bot) / (top - bot),
-            0.f, 0.f, -2.f / (clipFar - clipNear), -(clipFar + clipNear) / (clipFar - clipNear),
-            0.f, 0.f, 0.f, 1.f
-        };
-    }
-
-    Matrix4 createOrthographicProjection(float left, float right, float top, float bot)
-    {
-        return Matrix4
-        {
-            2.f / (right - left), 0.f, 0.f, -(right + left) / (right - left),
-            0.f, 2.f / (top - bot), 0.f, -(top + bot) / (top - bot),
-            0.f, 0.f, 1.f, 0.f,
-            0.f, 0.f, 0.f, 1.f
-        };
-    }
-
     Matrix4 createViewMatrix(const Vector3 &position, const Vector3 &front, const Vector3 &up)
     {
+        // camera basis: right, up and backward (the camera looks down -z in view space)
+        const Vector3 f = front.getNormalized();
+        const Vector3 r = f.cross(up).getNormalized();
+        const Vector3 u = r.cross(f);
 
-    }
-
-    Matrix4 createTranslation(const Vector3 &position)
-    {
-        return Matrix4 {1.0f, 0.0f, 0.0f, position.x(),
-            0.0f, 1.0f, 0.0f, position.y(),
-            0.0f, 0.0f, 1.0f, position.z(),
+        return Matrix4 {
+            r.x(), r.y(), r.z(), -r.dot(position),
+            u.x(), u.y(), u.z(), -u.dot(position),
+            -f.x(), -f.y(), -f.z(), f.dot(position),
             0.0f, 0.0f, 0.0f, 1.0f
         };
     }
 
-    Matrix3 createTranslation(const Vector2 &position)
-    {
-        return Matrix3 {1.0f, 0.0f, position.x(),
-            0.0f, 1.0f, position.y(),
-            0.0f, 0.0f, 1.0f
-        };
-    }
-
     Matrix4 createRotationX(float angle)
     {
+        float s, c;
+        sincos(angle, s, c);
         return Matrix4 {1.0f, 0.0f, 0.0f, 0.0f,
-            0.0f, std::cos(angle), -std::sin(angle), 0.0f,
-            0.0f, std::sin(angle), std::cos(angle), 0.0f,
+            0.0f, c, -s, 0.0f,
+            0.0f, s, c, 0.0f,
             0.0f, 0.0f, 0.0f, 1.0f
         };
     }
 
     Matrix4 createRotationY(float angle)
     {
-        return Matrix4 {std::cos(angle), 0.0f, std::sin(angle), 0.0f,
+        float s, c;
+        sincos(angle, s, c);
+        return Matrix4 {c, 0.0f, s, 0.0f,
             0.0f, 1.0f, 0.0f, 0.0f,
-            -std::sin(angle), 0.0f, std::cos(angle), 0.0f,
+            -s, 0.0f, c, 0.0f,
             0.0f, 0.0f, 0.0f, 1.0f
         };
     }
 
     Matrix4 createRotationZ(float angle)
     {
-        return Matrix4 {std::cos(angle), -std::sin(angle), 0.0f, 0.0f,
-            std::sin(angle), std::cos(angle), 0.0f, 0.0f,
+        float s, c;
+        sincos(angle, s, c);
+        return Matrix4 {c, -s, 0.0f, 0.0f,
+            s, c, 0.0f, 0.0f,
             0.0f, 0.0f, 1.0f, 0.0f,
             0.0f, 0.0f, 0.0f, 1.0f
         };
@@ -100,17 +121,39 @@ namespace mathlib {
 
     Matrix3 createRotation(float angle)
     {
-        return Matrix3 {std::cos(angle), -std::sin(angle),
-            std::sin(angle), std::cos(angle) };
+        float s, c;
+        sincos(angle, s, c);
+        return Matrix3 {c, -s, 0.0f,
+            s, c, 0.0f,
+            0.0f, 0.0f, 1.0f
+        };
     }
 
-    Matrix4 createScale(const Vector3 &scale)
+    Matrix4 createTRS(const Vector3 &translation, const Quaternionf &rotation, const Vector3 &scale)
     {
-        return Matrix4 {
-            scale.x(), 0.0f, 0.0f, 0.0f,
-            0.0f, scale.y(), 0.0f, 0.0f,
-            0.0f, 0.0f, scale.z(), 0.0f,
-            0.0f, 0.0f, 0.0f, 1.0f
-        };
+        return composeTRS(translation, rotation.toMatrix3(), scale);
+    }
+
+    Matrix4 createTRS(const Vector3 &translation, const Vector3 &eulerAngles, const Vector3 &scale)
+    {
+        return composeTRS(translation, eulerRotation(eulerAngles), scale);
+    }
+
+    void createTRS(const Vector3 *translations, const Quaternionf *rotations, const Vector3 *scales, Matrix4 *out, std::size_t count)
+    {
+        MATHLIB_TIME(CreateTRS, count);
+        forEachRange(count, [=](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; i++)
+                out[i] = composeTRS(translations[i], rotations[i].toMatrix3(), scales[i]);
+        });
+    }
+
+    void createTRS(const Vector3 *translations, const Vector3 *eulerAngles, const Vector3 *scales, Matrix4 *out, std::size_t count)
+    {
+        MATHLIB_TIME(CreateTRS, count);
+        forEachRange(count, [=](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; i++)
+                out[i] = composeTRS(translations[i], eulerRotation(eulerAngles[i]), scales[i]);
+        });
     }
 }
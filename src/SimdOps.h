@@ -0,0 +1,130 @@
+#pragma once
+
+#include "../include/Simd.h"
+
+// element-wise wrappers over the widest available float and double registers for the
+// branch-free array kernels of the library; only available with MATHLIB_SSE2
+// truncate is only exact for magnitudes below 2^31
+namespace mathlib {
+    namespace detail {
+#if defined(MATHLIB_SSE2)
+        // the 128-bit variants stay available with avx for kernels that work on 4 floats at a time
+        struct FloatOps128 {
+            using Reg = __m128;
+            static constexpr int width = 4;
+            static Reg broadcast(float v) { return _mm_set1_ps(v); }
+            static Reg loadu(const float *p) { return _mm_loadu_ps(p); }
+            static void storeu(float *p, Reg r) { _mm_storeu_ps(p, r); }
+            static Reg add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+            static Reg sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+            static Reg mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+            static Reg div(Reg a, Reg b) { return _mm_div_ps(a, b); }
+            static Reg sqrt(Reg a) { return _mm_sqrt_ps(a); }
+            static Reg min(Reg a, Reg b) { return _mm_min_ps(a, b); }
+            static Reg max(Reg a, Reg b) { return _mm_max_ps(a, b); }
+            static Reg bitAnd(Reg a, Reg b) { return _mm_and_ps(a, b); }
+            static Reg bitOr(Reg a, Reg b) { return _mm_or_ps(a, b); }
+            static Reg bitXor(Reg a, Reg b) { return _mm_xor_ps(a, b); }
+            static Reg truncate(Reg a) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a)); }
+            static Reg equal(Reg a, Reg b) { return _mm_cmpeq_ps(a, b); }
+            static Reg greater(Reg a, Reg b) { return _mm_cmpgt_ps(a, b); }
+            static Reg greaterEqual(Reg a, Reg b) { return _mm_cmpge_ps(a, b); }
+            static Reg select(Reg mask, Reg a, Reg b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+            static int moveMask(Reg mask) { return _mm_movemask_ps(mask); }
+        };
+
+        struct DoubleOps128 {
+            using Reg = __m128d;
+            static constexpr int width = 2;
+            static Reg broadcast(double v) { return _mm_set1_pd(v); }
+            static Reg loadu(const double *p) { return _mm_loadu_pd(p); }
+            static void storeu(double *p, Reg r) { _mm_storeu_pd(p, r); }
+            static Reg add(Reg a, Reg b) { return _mm_add_pd(a, b); }
+            static Reg sub(Reg a, Reg b) { return _mm_sub_pd(a, b); }
+            static Reg mul(Reg a, Reg b) { return _mm_mul_pd(a, b); }
+            static Reg div(Reg a, Reg b) { return _mm_div_pd(a, b); }
+            static Reg sqrt(Reg a) { return _mm_sqrt_pd(a); }
+            static Reg min(Reg a, Reg b) { return _mm_min_pd(a, b); }
+            static Reg max(Reg a, Reg b) { return _mm_max_pd(a, b); }
+            static Reg bitAnd(Reg a, Reg b) { return _mm_and_pd(a, b); }
+            static Reg bitOr(Reg a, Reg b) { return _mm_or_pd(a, b); }
+            static Reg bitXor(Reg a, Reg b) { return _mm_xor_pd(a, b); }
+            static Reg truncate(Reg a) { return _mm_cvtepi32_pd(_mm_cvttpd_epi32(a)); }
+            static Reg equal(Reg a, Reg b) { return _mm_cmpeq_pd(a, b); }
+            static Reg greater(Reg a, Reg b) { return _mm_cmpgt_pd(a, b); }
+            static Reg greaterEqual(Reg a, Reg b) { return _mm_cmpge_pd(a, b); }
+            static Reg select(Reg mask, Reg a, Reg b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+            static int moveMask(Reg mask) { return _mm_movemask_pd(mask); }
+        };
+#endif
+
+#if defined(MATHLIB_AVX)
+        // select uses and/andnot/or instead of blendv, gcc turns blendv on a compare mask into per-lane branches
+        struct FloatOps {
+            using Reg = __m256;
+            static constexpr int width = 8;
+            static Reg broadcast(float v) { return _mm256_set1_ps(v); }
+            static Reg loadu(const float *p) { return _mm256_loadu_ps(p); }
+            static void storeu(float *p, Reg r) { _mm256_storeu_ps(p, r); }
+            static Reg add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+            static Reg sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+            static Reg mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+            static Reg div(Reg a, Reg b) { return _mm256_div_ps(a, b); }
+            static Reg sqrt(Reg a) { return _mm256_sqrt_ps(a); }
+            static Reg min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+            static Reg max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+            static Reg bitAnd(Reg a, Reg b) { return _mm256_and_ps(a, b); }
+            static Reg bitOr(Reg a, Reg b) { return _mm256_or_ps(a, b); }
+            static Reg bitXor(Reg a, Reg b) { return _mm256_xor_ps(a, b); }
+            static Reg truncate(Reg a) { return _mm256_cvtepi32_ps(_mm256_cvttps_epi32(a)); }
+            static Reg equal(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+            static Reg greater(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+            static Reg greaterEqual(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+            static Reg select(Reg mask, Reg a, Reg b) { return _mm256_or_ps(_mm256_and_ps(mask, a), _mm256_andnot_ps(mask, b)); }
+            static int moveMask(Reg mask) { return _mm256_movemask_ps(mask); }
+        };
+
+        struct DoubleOps {
+            using Reg = __m256d;
+            static constexpr int width = 4;
+            static Reg broadcast(double v) { return _mm256_set1_pd(v); }
+            static Reg loadu(const double *p) { return _mm256_loadu_pd(p); }
+            static void storeu(double *p, Reg r) { _mm256_storeu_pd(p, r); }
+            static Reg add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+            static Reg sub(Reg a, Reg b) { return _mm256_sub_pd(a, b); }
+            static Reg mul(Reg a, Reg b) { return _mm256_mul_pd(a, b); }
+            static Reg div(Reg a, Reg b) { return _mm256_div_pd(a, b); }
+            static Reg sqrt(Reg a) { return _mm256_sqrt_pd(a); }
+            static Reg min(Reg a, Reg b) { return _mm256_min_pd(a, b); }
+            static Reg max(Reg a, Reg b) { return _mm256_max_pd(a, b); }
+            static Reg bitAnd(Reg a, Reg b) { return _mm256_and_pd(a, b); }
+            static Reg bitOr(Reg a, Reg b) { return _mm256_or_pd(a, b); }
+            static Reg bitXor(Reg a, Reg b) { return _mm256_xor_pd(a, b); }
+            static Reg truncate(Reg a) { return _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(a)); }
+            static Reg equal(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+            static Reg greater(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+            static Reg greaterEqual(Reg a, Reg b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+            static Reg select(Reg mask, Reg a, Reg b) { return _mm256_or_pd(_mm256_and_pd(mask, a), _mm256_andnot_pd(mask, b)); }
+            static int moveMask(Reg mask) { return _mm256_movemask_pd(mask); }
+        };
+#elif defined(MATHLIB_SSE2)
+        using FloatOps = FloatOps128;
+        using DoubleOps = DoubleOps128;
+#endif
+
+#if defined(MATHLIB_SSE2)
+        template<typename T>
+            struct OpsFor;
+
+        template<>
+            struct OpsFor<float> {
+                using type = FloatOps;
+            };
+
+        template<>
+            struct OpsFor<double> {
+                using type = DoubleOps;
+            };
+#endif
+    }
+}
@@ -0,0 +1,174 @@
+#include "../include/Gemm.h"
+
+#include "../include/Memory.h"
+#include "../include/Instrumentation.h"
+#include "../include/ThreadPool.h"
+
+#include <vector>
+#include <algorithm>
+
+namespace mathlib {
+    namespace {
+        // additions over fewer elements than this run on the calling thread only
+        constexpr std::size_t strassenParallelThreshold = 1 << 16;
+
+        template<typename T>
+            struct View {
+                T *data;
+                std::ptrdiff_t rs;
+                std::ptrdiff_t cs;
+
+                T &operator()(int i, int j) const
+                {
+                    return data[i * rs + j * cs];
+                }
+
+                // quadrant (qi, qj) of a matrix with half-size h
+                View quadrant(int qi, int qj, int h) const
+                {
+                    return View {data + qi * h * rs + qj * h * cs, rs, cs};
+                }
+            };
+
+        // out = x + y or out = x - y elementwise over h x h, out may be x or y
+        template<bool subtract, typename T>
+            void combine(int h, View<const T> x, View<const T> y, View<T> out)
+            {
+                auto rowsKernel = [&](std::size_t first, std::size_t last) {
+                    for (int i = static_cast<int>(first); i < static_cast<int>(last); i++) {
+                        if (x.cs == 1 && y.cs == 1 && out.cs == 1) {
+                            const T *xr = &x(i, 0), *yr = &y(i, 0);
+                            T *outRow = &out(i, 0);
+                            for (int j = 0; j < h; j++)
+                                outRow[j] = subtract ? xr[j] - yr[j] : xr[j] + yr[j];
+                        } else {
+                            for (int j = 0; j < h; j++)
+                                out(i, j) = subtract ? x(i, j) - y(i, j) : x(i, j) + y(i, j);
+                        }
+                    }
+                };
+
+                if (static_cast<std::size_t>(h) * h < strassenParallelThreshold || ThreadPool::global().size() == 1) {
+                    rowsKernel(0, h);
+                    return;
+                }
+                ThreadPool::global().parallelFor(0, h, std::max<std::size_t>(1, strassenParallelThreshold / h), rowsKernel);
+            }
+
+        template<typename T>
+            View<const T> asConst(View<T> v)
+            {
+                return View<const T> {v.data, v.rs, v.cs};
+            }
+
+        template<typename T>
+            void add(int h, View<const T> x, View<const T> y, View<T> out)
+            {
+                combine<false>(h, x, y, out);
+            }
+
+        template<typename T>
+            void subtract(int h, View<const T> x, View<const T> y, View<T> out)
+            {
+                combine<true>(h, x, y, out);
+            }
+
+        // c = a * b; workspace holds three h x h temporaries for this level followed by those of the deeper ones
+        // the schedule of Boyer, Dumas, Pernet and Zhou keeps the intermediate products in the quadrants of c,
+        // so a level needs only the temporaries x (operands from a), y (operands from b) and z
+        template<typename T>
+            void strassenLevel(int n, View<const T> a, View<const T> b, View<T> c, T *workspace, int cutoff)
+            {
+                if (n <= cutoff) {
+                    gemm(n, n, n, T(1), a.data, a.rs, a.cs, b.data, b.rs, b.cs, T(0), c.data, c.rs, c.cs);
+                    return;
+                }
+
+                const int h = n / 2;
+                const std::size_t area = static_cast<std::size_t>(h) * h;
+                const View<T> x {workspace, h, 1}, y {workspace + area, h, 1}, z {workspace + 2 * area, h, 1};
+                T *deeper = workspace + 3 * area;
+
+                const View<const T> a11 = a.quadrant(0, 0, h), a12 = a.quadrant(0, 1, h), a21 = a.quadrant(1, 0, h), a22 = a.quadrant(1, 1, h);
+                const View<const T> b11 = b.quadrant(0, 0, h), b12 = b.quadrant(0, 1, h), b21 = b.quadrant(1, 0, h), b22 = b.quadrant(1, 1, h);
+                const View<T> c11 = c.quadrant(0, 0, h), c12 = c.quadrant(0, 1, h), c21 = c.quadrant(1, 0, h), c22 = c.quadrant(1, 1, h);
+
+                subtract(h, a11, a21, x);                                       // s3 = a11 - a21
+                subtract(h, b22, b12, y);                                       // t3 = b22 - b12
+                strassenLevel(h, asConst(x), asConst(y), c21, deeper, cutoff);  // p7 = s3 * t3
+                add(h, a21, a22, x);                                            // s1 = a21 + a22
+                subtract(h, b12, b11, y);                                       // t1 = b12 - b11
+                strassenLevel(h, asConst(x), asConst(y), c22, deeper, cutoff);  // p5 = s1 * t1
+                subtract(h, asConst(x), a11, x);                                // s2 = s1 - a11
+                subtract(h, b22, asConst(y), y);                                // t2 = b22 - t1
+                strassenLevel(h, asConst(x), asConst(y), c12, deeper, cutoff);  // p6 = s2 * t2
+                subtract(h, a12, asConst(x), x);                                // s4 = a12 - s2
+                strassenLevel(h, asConst(x), b22, c11, deeper, cutoff);         // p3 = s4 * b22
+                strassenLevel(h, a11, b11, z, deeper, cutoff);                  // p1 = a11 * b11
+                add(h, asConst(z), asConst(c12), c12);                          // u2 = p1 + p6
+                add(h, asConst(c12), asConst(c21), c21);                        // u3 = u2 + p7
+                add(h, asConst(c12), asConst(c22), c12);                        // u4 = u2 + p5
+                add(h, asConst(c21), asConst(c22), c22);                        // u7 = u3 + p5, c22 done
+                add(h, asConst(c12), asConst(c11), c12);                        // u5 = u4 + p3, c12 done
+                subtract(h, asConst(y), b21, y);                                // t4 = t2 - b21
+                strassenLevel(h, a22, asConst(y), c11, deeper, cutoff);         // p4 = a22 * t4
+                subtract(h, asConst(c21), asConst(c11), c21);                   // u6 = u3 - p4, c21 done
+                strassenLevel(h, a12, b21, c11, deeper, cutoff);                // p2 = a12 * b21
+                add(h, asConst(z), asConst(c11), c11);                          // u1 = p1 + p2, c11 done
+            }
+
+        template<typename T>
+            void strassenTopLevel(int n, const T *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                    const T *b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+                    T *c, std::ptrdiff_t rsc, std::ptrdiff_t csc, int cutoff)
+            {
+                MATHLIB_TIME(Strassen, static_cast<std::uint64_t>(n) * n * n);
+                cutoff = std::max(cutoff, 1);
+                if (n <= cutoff) {
+                    gemm(n, n, n, T(1), a, rsa, csa, b, rsb, csb, T(0), c, rsc, csc);
+                    return;
+                }
+
+                // halve (rounding up) until the leaves fit the cutoff, the padded size halves evenly that often
+                int leaf = n, levels = 0;
+                while (leaf > cutoff) {
+                    leaf = (leaf + 1) / 2;
+                    levels++;
+                }
+                const int padded = leaf << levels;
+
+                std::size_t workspaceSize = 0;
+                for (int size = padded / 2; size >= leaf; size /= 2)
+                    workspaceSize += 3 * static_cast<std::size_t>(size) * size;
+                AlignedBuffer<T> workspace(workspaceSize);
+
+                if (padded == n) {
+                    strassenLevel(n, View<const T> {a, rsa, csa}, View<const T> {b, rsb, csb}, View<T> {c, rsc, csc}, workspace.data(), cutoff);
+                    return;
+                }
+
+                // zero-padded row-major copies, the padding rows and columns of the product are dropped
+                const std::size_t paddedArea = static_cast<std::size_t>(padded) * padded;
+                AlignedBuffer<T> paddedA(paddedArea), paddedB(paddedArea), paddedC(paddedArea);
+                copyStrided(n, n, a, rsa, csa, paddedA.data(), padded, 1);
+                copyStrided(n, n, b, rsb, csb, paddedB.data(), padded, 1);
+                strassenLevel(padded, View<const T> {paddedA.data(), padded, 1}, View<const T> {paddedB.data(), padded, 1},
+                        View<T> {paddedC.data(), padded, 1}, workspace.data(), cutoff);
+                copyStrided(n, n, static_cast<const T*>(paddedC.data()), padded, 1, c, rsc, csc);
+            }
+    }
+
+    void strassen(int n, const float *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+            const float *b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+            float *c, std::ptrdiff_t rsc, std::ptrdiff_t csc, int cutoff)
+    {
+        strassenTopLevel(n, a, rsa, csa, b, rsb, csb, c, rsc, csc, cutoff);
+    }
+
+    void strassen(int n, const double *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+            const double *b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+            double *c, std::ptrdiff_t rsc, std::ptrdiff_t csc, int cutoff)
+    {
+        strassenTopLevel(n, a, rsa, csa, b, rsb, csb, c, rsc, csc, cutoff);
+    }
+}
@@ -0,0 +1,205 @@
+#include "../include/ThreadPool.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace mathlib {
+    namespace {
+        // identifies the pool and queue a worker thread belongs to
+        thread_local const ThreadPool *workerPool = nullptr;
+        thread_local int workerIndex = -1;
+
+        // globalInstance mirrors globalPool so that global() is a single load once the pool exists;
+        // globalMutex only serializes creating and replacing it
+        std::unique_ptr<ThreadPool> globalPool;
+        std::atomic<ThreadPool*> globalInstance {nullptr};
+        std::mutex globalMutex;
+    }
+
+    ThreadPool::ThreadPool(int threadCount)
+    {
+        const int workers = std::max(threadCount, 1) - 1;
+        for (int i = 0; i < workers; i++)
+            _queues.push_back(std::make_unique<Queue>());
+        for (int i = 0; i < workers; i++)
+            _workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (std::thread &worker : _workers)
+            worker.join();
+    }
+
+    int ThreadPool::defaultThreadCount()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    int ThreadPool::currentWorker() const
+    {
+        return (workerPool == this) ? workerIndex : -1;
+    }
+
+    void ThreadPool::push(std::function<void()> task)
+    {
+        // workers push to their own queue, other threads spread their tasks round-robin
+        int index = currentWorker();
+        if (index < 0)
+            index = static_cast<int>(_nextQueue.fetch_add(1, std::memory_order_relaxed) % _queues.size());
+
+        {
+            std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+            _queues[index]->tasks.push_back(std::move(task));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            _pending.fetch_add(1, std::memory_order_release);
+        }
+        _wake.notify_one();
+    }
+
+    bool ThreadPool::tryRun(int self)
+    {
+        const int count = static_cast<int>(_queues.size());
+        std::function<void()> task;
+
+        // own queue first (newest task, still hot in cache), then steal the oldest task of another queue
+        if (self >= 0) {
+            std::lock_guard<std::mutex> lock(_queues[self]->mutex);
+            if (!_queues[self]->tasks.empty()) {
+                task = std::move(_queues[self]->tasks.back());
+                _queues[self]->tasks.pop_back();
+            }
+        }
+
+        const int start = (self >= 0) ? self + 1 : 0;
+        for (int i = 0; !task && i < count; i++) {
+            Queue &victim = *_queues[(start + i) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+
+        if (!task)
+            return false;
+
+        _pending.fetch_sub(1, std::memory_order_relaxed);
+        task();
+        return true;
+    }
+
+    void ThreadPool::workerLoop(int index)
+    {
+        workerPool = this;
+        workerIndex = index;
+
+        while (true) {
+            if (tryRun(index))
+                continue;
+
+            std::unique_lock<std::mutex> lock(_sleepMutex);
+            _wake.wait(lock, [this]() { return _stop || _pending.load(std::memory_order_acquire) > 0; });
+            if (_stop)
+                return;
+        }
+    }
+
+    void ThreadPool::parallelFor(std::size_t begin, std::size_t end, std::size_t grain,
+            const std::function<void(std::size_t, std::size_t)> &body)
+    {
+        if (end <= begin)
+            return;
+
+        const std::size_t total = end - begin;
+        grain = std::max<std::size_t>(grain, 1);
+        if (_workers.empty() || total <= grain) {
+            body(begin, end);
+            return;
+        }
+
+        // a few chunks per thread leave room for stealing when chunks take uneven time
+        const std::size_t chunks = std::min((total + grain - 1) / grain, static_cast<std::size_t>(size()) * 4);
+        const std::size_t chunkSize = total / chunks;
+        const std::size_t remainder = total % chunks;
+
+        // the queued tasks refer to this frame, so an exception of any chunk is held until every chunk
+        // is done and only the first one is rethrown
+        std::atomic<std::size_t> remaining {chunks - 1};
+        std::atomic<bool> failed {false};
+        std::exception_ptr error;
+        auto run = [&body, &failed, &error](std::size_t first, std::size_t last) {
+            try {
+                body(first, last);
+            } catch (...) {
+                if (!failed.exchange(true))
+                    error = std::current_exception();
+            }
+        };
+
+        std::size_t first = begin;
+        std::size_t callerFirst = 0, callerLast = 0;
+        for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+            const std::size_t last = first + chunkSize + (chunk < remainder ? 1 : 0);
+            if (chunk == 0) {
+                // the calling thread takes the first chunk itself
+                callerFirst = first;
+                callerLast = last;
+            } else {
+                try {
+                    push([&run, &remaining, first, last]() {
+                        run(first, last);
+                        remaining.fetch_sub(1, std::memory_order_release);
+                    });
+                } catch (...) {
+                    // the chunks that could not be queued will not run, stop waiting for them
+                    if (!failed.exchange(true))
+                        error = std::current_exception();
+                    remaining.fetch_sub(chunks - chunk, std::memory_order_relaxed);
+                    break;
+                }
+            }
+            first = last;
+        }
+
+        run(callerFirst, callerLast);
+
+        const int self = currentWorker();
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (!tryRun(self))
+                std::this_thread::yield();
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    ThreadPool &ThreadPool::global()
+    {
+        if (ThreadPool *instance = globalInstance.load(std::memory_order_acquire))
+            return *instance;
+
+        std::lock_guard<std::mutex> lock(globalMutex);
+        if (!globalPool) {
+            globalPool = std::make_unique<ThreadPool>();
+            globalInstance.store(globalPool.get(), std::memory_order_release);
+        }
+        return *globalPool;
+    }
+
+    void ThreadPool::setGlobalThreadCount(int threadCount)
+    {
+        std::lock_guard<std::mutex> lock(globalMutex);
+        globalInstance.store(nullptr, std::memory_order_release);
+        globalPool = std::make_unique<ThreadPool>(threadCount);
+        globalInstance.store(globalPool.get(), std::memory_order_release);
+    }
+}
@@ -0,0 +1,107 @@
+#include "../include/Trigonometry.h"
+
+#include "SimdOps.h"
+
+namespace mathlib {
+    namespace approx {
+        namespace {
+            enum class Output {
+                SinCos,
+                Sin,
+                Cos,
+                Tan
+            };
+
+            // the register version of approx::sincos(float, float&, float&), operation for operation,
+            // the quadrant selection uses masks instead of branches
+            // writes to first (and second for SinCos) for every full register and returns the number of angles done
+            template<Output output>
+                std::size_t sincosRegisters(const float *angles, float *first, float *second, std::size_t count)
+                {
+                    std::size_t n = 0;
+
+#if defined(MATHLIB_SSE2)
+                    using Ops = mathlib::detail::FloatOps;
+                    using Reg = Ops::Reg;
+
+                    const Reg signMask = Ops::broadcast(-0.f);
+                    const Reg half = Ops::broadcast(0.5f);
+                    const Reg two = Ops::broadcast(2.f);
+                    const Reg twoOverPi = Ops::broadcast(detail::twoOverPi);
+                    const Reg piOver2Hi = Ops::broadcast(detail::piOver2Hi);
+                    const Reg piOver2Mid = Ops::broadcast(detail::piOver2Mid);
+                    const Reg piOver2Lo = Ops::broadcast(detail::piOver2Lo);
+                    const Reg one = Ops::broadcast(1.f);
+                    const Reg s0 = Ops::broadcast(-1.6666654611e-1f);
+                    const Reg s1 = Ops::broadcast(8.3321608736e-3f);
+                    const Reg s2 = Ops::broadcast(-1.9515295891e-4f);
+                    const Reg c0 = Ops::broadcast(4.166664568298827e-2f);
+                    const Reg c1 = Ops::broadcast(-1.388731625493765e-3f);
+                    const Reg c2 = Ops::broadcast(2.443315711809948e-5f);
+
+                    for (; n + Ops::width <= count; n += Ops::width) {
+                        const Reg angle = Ops::loadu(angles + n);
+                        const Reg sign = Ops::bitAnd(angle, signMask);
+                        const Reg a = Ops::bitXor(angle, sign);
+
+                        const Reg q = Ops::truncate(Ops::add(Ops::mul(a, twoOverPi), half));
+                        const Reg qHalf = Ops::truncate(Ops::mul(q, half));
+                        const Reg odd = Ops::greater(Ops::sub(q, Ops::mul(two, qHalf)), half);
+                        const Reg high = Ops::greater(Ops::sub(qHalf, Ops::mul(two, Ops::truncate(Ops::mul(qHalf, half)))), half);
+
+                        const Reg x = Ops::sub(Ops::sub(Ops::sub(a, Ops::mul(q, piOver2Hi)), Ops::mul(q, piOver2Mid)), Ops::mul(q, piOver2Lo));
+                        const Reg z = Ops::mul(x, x);
+                        const Reg sinX = Ops::add(x, Ops::mul(Ops::mul(x, z),
+                                    Ops::add(s0, Ops::mul(z, Ops::add(s1, Ops::mul(z, s2))))));
+                        const Reg cosX = Ops::add(Ops::sub(one, Ops::mul(half, z)), Ops::mul(Ops::mul(z, z),
+                                    Ops::add(c0, Ops::mul(z, Ops::add(c1, Ops::mul(z, c2))))));
+
+                        const Reg sinA = Ops::select(odd, cosX, sinX);
+                        const Reg cosA = Ops::select(odd, sinX, cosX);
+                        const Reg sinSign = Ops::bitXor(sign, Ops::bitAnd(high, signMask));
+                        const Reg cosSign = Ops::bitAnd(Ops::bitXor(odd, high), signMask);
+                        const Reg sinR = Ops::bitXor(sinA, sinSign);
+                        const Reg cosR = Ops::bitXor(cosA, cosSign);
+
+                        if constexpr (output == Output::SinCos) {
+                            Ops::storeu(first + n, sinR);
+                            Ops::storeu(second + n, cosR);
+                        } else if constexpr (output == Output::Sin) {
+                            Ops::storeu(first + n, sinR);
+                        } else if constexpr (output == Output::Cos) {
+                            Ops::storeu(first + n, cosR);
+                        } else {
+                            Ops::storeu(first + n, Ops::div(sinR, cosR));
+                        }
+                    }
+#endif
+
+                    return n;
+                }
+        }
+
+        void sincos(const float *angles, float *s, float *c, std::size_t count)
+        {
+            for (std::size_t n = sincosRegisters<Output::SinCos>(angles, s, c, count); n < count; n++)
+                sincos(angles[n], s[n], c[n]);
+        }
+
+        void sin(const float *angles, float *out, std::size_t count)
+        {
+            for (std::size_t n = sincosRegisters<Output::Sin>(angles, out, nullptr, count); n < count; n++)
+                out[n] = sin(angles[n]);
+        }
+
+        void cos(const float *angles, float *out, std::size_t count)
+        {
+            for (std::size_t n = sincosRegisters<Output::Cos>(angles, out, nullptr, count); n < count; n++)
+                out[n] = cos(angles[n]);
+        }
+
+        void tan(const float *angles, float *out, std::size_t count)
+        {
+            for (std::size_t n = sincosRegisters<Output::Tan>(angles, out, nullptr, count); n < count; n++)
+                out[n] = tan(angles[n]);
+        }
+    }
+}